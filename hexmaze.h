@@ -0,0 +1,88 @@
+/*
+ * hexmaze.h - stable C ABI for the hexagonal maze library (libhexmaze).
+ *
+ * A hexmaze_t owns one maze plus the scratch buffers needed to generate,
+ * solve and render it, so a long-running process can create a handle once
+ * and reuse it for many requests without per-call allocation. Handles are
+ * not thread-safe; use one handle per thread.
+ *
+ * Every function that can fail returns a HEXMAZE_* status code.
+ */
+#ifndef HEXMAZE_H
+#define HEXMAZE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(__GNUC__)
+#define HEXMAZE_API __attribute__((visibility("default")))
+#else
+#define HEXMAZE_API
+#endif
+
+/* Bumped whenever a function is added; existing signatures never change. */
+#define HEXMAZE_API_VERSION 3
+
+/* Largest supported maze (matches MAX_ROWS / MAX_COLS in hexpathfinder.h) */
+#define HEXMAZE_MAX_ROWS 50u
+#define HEXMAZE_MAX_COLS 50u
+
+/* Status codes */
+#define HEXMAZE_OK 0
+#define HEXMAZE_ERR_INVALID_ARGUMENT (-1)
+#define HEXMAZE_ERR_OUT_OF_MEMORY (-2)
+#define HEXMAZE_ERR_NO_SOLUTION (-3)
+
+typedef struct hexmaze hexmaze_t;
+
+/* Returns HEXMAZE_API_VERSION of the library actually loaded. */
+HEXMAZE_API int hexmaze_api_version(void);
+
+/* Creates a rows x cols maze with all walls present.
+ * Returns NULL if the dimensions are out of range or allocation fails. */
+HEXMAZE_API hexmaze_t *hexmaze_create(uint32_t rows, uint32_t cols);
+
+/* Releases the handle and everything it owns. NULL is ignored. */
+HEXMAZE_API void hexmaze_free(hexmaze_t *maze);
+
+HEXMAZE_API uint32_t hexmaze_rows(const hexmaze_t *maze);
+HEXMAZE_API uint32_t hexmaze_cols(const hexmaze_t *maze);
+
+/* Returns the CellValues bitmask of cell (r, c), or 0 if out of range. */
+HEXMAZE_API uint8_t hexmaze_cell(const hexmaze_t *maze, uint32_t r, uint32_t c);
+
+/* Generates a new perfect maze. The same seed always yields the same maze. */
+HEXMAZE_API int hexmaze_generate(hexmaze_t *maze, uint32_t seed);
+
+/* Marks the shortest path from the top-left to the bottom-right cell. */
+HEXMAZE_API int hexmaze_solve(hexmaze_t *maze);
+
+/* Renders the two-page PostScript document into a buffer owned by the
+ * handle. *data stays valid until the next render call or hexmaze_free. */
+HEXMAZE_API int hexmaze_render(hexmaze_t *maze, const char **data, size_t *size);
+
+/* Writes a 128-bit fingerprint of the maze's walls and dimensions to
+ * out[0] (low half) and out[1]. With canonical != 0, mazes that are mirror
+ * images or 180 degree rotations of each other share one fingerprint.
+ * Since API version 2. */
+HEXMAZE_API int hexmaze_fingerprint(const hexmaze_t *maze, int canonical, uint64_t out[2]);
+
+/* Encodes the wall changes that turn `from` into `to` (same dimensions) in
+ * the delta format of hexmaze_delta.h. *data is owned by `from` and stays
+ * valid until the next delta call on it or hexmaze_free.
+ * Since API version 3. */
+HEXMAZE_API int hexmaze_delta(hexmaze_t *from, const hexmaze_t *to, const uint8_t **data, size_t *size);
+
+/* Applies a delta in place, keeping both sides of every wall consistent.
+ * A malformed delta leaves the maze unchanged. Since API version 3. */
+HEXMAZE_API int hexmaze_apply_delta(hexmaze_t *maze, const uint8_t *data, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HEXMAZE_H */
@@ -0,0 +1,61 @@
+//
+// Global operator new / delete that record every heap allocation for
+// `pathfinder --stats` (see hexmaze_stats.h). Only linked into binaries,
+// with `make ALLOC_TRACKING=1`; the library never replaces them, since
+// libhexmaze.so would then take over its host's allocator.
+//
+
+#include <cstdlib>
+#include <new>
+#include <malloc.h> // For malloc_usable_size
+
+#include "hexmaze_stats.h"
+
+using namespace std;
+
+namespace {
+
+const bool activated = (activateAllocationHooks(), true);
+
+void* allocate(size_t size) {
+    for (;;) {
+        void* p = malloc(size == 0 ? 1 : size);
+        if (p) {
+            recordAllocation(malloc_usable_size(p));
+            return p;
+        }
+        new_handler handler = get_new_handler();
+        if (!handler)
+            throw bad_alloc();
+        handler();
+    }
+}
+
+void release(void* p) noexcept {
+    if (!p)
+        return;
+    recordFree(malloc_usable_size(p));
+    free(p);
+}
+
+void* allocateNoThrow(size_t size) noexcept {
+    try {
+        return allocate(size);
+    } catch (const bad_alloc&) {
+        return nullptr;
+    }
+}
+
+} // namespace
+
+void* operator new(size_t size) { return allocate(size); }
+void* operator new[](size_t size) { return allocate(size); }
+void* operator new(size_t size, const nothrow_t&) noexcept { return allocateNoThrow(size); }
+void* operator new[](size_t size, const nothrow_t&) noexcept { return allocateNoThrow(size); }
+
+void operator delete(void* p) noexcept { release(p); }
+void operator delete[](void* p) noexcept { release(p); }
+void operator delete(void* p, const nothrow_t&) noexcept { release(p); }
+void operator delete[](void* p, const nothrow_t&) noexcept { release(p); }
+void operator delete(void* p, size_t) noexcept { release(p); }
+void operator delete[](void* p, size_t) noexcept { release(p); }
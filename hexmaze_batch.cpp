@@ -0,0 +1,218 @@
+//
+// Batch solver (see hexmaze_batch.h).
+//
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "hexmaze_batch.h"
+#include "hexmaze_kernels.h"
+
+using namespace std;
+
+static const uint32_t DIRECTION_COUNT = 6; // CellValues wall bits 0..5
+
+//-----------------------------------------------------------------------------
+// Layout
+//-----------------------------------------------------------------------------
+static void buildNeighbors(BatchSolverWorkspace& ws, uint32_t nR, uint32_t nC) {
+    const uint32_t cells = nR * nC;
+    ws.neighbors.resize(static_cast<size_t>(cells) * DIRECTION_COUNT);
+    for (uint32_t r = 0; r < nR; ++r) {
+        for (uint32_t c = 0; c < nC; ++c) {
+            uint32_t* n = &ws.neighbors[(static_cast<size_t>(r) * nC + c) * DIRECTION_COUNT];
+            uint8_t valid = cellNeighbors(r * nC + c, nR, nC, n);
+            for (uint32_t d = 0; d < DIRECTION_COUNT; ++d) {
+                if (!(valid & (1u << d)))
+                    n[d] = cells;
+            }
+        }
+    }
+    ws.nR = nR;
+    ws.nC = nC;
+}
+
+// Transposes one cell of every maze into six lane masks: bit l of
+// open[d] is set if maze l has wall d open. Lanes >= count stay closed.
+static inline void transposeCell(const MazeRows* mazes, uint32_t count, uint32_t r, uint32_t c, uint32_t* open) {
+#if defined(__SSE2__)
+    // Byte l = maze l's open walls shifted so wall 5 sits in the sign bit;
+    // each movemask then reads one wall across all 32 lanes
+    alignas(16) uint8_t bytes[BATCH_MAX_MAZES] = {};
+    for (uint32_t l = 0; l < count; ++l)
+        bytes[l] = static_cast<uint8_t>((~mazes[l][r][c] & ALL_WALLS) << 2);
+    __m128i lo = _mm_load_si128(reinterpret_cast<const __m128i*>(bytes));
+    __m128i hi = _mm_load_si128(reinterpret_cast<const __m128i*>(bytes + 16));
+    for (int d = DIRECTION_COUNT - 1; d >= 0; --d) {
+        open[d] = static_cast<uint32_t>(_mm_movemask_epi8(lo)) |
+                  static_cast<uint32_t>(_mm_movemask_epi8(hi)) << 16;
+        lo = _mm_add_epi8(lo, lo);
+        hi = _mm_add_epi8(hi, hi);
+    }
+#else
+    for (uint32_t d = 0; d < DIRECTION_COUNT; ++d)
+        open[d] = 0;
+    for (uint32_t l = 0; l < count; ++l) {
+        uint8_t walls = static_cast<uint8_t>(~mazes[l][r][c]);
+        for (uint32_t d = 0; d < DIRECTION_COUNT; ++d)
+            open[d] |= static_cast<uint32_t>((walls >> d) & 1u) << l;
+    }
+#endif
+}
+
+//-----------------------------------------------------------------------------
+// Dead-End Filling
+//-----------------------------------------------------------------------------
+
+// Kills the cell in every lane where exactly one live neighbour is
+// reachable and queues the neighbours those lanes leave behind
+static inline void visitCell(BatchSolverWorkspace& ws, uint32_t cell, uint32_t& tail, uint32_t& size) {
+    uint32_t alive = ws.alive[cell];
+    if (!alive)
+        return;
+
+    const uint32_t* n = &ws.neighbors[static_cast<size_t>(cell) * DIRECTION_COUNT];
+    const uint32_t* open = &ws.open[static_cast<size_t>(cell) * DIRECTION_COUNT];
+    uint32_t reach[DIRECTION_COUNT];
+    uint32_t once = 0, twice = 0; // Lanes with >= 1 and >= 2 live neighbours
+    for (uint32_t d = 0; d < DIRECTION_COUNT; ++d) {
+        reach[d] = open[d] & ws.alive[n[d]];
+        twice |= once & reach[d];
+        once |= reach[d];
+    }
+
+    uint32_t kill = alive & once & ~twice;
+    if (!kill)
+        return;
+    ws.alive[cell] = alive & ~kill;
+    for (uint32_t d = 0; d < DIRECTION_COUNT; ++d) {
+        uint32_t next = n[d];
+        if ((reach[d] & kill) && !ws.queued[next]) {
+            ws.queued[next] = 1;
+            ws.queue[tail] = next;
+            tail = tail + 1 == ws.queue.size() ? 0 : tail + 1;
+            ++size;
+        }
+    }
+}
+
+static void fillDeadEnds(BatchSolverWorkspace& ws, uint32_t cells) {
+    // Start and end are never filled; every other cell starts queued, in
+    // order, so early kills merge into cells that are still waiting. At
+    // most cells - 2 are queued at once, so the ring never overflows.
+    ws.queued.assign(cells, 1);
+    uint32_t head = 0, tail = 0, size = 0;
+    for (uint32_t i = 1; i + 1 < cells; ++i)
+        ws.queue[tail++] = i;
+    size = tail;
+
+    while (size > 0) {
+        uint32_t cell = ws.queue[head];
+        head = head + 1 == ws.queue.size() ? 0 : head + 1;
+        --size;
+        ws.queued[cell] = 0;
+        visitCell(ws, cell, tail, size);
+    }
+}
+
+//-----------------------------------------------------------------------------
+// Path Extraction
+//-----------------------------------------------------------------------------
+
+// Follows lane l's live cells from start to end. Fails unless they form a
+// single simple path, i.e. the maze was perfect and solvable.
+static bool walkPath(const BatchSolverWorkspace& ws, uint32_t l, uint32_t cells, uint32_t aliveCount,
+                     vector<uint32_t>& path) {
+    const uint32_t bit = 1u << l;
+    path.clear();
+    uint32_t prev = cells, cur = 0;
+    path.push_back(cur);
+    while (cur != cells - 1) {
+        const uint32_t* n = &ws.neighbors[static_cast<size_t>(cur) * DIRECTION_COUNT];
+        const uint32_t* open = &ws.open[static_cast<size_t>(cur) * DIRECTION_COUNT];
+        uint32_t next = cells, choices = 0;
+        for (uint32_t d = 0; d < DIRECTION_COUNT; ++d) {
+            if ((open[d] & ws.alive[n[d]] & bit) && n[d] != prev) {
+                next = n[d];
+                ++choices;
+            }
+        }
+        if (choices != 1 || path.size() >= aliveCount)
+            return false;
+        prev = cur;
+        cur = next;
+        path.push_back(cur);
+    }
+    return path.size() == aliveCount;
+}
+
+//-----------------------------------------------------------------------------
+// Batch Solver
+//-----------------------------------------------------------------------------
+uint32_t solveMazeBatch(const MazeRows* mazes, uint32_t count, uint32_t nR, uint32_t nC, BatchSolverWorkspace& ws,
+                        vector<uint32_t>* paths) {
+    if (count > BATCH_MAX_MAZES)
+        count = BATCH_MAX_MAZES;
+    const uint32_t cells = nR * nC;
+    uint32_t solved = 0;
+
+    // A single cell is its own path; leave it to the scalar solver
+    if (cells < 2) {
+        for (uint32_t l = 0; l < count; ++l) {
+            if (solveMazeBFS(mazes[l], nR, nC, ws.fallback))
+                solved |= 1u << l;
+            if (paths)
+                paths[l] = ws.fallback.path;
+        }
+        return solved;
+    }
+
+    if (ws.nR != nR || ws.nC != nC)
+        buildNeighbors(ws, nR, nC);
+    ws.open.resize(static_cast<size_t>(cells) * DIRECTION_COUNT);
+    ws.alive.resize(cells + 1);
+    ws.queue.resize(cells);
+
+    const uint32_t lanes = count == 32 ? 0xFFFFFFFFu : (1u << count) - 1;
+    for (uint32_t r = 0; r < nR; ++r) {
+        for (uint32_t c = 0; c < nC; ++c) {
+            uint32_t i = r * nC + c;
+            transposeCell(mazes, count, r, c, &ws.open[static_cast<size_t>(i) * DIRECTION_COUNT]);
+            ws.alive[i] = lanes;
+        }
+    }
+    ws.alive[cells] = 0; // Off the grid
+
+    fillDeadEnds(ws, cells);
+
+    // Mark the surviving cells and check each lane's path
+    uint32_t aliveCount[BATCH_MAX_MAZES] = {};
+    for (uint32_t l = 0; l < count; ++l) {
+        const uint32_t bit = 1u << l;
+        MazeRows maze = mazes[l];
+        for (uint32_t r = 0; r < nR; ++r) {
+            const uint32_t* alive = &ws.alive[r * nC];
+            for (uint32_t c = 0; c < nC; ++c) {
+                uint8_t mark = (alive[c] & bit) ? VISITED : 0;
+                maze[r][c] = static_cast<uint8_t>((maze[r][c] & ~VISITED) | mark);
+                aliveCount[l] += mark ? 1 : 0;
+            }
+        }
+    }
+
+    vector<uint32_t>& scratch = ws.fallback.path;
+    for (uint32_t l = 0; l < count; ++l) {
+        vector<uint32_t>& path = paths ? paths[l] : scratch;
+        if (walkPath(ws, l, cells, aliveCount[l], path)) {
+            solved |= 1u << l;
+        } else if (solveMazeBFS(mazes[l], nR, nC, ws.fallback)) {
+            solved |= 1u << l; // Loops: filling leaves more than the path
+            if (paths)
+                path = ws.fallback.path;
+        } else if (paths) {
+            path.clear();
+        }
+    }
+    return solved;
+}
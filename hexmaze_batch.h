@@ -0,0 +1,50 @@
+//
+// Batch solver: up to BATCH_MAX_MAZES same-size mazes solved in lockstep.
+//
+// The mazes are transposed into structure-of-arrays form: for every cell,
+// one 32-bit mask per direction whose bit l says "maze l has this wall
+// open", plus a mask of the mazes in which the cell is still alive. Dead-end
+// filling then runs on all mazes at once: a cell dies in every maze where
+// exactly one live neighbour is reachable, and each kill queues the
+// neighbour it leaves behind. One visit of a queued cell settles it for all
+// 32 mazes, and kills from different mazes that queue the same cell merge,
+// so the whole batch costs a fraction of 32 separate BFS runs.
+//
+// In a perfect maze (as generateMaze() makes) the cells left alive are
+// exactly the solution path. If a maze has loops or no solution, the path
+// walk that follows filling notices and that maze is re-solved with
+// solveMazeBFS(), so the result is always what solveMazeBFS() would give.
+//
+
+#ifndef HEXMAZE_BATCH_H
+#define HEXMAZE_BATCH_H
+
+#include <cstdint>
+#include <vector>
+
+#include "hexpathfinder.h"
+
+const uint32_t BATCH_MAX_MAZES = 32;
+
+typedef uint8_t (*MazeRows)[MAX_COLS];
+
+// Reusable buffers for solveMazeBatch(); one per thread
+struct BatchSolverWorkspace {
+    uint32_t nR = 0;                 // Size the neighbour table was built for
+    uint32_t nC = 0;
+    std::vector<uint32_t> neighbors; // 6 per cell in CellValues bit order; nR * nC = off the grid
+    std::vector<uint32_t> open;      // 6 lane masks per cell, same order
+    std::vector<uint32_t> alive;     // Lane mask per cell, plus a zero for off the grid
+    std::vector<uint32_t> queue;     // Ring of cells to re-examine
+    std::vector<uint8_t> queued;
+    SolverWorkspace fallback;        // For mazes that are not perfect
+};
+
+// Solves mazes[0 .. count-1] (count <= BATCH_MAX_MAZES, all nR x nC),
+// marking each solution with VISITED exactly like solveMazeBFS(). If paths
+// is non-null, paths[l] receives maze l's solution cells, start to end.
+// Returns a mask with bit l set if maze l has a solution.
+uint32_t solveMazeBatch(const MazeRows* mazes, uint32_t count, uint32_t nR, uint32_t nC, BatchSolverWorkspace& ws,
+                        std::vector<uint32_t>* paths = nullptr);
+
+#endif // HEXMAZE_BATCH_H
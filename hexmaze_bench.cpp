@@ -0,0 +1,647 @@
+//
+// Benchmark suite for the maze core (`make bench`).
+// Times DSU find/unite, getNeighbor, generateMaze, solveMazeBFS and
+// rendering (renderMaze / drawMaze into a byte-counting stream, plus
+// printMaze to maze.ps in a temporary directory where the C API sizes
+// allow) on square mazes, with fixed seeds so every run measures the same
+// work.
+//
+// Each case runs --warmup untimed calls, then up to --reps timed samples;
+// a case stops early once it has used --budget seconds (keeping at least
+// one sample). Short calls are repeated inside a sample so every sample
+// lasts at least MIN_SAMPLE_NS (unless --warmup is 0). Results are per
+// call, or per operation for the DSU and getNeighbor cases, with median,
+// p99, min and mean.
+//
+// Hardware counters (cycles, instructions, L1d read misses, last-level
+// cache misses, branch misses) are read with perf_event_open over the timed
+// samples of each case and reported per maze cell. They are opened as one
+// perf group so every ratio between them covers the same instructions; if
+// the group cannot be opened they are counted one by one, with a note (and
+// "perf_grouped": false in the JSON). Counters the kernel or hardware does
+// not offer (containers, VMs, perf_event_paranoid > 2) are left out with a
+// note; --no-perf skips them altogether.
+//
+// Cases that would not fit in available memory are reported as skipped.
+// When generateMaze does not fit, solving and rendering run on a maze
+// made by generateMazeBands instead (marked "source": "bands").
+//
+// Usage: mazebench [--sizes N,N,...] [--warmup N] [--reps N] [--budget SECONDS]
+//                  [--json FILE|-] [--no-perf]
+//
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+
+#include <fcntl.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "hexpathfinder.h"
+#include "hexmaze_footprint.h"
+#include "hexmaze_parallel.h"
+#include "hexmaze_scheduler.h"
+
+using namespace std;
+typedef chrono::steady_clock Clock;
+
+const double MIN_SAMPLE_NS = 1e6;
+
+// Results of the timed loops end up here so they are not optimized away
+static volatile uint64_t benchSink;
+
+struct BenchOptions {
+    vector<uint32_t> sizes = {10, 100, 1000, 10000};
+    unsigned warmup = 2;
+    unsigned reps = 20;
+    double budget = 10.0; // Seconds per case
+    string jsonPath;      // "" = text table only, "-" = JSON on stdout
+    bool perf = true;     // Read hardware counters
+};
+
+//-----------------------------------------------------------------------------
+// Hardware Counters
+//-----------------------------------------------------------------------------
+struct PerfEventSpec {
+    const char* name;
+    uint32_t type;
+    uint64_t config;
+};
+
+const uint64_t L1D_READ_MISS = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                               (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+
+static const PerfEventSpec PERF_EVENTS[] = {
+    {"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {"l1d_misses", PERF_TYPE_HW_CACHE, L1D_READ_MISS},
+    {"llc_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    {"branch_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+};
+const int PERF_EVENT_COUNT = sizeof(PERF_EVENTS) / sizeof(PERF_EVENTS[0]);
+
+// User-space counters for the calling thread. open() tries the events as
+// one perf group, with cycles as the leader, so they are all scheduled onto
+// the PMU together and count exactly the same instructions; reset, enable,
+// disable and read then go through the leader. When the group cannot be
+// opened (too many counters, an event the hardware lacks) each event is
+// opened on its own instead: events that fail stay closed (fd -1) and read
+// as unavailable, and counts are scaled up when the kernel had to multiplex
+// them.
+class PerfCounters {
+public:
+    PerfCounters() : grouped(false) {
+        fill(fds, fds + PERF_EVENT_COUNT, -1);
+    }
+
+    ~PerfCounters() {
+        closeAll();
+    }
+
+    // Opens what it can; returns why the events are not one group, or the
+    // error of the first event that failed
+    string open() {
+        string error = openGroup();
+        if (grouped)
+            return error;
+        string separate;
+        for (int e = 0; e < PERF_EVENT_COUNT; ++e) {
+            fds[e] = openEvent(e, -1, false);
+            if (fds[e] < 0 && separate.empty())
+                separate = string(PERF_EVENTS[e].name) + ": " + strerror(errno);
+        }
+        if (!any())
+            return error;
+        return "events counted separately, group failed on " + error + (separate.empty() ? "" : "; " + separate);
+    }
+
+    bool any() const {
+        for (int fd : fds)
+            if (fd >= 0)
+                return true;
+        return false;
+    }
+
+    bool isGrouped() const {
+        return grouped;
+    }
+
+    void start() {
+        if (grouped) {
+            ioctl(fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ioctl(fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+            return;
+        }
+        for (int fd : fds)
+            if (fd >= 0) {
+                ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+    }
+
+    // Stops counting and stores the counts since start(), -1 where an event
+    // is unavailable or never got scheduled
+    void stop(double counts[PERF_EVENT_COUNT]) {
+        fill(counts, counts + PERF_EVENT_COUNT, -1.0);
+        if (grouped) {
+            ioctl(fds[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+            uint64_t value[3 + PERF_EVENT_COUNT]; // nr, time enabled, time running, counts
+            ssize_t size = sizeof(value);
+            if (read(fds[0], value, sizeof(value)) != size || value[0] != PERF_EVENT_COUNT || value[2] == 0)
+                return;
+            for (int e = 0; e < PERF_EVENT_COUNT; ++e)
+                counts[e] = static_cast<double>(value[3 + e]) * value[1] / value[2];
+            return;
+        }
+        for (int e = 0; e < PERF_EVENT_COUNT; ++e) {
+            if (fds[e] < 0)
+                continue;
+            ioctl(fds[e], PERF_EVENT_IOC_DISABLE, 0);
+            uint64_t value[3]; // count, time enabled, time running
+            if (read(fds[e], value, sizeof(value)) != static_cast<ssize_t>(sizeof(value)) || value[2] == 0)
+                continue;
+            counts[e] = static_cast<double>(value[0]) * value[1] / value[2];
+        }
+    }
+
+private:
+    int fds[PERF_EVENT_COUNT];
+    bool grouped;
+
+    // Leader is -1 for the group leader or an event on its own
+    static int openEvent(int e, int leader, bool group) {
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_EVENTS[e].type;
+        attr.config = PERF_EVENTS[e].config;
+        attr.disabled = leader < 0; // Members follow the leader
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        if (group && leader < 0)
+            attr.read_format |= PERF_FORMAT_GROUP;
+        return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0));
+    }
+
+    // All events or none; returns the error of the event that failed
+    string openGroup() {
+        for (int e = 0; e < PERF_EVENT_COUNT; ++e) {
+            fds[e] = openEvent(e, e == 0 ? -1 : fds[0], true);
+            if (fds[e] < 0) {
+                string error = string(PERF_EVENTS[e].name) + ": " + strerror(errno);
+                closeAll();
+                return error;
+            }
+        }
+        grouped = true;
+        return "";
+    }
+
+    void closeAll() {
+        for (int& fd : fds) {
+            if (fd >= 0)
+                close(fd);
+            fd = -1;
+        }
+    }
+};
+
+// Set up by main() unless --no-perf; null when no event could be opened.
+// perfError says why an event is missing or the events are not one group.
+static PerfCounters* perfCounters = nullptr;
+static string perfError;
+
+struct BenchResult {
+    string name;
+    uint32_t size;
+    string unit;    // "call" or "op"
+    string source;  // Maze the case ran on: "kruskal", "bands" or "" (no maze)
+    string skipped; // Reason, if the case did not run
+    uint64_t opsPerCall;
+    unsigned warmup;
+    unsigned innerCalls; // Calls per sample
+    vector<double> samplesNs; // Per unit, sorted
+    double perCell[PERF_EVENT_COUNT]; // Hardware counts per maze cell; -1 = unavailable
+};
+
+// Stream buffer that only counts what is written
+class CountingSink : public streambuf {
+public:
+    CountingSink() : bytes(0) {}
+    uint64_t bytes;
+
+protected:
+    int_type overflow(int_type ch) override {
+        if (!traits_type::eq_int_type(ch, traits_type::eof()))
+            ++bytes;
+        return traits_type::not_eof(ch);
+    }
+
+    streamsize xsputn(const char*, streamsize n) override {
+        bytes += static_cast<uint64_t>(n);
+        return n;
+    }
+};
+
+static bool fitsInMemory(uint64_t bytes) {
+    uint64_t available = availableMemory();
+    return available == 0 || bytes < available / 4 * 3; // Headroom for what the estimates leave out
+}
+
+static double nearestRank(const vector<double>& sorted, double p) {
+    if (sorted.empty())
+        return 0.0;
+    size_t rank = static_cast<size_t>(p / 100.0 * sorted.size() + 0.999999);
+    return sorted[min(max<size_t>(rank, 1), sorted.size()) - 1];
+}
+
+// Times call() per the warmup / reps / budget rules above
+static void measure(const BenchOptions& opts, BenchResult& result, const function<void()>& call) {
+    Clock::time_point caseStart = Clock::now();
+    double warmNs = 0;
+    result.warmup = 0;
+    for (unsigned i = 0; i < opts.warmup; ++i) {
+        Clock::time_point start = Clock::now();
+        call();
+        warmNs = chrono::duration<double, nano>(Clock::now() - start).count();
+        ++result.warmup;
+        if (chrono::duration<double>(Clock::now() - caseStart).count() > opts.budget / 2)
+            break;
+    }
+
+    // Without a warmup call to size them, samples are single calls
+    result.innerCalls = warmNs >= MIN_SAMPLE_NS || result.warmup == 0
+                            ? 1 : static_cast<unsigned>(MIN_SAMPLE_NS / max(warmNs, 1.0)) + 1;
+    // Counters cover every timed sample; start() and stop() stay outside
+    // the per-sample clock
+    if (perfCounters)
+        perfCounters->start();
+    unsigned calls = 0;
+    caseStart = Clock::now();
+    for (unsigned rep = 0; rep < opts.reps; ++rep) {
+        Clock::time_point start = Clock::now();
+        for (unsigned i = 0; i < result.innerCalls; ++i)
+            call();
+        double ns = chrono::duration<double, nano>(Clock::now() - start).count();
+        result.samplesNs.push_back(ns / result.innerCalls / result.opsPerCall);
+        calls += result.innerCalls;
+        if (chrono::duration<double>(Clock::now() - caseStart).count() > opts.budget)
+            break;
+    }
+    if (perfCounters) {
+        perfCounters->stop(result.perCell);
+        const double cells = static_cast<double>(result.size) * result.size * calls;
+        for (double& count : result.perCell)
+            if (count >= 0)
+                count /= cells;
+    }
+    sort(result.samplesNs.begin(), result.samplesNs.end());
+}
+
+static BenchResult newResult(const string& name, uint32_t size, const string& unit, uint64_t opsPerCall) {
+    BenchResult result;
+    result.name = name;
+    result.size = size;
+    result.unit = unit;
+    result.opsPerCall = opsPerCall;
+    result.warmup = 0;
+    result.innerCalls = 0;
+    fill(result.perCell, result.perCell + PERF_EVENT_COUNT, -1.0);
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+// Cases
+//-----------------------------------------------------------------------------
+
+// unite() over a fixed random pair list, then find() on every cell
+static void benchDsu(const BenchOptions& opts, uint32_t n, vector<BenchResult>& out) {
+    const uint64_t cells = static_cast<uint64_t>(n) * n;
+    BenchResult result = newResult("dsu_unite_find", n, "op", 2 * cells);
+    if (!fitsInMemory(cells * 12)) {
+        result.skipped = "memory";
+        out.push_back(result);
+        return;
+    }
+
+    mt19937 rng(12345);
+    uniform_int_distribution<uint32_t> pick(0, static_cast<uint32_t>(cells - 1));
+    vector<uint32_t> pairs(2 * cells);
+    for (auto& p : pairs)
+        p = pick(rng);
+
+    DSU dsu;
+    uint64_t sink = 0;
+    measure(opts, result, [&] {
+        dsu.reset(static_cast<uint32_t>(cells));
+        for (uint64_t i = 0; i < cells; ++i)
+            dsu.unite(pairs[2 * i], pairs[2 * i + 1]);
+        for (uint32_t i = 0; i < cells; ++i)
+            sink += dsu.find(i);
+    });
+    benchSink = sink;
+    out.push_back(result);
+}
+
+// All six directions of every cell
+static void benchNeighbors(const BenchOptions& opts, uint32_t n, vector<BenchResult>& out) {
+    const uint8_t directions[] = {WALL_UP, WALL_UP_RIGHT, WALL_DOWN_RIGHT, WALL_DOWN, WALL_DOWN_LEFT, WALL_UP_LEFT};
+    BenchResult result = newResult("get_neighbor", n, "op", 6ull * n * n);
+    uint64_t sink = 0;
+    measure(opts, result, [&] {
+        for (uint32_t r = 0; r < n; ++r)
+            for (uint32_t c = 0; c < n; ++c)
+                for (uint8_t dir : directions) {
+                    uint32_t nr, nc;
+                    if (getNeighbor(r, c, dir, n, n, nr, nc))
+                        sink += nr ^ nc;
+                }
+    });
+    benchSink = sink;
+    out.push_back(result);
+}
+
+// generateMaze (seed 1), solveMazeBFS and rendering on one maze; sizes the
+// C API takes use the fixed-size array, as the CLI does
+static void benchMaze(const BenchOptions& opts, uint32_t n, vector<BenchResult>& out) {
+    const uint64_t cells = static_cast<uint64_t>(n) * n;
+    const bool array = n <= MAX_ROWS && n <= MAX_COLS;
+    static uint8_t arrayCells[MAX_ROWS][MAX_COLS];
+    MazeGrid grid;
+
+    BenchResult gen = newResult("generate", n, "call", 1);
+    BenchResult solve = newResult("solve_bfs", n, "call", 1);
+    BenchResult render = newResult("render", n, "call", 1);
+    string source = "kruskal";
+
+    // Cell bytes, DSU, three candidate walls per cell; then BFS distances
+    // and queue
+    if (!fitsInMemory(cells * (1 + sizeof(uint32_t) + 3 * sizeof(Wall)))) {
+        gen.skipped = "memory";
+        source = "bands";
+    }
+    if (!fitsInMemory(cells * (1 + 2 * sizeof(CellIndex)))) {
+        solve.skipped = render.skipped = "memory";
+        out.push_back(gen);
+        out.push_back(solve);
+        out.push_back(render);
+        return;
+    }
+
+    if (array) {
+        GeneratorWorkspace ws;
+        measure(opts, gen, [&] {
+            mt19937 rng(1);
+            generateMaze(arrayCells, n, n, rng, ws);
+        });
+    } else {
+        grid = MazeGrid(n, n);
+        if (source == "kruskal") {
+            BasicGeneratorWorkspace<CellIndex> ws;
+            measure(opts, gen, [&] {
+                mt19937 rng(1);
+                generateMaze(grid, rng, ws);
+            });
+        } else {
+            TaskScheduler scheduler(1);
+            generateMazeBands(grid, 1, scheduler);
+        }
+    }
+    gen.source = solve.source = render.source = source;
+    out.push_back(gen);
+
+    if (array) {
+        SolverWorkspace ws;
+        measure(opts, solve, [&] { solveMazeBFS(arrayCells, n, n, ws); });
+    } else {
+        BasicSolverWorkspace<CellIndex> ws;
+        measure(opts, solve, [&] { solveMazeBFS(grid, ws); });
+    }
+    out.push_back(solve);
+
+    measure(opts, render, [&] {
+        CountingSink sink;
+        ostream ps(&sink);
+        if (array)
+            renderMaze(ps, arrayCells, n, n);
+        else
+            renderMaze(ps, grid);
+        benchSink = sink.bytes;
+    });
+    out.push_back(render);
+
+    // printMaze adds the file write; it only takes the fixed-size array.
+    // It always writes ./maze.ps, so it runs in a temporary directory rather
+    // than over the maze.ps the user may have in the working directory.
+    if (array) {
+        BenchResult print = newResult("print_maze", n, "call", 1);
+        print.source = source;
+        const char* tmp = getenv("TMPDIR");
+        string dir = string(tmp && *tmp ? tmp : "/tmp") + "/mazebench.XXXXXX";
+        int home = ::open(".", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (home < 0 || !mkdtemp(&dir[0]) || chdir(dir.c_str()) != 0) {
+            print.skipped = string("no temporary directory: ") + strerror(errno);
+        } else {
+            streambuf* saved = cout.rdbuf(nullptr); // Silence its confirmation line
+            measure(opts, print, [&] { printMaze(arrayCells, n, n); });
+            cout.rdbuf(saved);
+            cout.clear();
+            remove("maze.ps");
+            if (fchdir(home) != 0)
+                throw runtime_error(string("cannot return to the working directory: ") + strerror(errno));
+            rmdir(dir.c_str());
+        }
+        if (home >= 0)
+            close(home);
+        out.push_back(print);
+    }
+}
+
+//-----------------------------------------------------------------------------
+// Reporting
+//-----------------------------------------------------------------------------
+static void printTable(const vector<BenchResult>& results) {
+    cout << fixed << setprecision(1);
+    cout << left << setw(16) << "case" << right << setw(7) << "size" << setw(9) << "samples"
+         << setw(16) << "median ns" << setw(16) << "p99 ns" << setw(16) << "min ns" << "  per" << endl;
+    for (const BenchResult& r : results) {
+        cout << left << setw(16) << r.name << right << setw(7) << r.size;
+        if (!r.skipped.empty()) {
+            cout << "  skipped (" << r.skipped << ")" << endl;
+            continue;
+        }
+        cout << setw(9) << r.samplesNs.size() << setw(16) << nearestRank(r.samplesNs, 50)
+             << setw(16) << nearestRank(r.samplesNs, 99) << setw(16) << r.samplesNs.front()
+             << "  " << r.unit << (r.source == "bands" ? " (bands maze)" : "") << endl;
+    }
+
+    if (!perfCounters && !perfError.empty())
+        cout << "Hardware counters not available (" << perfError << ")" << endl;
+    else if (perfCounters && !perfCounters->isGrouped())
+        cout << "Hardware counters not grouped (" << perfError << ")" << endl;
+    if (!perfCounters)
+        return;
+    cout << endl << left << setw(16) << "per cell" << right << setw(7) << "size";
+    for (const PerfEventSpec& event : PERF_EVENTS)
+        cout << setw(15) << event.name;
+    cout << endl << setprecision(3);
+    for (const BenchResult& r : results) {
+        if (!r.skipped.empty())
+            continue;
+        cout << left << setw(16) << r.name << right << setw(7) << r.size;
+        for (double count : r.perCell) {
+            if (count < 0)
+                cout << setw(15) << "-";
+            else
+                cout << setw(15) << count;
+        }
+        cout << endl;
+    }
+}
+
+static void writeJson(ostream& out, const BenchOptions& opts, const vector<BenchResult>& results) {
+    out << setprecision(6) << fixed;
+    out << "{\n  \"suite\": \"hexmaze\",\n  \"config\": {\"warmup\": " << opts.warmup
+        << ", \"reps\": " << opts.reps << ", \"budget_s\": " << opts.budget
+        << ", \"index_bits\": " << 8 * sizeof(CellIndex) << ", \"perf_events\": [";
+    bool first = true;
+    for (const BenchResult& r : results) {
+        if (!r.skipped.empty())
+            continue;
+        for (int e = 0; e < PERF_EVENT_COUNT; ++e)
+            if (r.perCell[e] >= 0) {
+                out << (first ? "" : ", ") << "\"" << PERF_EVENTS[e].name << "\"";
+                first = false;
+            }
+        break; // Every case opens the same events
+    }
+    out << "], \"perf_grouped\": " << (perfCounters && perfCounters->isGrouped() ? "true" : "false");
+    if (!perfError.empty())
+        out << ", \"perf_error\": \"" << perfError << "\"";
+    out << "},\n  \"results\": [";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchResult& r = results[i];
+        out << (i ? "," : "") << "\n    {\"name\": \"" << r.name << "\", \"rows\": " << r.size
+            << ", \"cols\": " << r.size << ", \"unit\": \"" << r.unit << "\"";
+        if (!r.source.empty())
+            out << ", \"source\": \"" << r.source << "\"";
+        if (!r.skipped.empty()) {
+            out << ", \"skipped\": \"" << r.skipped << "\"}";
+            continue;
+        }
+        double mean = 0;
+        for (double s : r.samplesNs)
+            mean += s;
+        mean /= r.samplesNs.size();
+        out << ", \"ops_per_call\": " << r.opsPerCall << ", \"warmup\": " << r.warmup
+            << ", \"inner_calls\": " << r.innerCalls << ", \"median_ns\": " << nearestRank(r.samplesNs, 50)
+            << ", \"p99_ns\": " << nearestRank(r.samplesNs, 99) << ", \"min_ns\": " << r.samplesNs.front()
+            << ", \"mean_ns\": " << mean << ", \"samples_ns\": [";
+        for (size_t k = 0; k < r.samplesNs.size(); ++k)
+            out << (k ? ", " : "") << r.samplesNs[k];
+        out << "]";
+        bool counted = false;
+        for (int e = 0; e < PERF_EVENT_COUNT; ++e) {
+            if (r.perCell[e] < 0)
+                continue;
+            out << (counted ? ", " : ", \"per_cell\": {") << "\"" << PERF_EVENTS[e].name << "\": " << r.perCell[e];
+            counted = true;
+        }
+        out << (counted ? "}}" : "}");
+    }
+    out << "\n  ]\n}\n";
+}
+
+static vector<uint32_t> parseSizes(const string& text) {
+    vector<uint32_t> sizes;
+    stringstream in(text);
+    string item;
+    while (getline(in, item, ',')) {
+        unsigned long n = stoul(item);
+        if (n == 0 || n > 100000)
+            throw invalid_argument("size " + item + " out of range");
+        sizes.push_back(static_cast<uint32_t>(n));
+    }
+    if (sizes.empty())
+        throw invalid_argument("no sizes");
+    return sizes;
+}
+
+int main(int argc, char* argv[]) {
+    BenchOptions opts;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            string opt = argv[i];
+            if (opt == "--no-perf") {
+                opts.perf = false;
+                continue;
+            }
+            if (i + 1 >= argc)
+                throw invalid_argument("missing value for " + opt);
+            string value = argv[++i];
+            if (opt == "--sizes")
+                opts.sizes = parseSizes(value);
+            else if (opt == "--warmup")
+                opts.warmup = static_cast<unsigned>(stoul(value));
+            else if (opt == "--reps" && stoul(value) > 0)
+                opts.reps = static_cast<unsigned>(stoul(value));
+            else if (opt == "--budget" && stod(value) > 0)
+                opts.budget = stod(value);
+            else if (opt == "--json")
+                opts.jsonPath = value;
+            else
+                throw invalid_argument("bad option " + opt + " " + value);
+        }
+    } catch (const exception& e) {
+        cerr << "Error: " << e.what() << endl << "Usage: " << argv[0]
+             << " [--sizes N,N,...] [--warmup N] [--reps N] [--budget SECONDS] [--json FILE|-] [--no-perf]" << endl;
+        return 1;
+    }
+
+    PerfCounters counters;
+    if (opts.perf) {
+        perfError = counters.open();
+        if (counters.any())
+            perfCounters = &counters;
+    }
+
+    vector<BenchResult> results;
+    for (uint32_t n : opts.sizes) {
+        if (opts.jsonPath != "-")
+            cerr << "size " << n << "x" << n << "..." << endl;
+        benchDsu(opts, n, results);
+        benchNeighbors(opts, n, results);
+        benchMaze(opts, n, results);
+    }
+
+    if (opts.jsonPath == "-") {
+        writeJson(cout, opts, results);
+        return 0;
+    }
+    printTable(results);
+    if (!opts.jsonPath.empty()) {
+        ofstream out(opts.jsonPath);
+        writeJson(out, opts, results);
+        if (!out.flush()) {
+            cerr << "Error: cannot write " << opts.jsonPath << endl;
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,380 @@
+//
+// Compares two mazebench JSON files (`make bench`): a baseline and a
+// candidate. For every case both ran (same name and size) it reports the
+// ratio of median times, a bootstrap confidence interval for that ratio and
+// a two-sided Mann-Whitney U test on the raw samples.
+//
+// A case has regressed when all three agree: the samples differ
+// (p < --alpha), the median ratio is above 1 + --threshold, and the whole
+// confidence interval lies above 1. Improvements are the mirror image. Only
+// generate, solve_bfs and render gate the exit status unless --all is given;
+// the exit status is 1 if any gating case regressed.
+//
+// The test only sees noise within each run; drift between runs (another
+// load on the machine, frequency scaling) shows up as a real difference, so
+// both files should come from the same quiet machine.
+//
+// Usage: benchcompare BASELINE.json CANDIDATE.json [--threshold PCT]
+//                     [--alpha P] [--resamples N] [--all]
+//
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <map>
+#include <string>
+#include <random>
+#include <algorithm>
+#include <stdexcept>
+#include <cmath>
+#include <cctype>
+
+using namespace std;
+
+//-----------------------------------------------------------------------------
+// JSON
+// Just enough of a parser for mazebench output: objects, arrays, strings
+// without escapes beyond \" and \\, numbers, true/false/null.
+//-----------------------------------------------------------------------------
+struct JsonValue {
+    enum Type { NUL, BOOL, NUMBER, STRING, ARRAY, OBJECT } type = NUL;
+    double number = 0;
+    string text;
+    vector<JsonValue> items;
+    map<string, JsonValue> fields;
+
+    const JsonValue* get(const string& key) const {
+        auto it = fields.find(key);
+        return it == fields.end() ? nullptr : &it->second;
+    }
+};
+
+class JsonParser {
+public:
+    explicit JsonParser(const string& text) : s(text), pos(0) {}
+
+    JsonValue parse() {
+        JsonValue value = parseValue();
+        skipSpace();
+        if (pos != s.size())
+            fail("trailing data");
+        return value;
+    }
+
+private:
+    const string& s;
+    size_t pos;
+
+    void fail(const string& what) {
+        throw runtime_error("JSON " + what + " at offset " + to_string(pos));
+    }
+
+    void skipSpace() {
+        while (pos < s.size() && isspace(static_cast<unsigned char>(s[pos])))
+            ++pos;
+    }
+
+    // Consumes a ',' between members if there is one
+    bool skipComma() {
+        skipSpace();
+        if (pos < s.size() && s[pos] == ',') {
+            ++pos;
+            return true;
+        }
+        return false;
+    }
+
+    void expect(char ch) {
+        skipSpace();
+        if (pos >= s.size() || s[pos] != ch)
+            fail(string("expected '") + ch + "'");
+        ++pos;
+    }
+
+    string parseString() {
+        expect('"');
+        string out;
+        while (pos < s.size() && s[pos] != '"') {
+            if (s[pos] == '\\' && pos + 1 < s.size())
+                ++pos;
+            out += s[pos++];
+        }
+        expect('"');
+        return out;
+    }
+
+    JsonValue parseValue() {
+        skipSpace();
+        if (pos >= s.size())
+            fail("unexpected end");
+        JsonValue value;
+        char ch = s[pos];
+        if (ch == '{') {
+            value.type = JsonValue::OBJECT;
+            ++pos;
+            skipSpace();
+            if (pos < s.size() && s[pos] == '}') {
+                ++pos;
+                return value;
+            }
+            do {
+                string key = parseString();
+                expect(':');
+                value.fields[key] = parseValue();
+            } while (skipComma());
+            expect('}');
+        } else if (ch == '[') {
+            value.type = JsonValue::ARRAY;
+            ++pos;
+            skipSpace();
+            if (pos < s.size() && s[pos] == ']') {
+                ++pos;
+                return value;
+            }
+            do
+                value.items.push_back(parseValue());
+            while (skipComma());
+            expect(']');
+        } else if (ch == '"') {
+            value.type = JsonValue::STRING;
+            value.text = parseString();
+        } else if (s.compare(pos, 4, "true") == 0 || s.compare(pos, 5, "false") == 0) {
+            value.type = JsonValue::BOOL;
+            value.number = s[pos] == 't';
+            pos += s[pos] == 't' ? 4 : 5;
+        } else if (s.compare(pos, 4, "null") == 0) {
+            pos += 4;
+        } else {
+            size_t used = 0;
+            value.type = JsonValue::NUMBER;
+            try {
+                value.number = stod(s.substr(pos, 32), &used);
+            } catch (const exception&) {
+                fail("bad number");
+            }
+            pos += used;
+        }
+        return value;
+    }
+};
+
+//-----------------------------------------------------------------------------
+// Bench Files
+//-----------------------------------------------------------------------------
+struct BenchCase {
+    string name;
+    uint32_t rows;
+    uint32_t cols;
+    string unit;
+    vector<double> samplesNs; // Sorted
+};
+
+static string caseKey(const string& name, uint32_t rows, uint32_t cols) {
+    return name + " " + to_string(rows) + "x" + to_string(cols);
+}
+
+// Cases of a mazebench JSON file that ran, by caseKey
+static map<string, BenchCase> loadBench(const string& path) {
+    ifstream in(path);
+    if (!in)
+        throw runtime_error("cannot open " + path);
+    stringstream text;
+    text << in.rdbuf();
+    JsonValue root = JsonParser(text.str()).parse();
+    const JsonValue* results = root.get("results");
+    if (!results || results->type != JsonValue::ARRAY)
+        throw runtime_error(path + " has no results array");
+
+    map<string, BenchCase> cases;
+    for (const JsonValue& r : results->items) {
+        const JsonValue* name = r.get("name");
+        const JsonValue* rows = r.get("rows");
+        const JsonValue* cols = r.get("cols");
+        const JsonValue* samples = r.get("samples_ns");
+        if (!name || !rows || !cols || r.get("skipped") || !samples || samples->items.empty())
+            continue;
+        BenchCase c;
+        c.name = name->text;
+        c.rows = static_cast<uint32_t>(rows->number);
+        c.cols = static_cast<uint32_t>(cols->number);
+        c.unit = r.get("unit") ? r.get("unit")->text : "call";
+        for (const JsonValue& s : samples->items)
+            c.samplesNs.push_back(s.number);
+        sort(c.samplesNs.begin(), c.samplesNs.end());
+        cases[caseKey(c.name, c.rows, c.cols)] = c;
+    }
+    return cases;
+}
+
+//-----------------------------------------------------------------------------
+// Statistics
+//-----------------------------------------------------------------------------
+static double median(const vector<double>& sorted) {
+    size_t n = sorted.size();
+    return n % 2 ? sorted[n / 2] : (sorted[n / 2 - 1] + sorted[n / 2]) / 2;
+}
+
+// Two-sided p-value of the Mann-Whitney U test, normal approximation with
+// tie correction (fine from about 8 samples a side; mazebench takes 20)
+static double mannWhitneyP(const vector<double>& a, const vector<double>& b) {
+    const size_t n1 = a.size(), n2 = b.size(), n = n1 + n2;
+    vector<pair<double, int>> all;
+    for (double x : a) all.push_back(make_pair(x, 0));
+    for (double x : b) all.push_back(make_pair(x, 1));
+    sort(all.begin(), all.end());
+
+    double rankSumA = 0, tieTerm = 0;
+    for (size_t i = 0; i < n;) {
+        size_t j = i;
+        while (j < n && all[j].first == all[i].first)
+            ++j;
+        double rank = (i + 1 + j) / 2.0; // Mean rank of the tied run
+        for (size_t k = i; k < j; ++k)
+            if (all[k].second == 0)
+                rankSumA += rank;
+        double t = static_cast<double>(j - i);
+        tieTerm += t * t * t - t;
+        i = j;
+    }
+
+    double u = rankSumA - n1 * (n1 + 1) / 2.0;
+    double mean = n1 * n2 / 2.0;
+    double variance = n1 * n2 / 12.0 * ((n + 1) - tieTerm / (static_cast<double>(n) * (n - 1)));
+    if (variance <= 0)
+        return 1.0;
+    double z = (fabs(u - mean) - 0.5) / sqrt(variance); // Continuity correction
+    return min(1.0, erfc(max(z, 0.0) / sqrt(2.0)));
+}
+
+// Percentile bootstrap interval for median(b) / median(a); fixed seed, so
+// the same files always give the same interval
+static void bootstrapRatio(const vector<double>& a, const vector<double>& b, unsigned resamples,
+                           double level, double& lo, double& hi) {
+    mt19937 rng(1);
+    uniform_int_distribution<size_t> pickA(0, a.size() - 1), pickB(0, b.size() - 1);
+    vector<double> ratios, ra(a.size()), rb(b.size());
+    ratios.reserve(resamples);
+    for (unsigned i = 0; i < resamples; ++i) {
+        for (double& x : ra) x = a[pickA(rng)];
+        for (double& x : rb) x = b[pickB(rng)];
+        sort(ra.begin(), ra.end());
+        sort(rb.begin(), rb.end());
+        ratios.push_back(median(rb) / median(ra));
+    }
+    sort(ratios.begin(), ratios.end());
+    double tail = (1 - level) / 2;
+    lo = ratios[static_cast<size_t>(tail * (resamples - 1))];
+    hi = ratios[static_cast<size_t>((1 - tail) * (resamples - 1))];
+}
+
+//-----------------------------------------------------------------------------
+// Main
+//-----------------------------------------------------------------------------
+struct CompareOptions {
+    double threshold = 0.05; // Fraction, from --threshold PCT
+    double alpha = 0.01;
+    unsigned resamples = 2000;
+    bool all = false;
+};
+
+static bool gates(const CompareOptions& opts, const string& name) {
+    return opts.all || name == "generate" || name == "solve_bfs" || name == "render";
+}
+
+int main(int argc, char* argv[]) {
+    CompareOptions opts;
+    vector<string> files;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            string opt = argv[i];
+            if (opt == "--all") {
+                opts.all = true;
+                continue;
+            }
+            if (opt.compare(0, 2, "--") != 0) {
+                files.push_back(opt);
+                continue;
+            }
+            if (i + 1 >= argc)
+                throw invalid_argument("missing value for " + opt);
+            string value = argv[++i];
+            if (opt == "--threshold" && stod(value) >= 0)
+                opts.threshold = stod(value) / 100;
+            else if (opt == "--alpha" && stod(value) > 0 && stod(value) < 1)
+                opts.alpha = stod(value);
+            else if (opt == "--resamples" && stoul(value) >= 100)
+                opts.resamples = static_cast<unsigned>(stoul(value));
+            else
+                throw invalid_argument("bad option " + opt + " " + value);
+        }
+        if (files.size() != 2)
+            throw invalid_argument("expected two JSON files");
+    } catch (const exception& e) {
+        cerr << "Error: " << e.what() << endl << "Usage: " << argv[0]
+             << " BASELINE.json CANDIDATE.json [--threshold PCT] [--alpha P] [--resamples N] [--all]" << endl;
+        return 2;
+    }
+
+    map<string, BenchCase> base, cand;
+    try {
+        base = loadBench(files[0]);
+        cand = loadBench(files[1]);
+    } catch (const exception& e) {
+        cerr << "Error: " << e.what() << endl;
+        return 2;
+    }
+
+    const double level = 1 - opts.alpha;
+    cout << fixed << setprecision(1);
+    cout << "ratio = candidate / baseline median time; " << 100 * level << "% bootstrap CI; threshold "
+         << 100 * opts.threshold << "%" << endl;
+    cout << left << setw(26) << "case" << right << setw(16) << "base median" << setw(16) << "cand median"
+         << setw(9) << "ratio" << setw(19) << "CI" << setw(10) << "p" << "  verdict" << endl;
+
+    int regressions = 0, gatedRegressions = 0;
+    for (const auto& entry : base) {
+        const BenchCase& a = entry.second;
+        auto found = cand.find(entry.first);
+        if (found == cand.end()) {
+            cout << left << setw(26) << entry.first << right << "  missing from candidate" << endl;
+            continue;
+        }
+        const BenchCase& b = found->second;
+        double ratio = median(b.samplesNs) / median(a.samplesNs);
+        double lo, hi;
+        bootstrapRatio(a.samplesNs, b.samplesNs, opts.resamples, level, lo, hi);
+        double p = mannWhitneyP(a.samplesNs, b.samplesNs);
+
+        string verdict = "same";
+        if (a.samplesNs.size() < 5 || b.samplesNs.size() < 5)
+            verdict = "too few samples";
+        else if (p < opts.alpha && ratio > 1 + opts.threshold && lo > 1)
+            verdict = "REGRESSION";
+        else if (p < opts.alpha && ratio < 1 / (1 + opts.threshold) && hi < 1)
+            verdict = "improvement";
+        else if (p < opts.alpha)
+            verdict = "changed (within threshold)";
+        if (verdict == "REGRESSION") {
+            ++regressions;
+            if (gates(opts, a.name))
+                ++gatedRegressions;
+            else
+                verdict += " (not gating)";
+        }
+
+        ostringstream ci;
+        ci << fixed << setprecision(3) << "[" << lo << ", " << hi << "]";
+        cout << left << setw(26) << entry.first << right << setprecision(1) << setw(16) << median(a.samplesNs)
+             << setw(16) << median(b.samplesNs) << setprecision(3) << setw(9) << ratio << setw(19) << ci.str()
+             << setprecision(4) << setw(10) << p << "  " << verdict << setprecision(3) << endl;
+    }
+    for (const auto& entry : cand)
+        if (!base.count(entry.first))
+            cout << left << setw(26) << entry.first << right << "  missing from baseline" << endl;
+
+    cout << regressions << " regression" << (regressions == 1 ? "" : "s") << ", " << gatedRegressions
+         << " in gating cases" << (opts.all ? "" : " (generate, solve_bfs, render)") << endl;
+    return gatedRegressions ? 1 : 0;
+}
@@ -0,0 +1,212 @@
+//
+// Two-tier maze result cache (see hexmaze_cache.h).
+//
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "hexmaze_cache.h"
+#include "hexmaze_fingerprint.h"
+
+using namespace std;
+
+//-----------------------------------------------------------------------------
+// Helpers
+//-----------------------------------------------------------------------------
+
+static string entryName(const MazeCacheKey& key, CacheKind kind) {
+    char bytes[15];
+    memcpy(bytes, &key.rows, 4);
+    memcpy(bytes + 4, &key.cols, 4);
+    memcpy(bytes + 8, &key.seed, 4);
+    bytes[12] = static_cast<char>(key.generator);
+    bytes[13] = static_cast<char>(key.options);
+    bytes[14] = static_cast<char>(kind);
+    return string(bytes, sizeof(bytes));
+}
+
+static string toHex(uint64_t value) {
+    char buf[17];
+    snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(value));
+    return string(buf, 16);
+}
+
+static bool readFile(const string& path, string& out) {
+    ifstream in(path.c_str(), ios::binary);
+    if (!in)
+        return false;
+    out.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+    return !in.bad();
+}
+
+// Writes through a temporary file and rename() so readers never see a
+// partially written file, even with several processes sharing the directory
+static bool writeFileAtomic(const string& path, const char* data, size_t size) {
+    static atomic<uint64_t> tmpCounter(0);
+    string tmp = path + ".tmp." + to_string(getpid()) + "." + to_string(tmpCounter++);
+    {
+        ofstream out(tmp.c_str(), ios::binary | ios::trunc);
+        if (!out)
+            return false;
+        out.write(data, static_cast<streamsize>(size));
+        if (!out) {
+            out.close();
+            unlink(tmp.c_str());
+            return false;
+        }
+    }
+    if (rename(tmp.c_str(), path.c_str()) != 0) {
+        unlink(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+static void makeDir(const string& path) {
+    mkdir(path.c_str(), 0755); // EEXIST is fine
+}
+
+//-----------------------------------------------------------------------------
+// MazeCache
+//-----------------------------------------------------------------------------
+MazeCache::MazeCache(size_t memoryBytes, const string& dir)
+    : shardCapacity(memoryBytes / SHARD_COUNT), diskDir(dir),
+      memoryHits(0), diskHits(0), misses(0), evictions(0) {
+    if (!diskDir.empty()) {
+        makeDir(diskDir);
+        makeDir(diskDir + "/objects");
+        makeDir(diskDir + "/refs");
+    }
+}
+
+CacheBlob MazeCache::get(const MazeCacheKey& key, CacheKind kind) {
+    string name = entryName(key, kind);
+    uint64_t id = hashBytes(name.data(), name.size());
+
+    CacheBlob blob = memoryGet(id, name);
+    if (blob) {
+        ++memoryHits;
+        return blob;
+    }
+    if (!diskDir.empty()) {
+        blob = diskGet(id, name);
+        if (blob) {
+            ++diskHits;
+            memoryPut(id, name, blob);
+            return blob;
+        }
+    }
+    ++misses;
+    return nullptr;
+}
+
+void MazeCache::put(const MazeCacheKey& key, CacheKind kind, CacheBlob blob) {
+    if (!blob)
+        return;
+    string name = entryName(key, kind);
+    uint64_t id = hashBytes(name.data(), name.size());
+    memoryPut(id, name, blob);
+    if (!diskDir.empty())
+        diskPut(id, name, *blob);
+}
+
+MazeCacheStats MazeCache::stats() const {
+    MazeCacheStats s;
+    s.memoryHits = memoryHits;
+    s.diskHits = diskHits;
+    s.misses = misses;
+    s.evictions = evictions;
+    s.memoryBytes = 0;
+    for (unsigned i = 0; i < SHARD_COUNT; ++i) {
+        const Shard& shard = shards[i];
+        lock_guard<mutex> lock(shard.m);
+        s.memoryBytes += shard.bytes;
+    }
+    return s;
+}
+
+CacheBlob MazeCache::memoryGet(uint64_t id, const EntryName& name) {
+    Shard& shard = shards[id % SHARD_COUNT];
+    lock_guard<mutex> lock(shard.m);
+    auto it = shard.index.find(id);
+    if (it == shard.index.end() || it->second->name != name)
+        return nullptr;
+    shard.lru.splice(shard.lru.begin(), shard.lru, it->second); // Mark most recently used
+    return it->second->blob;
+}
+
+void MazeCache::memoryPut(uint64_t id, const EntryName& name, const CacheBlob& blob) {
+    size_t size = blob->size() + name.size();
+    if (size > shardCapacity)
+        return; // Would evict everything and still not fit
+
+    Shard& shard = shards[id % SHARD_COUNT];
+    lock_guard<mutex> lock(shard.m);
+    auto it = shard.index.find(id);
+    if (it != shard.index.end()) {
+        shard.bytes -= it->second->blob->size() + it->second->name.size();
+        shard.lru.erase(it->second);
+        shard.index.erase(it);
+    }
+
+    shard.lru.push_front(Entry{name, blob});
+    shard.index[id] = shard.lru.begin();
+    shard.bytes += size;
+
+    while (shard.bytes > shardCapacity) {
+        const Entry& victim = shard.lru.back();
+        shard.bytes -= victim.blob->size() + victim.name.size();
+        shard.index.erase(hashBytes(victim.name.data(), victim.name.size()));
+        shard.lru.pop_back();
+        ++evictions;
+    }
+}
+
+// A ref file holds the entry name followed by the 8-byte content hash
+CacheBlob MazeCache::diskGet(uint64_t id, const EntryName& name) {
+    string ref;
+    if (!readFile(diskDir + "/refs/" + toHex(id), ref) || ref.size() != name.size() + 8 ||
+        ref.compare(0, name.size(), name) != 0)
+        return nullptr;
+
+    uint64_t contentHash;
+    memcpy(&contentHash, ref.data() + name.size(), 8);
+    string hex = toHex(contentHash);
+
+    shared_ptr<string> blob = make_shared<string>();
+    if (!readFile(diskDir + "/objects/" + hex.substr(0, 2) + "/" + hex, *blob) ||
+        hashBytes(blob->data(), blob->size()) != contentHash)
+        return nullptr; // Missing or corrupt object
+    return blob;
+}
+
+void MazeCache::diskPut(uint64_t id, const EntryName& name, const string& bytes) {
+    uint64_t contentHash = hashBytes(bytes.data(), bytes.size());
+    string hex = toHex(contentHash);
+    string objectDir = diskDir + "/objects/" + hex.substr(0, 2);
+    string objectPath = objectDir + "/" + hex;
+
+    struct stat st;
+    if (stat(objectPath.c_str(), &st) != 0) {
+        makeDir(objectDir);
+        if (!writeFileAtomic(objectPath, bytes.data(), bytes.size()))
+            return;
+    } else {
+        // Usually the same blob stored for another key. If the content hash
+        // collided instead, the blob stays in memory only rather than have
+        // its ref point at another blob's bytes.
+        string existing;
+        if (static_cast<uint64_t>(st.st_size) != bytes.size() || !readFile(objectPath, existing) ||
+            existing != bytes)
+            return;
+    }
+
+    string ref = name;
+    ref.append(reinterpret_cast<const char*>(&contentHash), 8);
+    writeFileAtomic(diskDir + "/refs/" + toHex(id), ref.data(), ref.size());
+}
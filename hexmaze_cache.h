@@ -0,0 +1,108 @@
+//
+// Two-tier cache for maze results, keyed by everything that determines
+// them: dimensions, seed, generator and render options.
+//
+// Each key holds up to three independent blobs (CacheKind): the generated
+// cells, the solution path and the rendered PostScript. A render-only
+// request that hits CACHE_RENDER never regenerates the maze.
+//
+// Tier 1 is an in-memory LRU bounded by total blob bytes, sharded to keep
+// worker threads from contending on one lock. Tier 2 (optional) is an
+// on-disk content-addressed store:
+//   <dir>/objects/<xx>/<hash>  blob bytes, named by their content hash
+//   <dir>/refs/<namehash>      the entry name (key and kind), then the
+//                              content hash of its blob
+// Identical blobs are stored once, and a blob whose bytes no longer match
+// its name is treated as a miss. A blob whose content hash collides with a
+// different stored blob is kept in memory only. Disk hits are promoted to
+// memory.
+//
+
+#ifndef HEXMAZE_CACHE_H
+#define HEXMAZE_CACHE_H
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+enum CacheKind : uint8_t {
+    CACHE_MAZE = 0,     // rows * cols cell bytes, as generated
+    CACHE_SOLUTION = 1, // uint32_t path cell indices, start to end
+    CACHE_RENDER = 2    // PostScript document
+};
+
+// Maze generation algorithm, part of the key so a future generator can never
+// be served another's output
+enum MazeGenerator : uint8_t {
+    GENERATOR_KRUSKAL = 0 // generateMaze(): randomized Kruskal with DSU
+};
+
+struct MazeCacheKey {
+    uint32_t rows;
+    uint32_t cols;
+    uint32_t seed;
+    uint8_t generator; // MazeGenerator
+    uint8_t options;   // Render options (0 = default two-page document)
+};
+
+struct MazeCacheStats {
+    uint64_t memoryHits;
+    uint64_t diskHits;
+    uint64_t misses;
+    uint64_t evictions;
+    uint64_t memoryBytes; // Blob bytes currently held in memory
+};
+
+typedef std::shared_ptr<const std::string> CacheBlob;
+
+class MazeCache {
+public:
+    // memoryBytes bounds the in-memory tier; diskDir == "" disables the disk tier
+    MazeCache(size_t memoryBytes, const std::string& diskDir = "");
+
+    // Returns nullptr on a miss in both tiers. Safe to call from any thread.
+    CacheBlob get(const MazeCacheKey& key, CacheKind kind);
+
+    // Stores the blob in memory and, if enabled, on disk
+    void put(const MazeCacheKey& key, CacheKind kind, CacheBlob blob);
+
+    MazeCacheStats stats() const;
+    bool diskEnabled() const { return !diskDir.empty(); }
+
+private:
+    static const unsigned SHARD_COUNT = 16;
+
+    // (key, kind) serialized; compared on lookup so a hash collision is a miss
+    typedef std::string EntryName;
+
+    struct Entry {
+        EntryName name;
+        CacheBlob blob;
+    };
+
+    struct Shard {
+        mutable std::mutex m;
+        std::list<Entry> lru; // Most recently used first
+        std::unordered_map<uint64_t, std::list<Entry>::iterator> index;
+        size_t bytes = 0;
+    };
+
+    CacheBlob memoryGet(uint64_t id, const EntryName& name);
+    void memoryPut(uint64_t id, const EntryName& name, const CacheBlob& blob);
+    CacheBlob diskGet(uint64_t id, const EntryName& name);
+    void diskPut(uint64_t id, const EntryName& name, const std::string& bytes);
+
+    size_t shardCapacity;
+    std::string diskDir;
+    Shard shards[SHARD_COUNT];
+    std::atomic<uint64_t> memoryHits;
+    std::atomic<uint64_t> diskHits;
+    std::atomic<uint64_t> misses;
+    std::atomic<uint64_t> evictions;
+};
+
+#endif // HEXMAZE_CACHE_H
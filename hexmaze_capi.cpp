@@ -0,0 +1,150 @@
+//
+// C ABI for libhexmaze (declared in hexmaze.h).
+// Thin wrappers over the C++ functions in hexpathfinder.h; no exception
+// is allowed to cross the extern "C" boundary.
+//
+
+#include <new>
+#include <random>
+#include <ostream>
+#include <string>
+
+#include "hexmaze.h"
+#include "hexpathfinder.h"
+#include "hexmaze_fingerprint.h"
+#include "hexmaze_delta.h"
+
+using namespace std;
+
+static_assert(HEXMAZE_MAX_ROWS == MAX_ROWS && HEXMAZE_MAX_COLS == MAX_COLS,
+              "hexmaze.h limits must match hexpathfinder.h");
+
+struct hexmaze {
+    uint32_t rows;
+    uint32_t cols;
+    uint8_t cells[MAX_ROWS][MAX_COLS];
+    mt19937 rng;
+    GeneratorWorkspace generator;
+    SolverWorkspace solver;
+    string rendered;
+    string delta;
+};
+
+extern "C" {
+
+int hexmaze_api_version(void) {
+    return HEXMAZE_API_VERSION;
+}
+
+hexmaze_t* hexmaze_create(uint32_t rows, uint32_t cols) {
+    if (rows == 0 || rows > MAX_ROWS || cols == 0 || cols > MAX_COLS)
+        return nullptr;
+
+    hexmaze_t* maze = new (nothrow) hexmaze_t();
+    if (!maze)
+        return nullptr;
+
+    maze->rows = rows;
+    maze->cols = cols;
+    for (uint32_t r = 0; r < rows; ++r)
+        for (uint32_t c = 0; c < cols; ++c)
+            maze->cells[r][c] = ALL_WALLS;
+    return maze;
+}
+
+void hexmaze_free(hexmaze_t* maze) {
+    delete maze;
+}
+
+uint32_t hexmaze_rows(const hexmaze_t* maze) {
+    return maze ? maze->rows : 0;
+}
+
+uint32_t hexmaze_cols(const hexmaze_t* maze) {
+    return maze ? maze->cols : 0;
+}
+
+uint8_t hexmaze_cell(const hexmaze_t* maze, uint32_t r, uint32_t c) {
+    if (!maze || r >= maze->rows || c >= maze->cols)
+        return 0;
+    return maze->cells[r][c];
+}
+
+int hexmaze_generate(hexmaze_t* maze, uint32_t seed) {
+    if (!maze)
+        return HEXMAZE_ERR_INVALID_ARGUMENT;
+    try {
+        maze->rng.seed(seed);
+        generateMaze(maze->cells, maze->rows, maze->cols, maze->rng, maze->generator);
+    } catch (const bad_alloc&) {
+        return HEXMAZE_ERR_OUT_OF_MEMORY;
+    }
+    return HEXMAZE_OK;
+}
+
+int hexmaze_solve(hexmaze_t* maze) {
+    if (!maze)
+        return HEXMAZE_ERR_INVALID_ARGUMENT;
+    try {
+        if (!solveMazeBFS(maze->cells, maze->rows, maze->cols, maze->solver))
+            return HEXMAZE_ERR_NO_SOLUTION;
+    } catch (const bad_alloc&) {
+        return HEXMAZE_ERR_OUT_OF_MEMORY;
+    }
+    return HEXMAZE_OK;
+}
+
+int hexmaze_render(hexmaze_t* maze, const char** data, size_t* size) {
+    if (!maze || !data || !size)
+        return HEXMAZE_ERR_INVALID_ARGUMENT;
+    try {
+        maze->rendered.clear();
+        StringSink sink(maze->rendered);
+        ostream out(&sink);
+        renderMaze(out, maze->cells, maze->rows, maze->cols);
+        if (!out)
+            return HEXMAZE_ERR_OUT_OF_MEMORY;
+    } catch (const bad_alloc&) {
+        return HEXMAZE_ERR_OUT_OF_MEMORY;
+    }
+    *data = maze->rendered.data();
+    *size = maze->rendered.size();
+    return HEXMAZE_OK;
+}
+
+int hexmaze_fingerprint(const hexmaze_t* maze, int canonical, uint64_t out[2]) {
+    if (!maze || !out)
+        return HEXMAZE_ERR_INVALID_ARGUMENT;
+    MazeFingerprint f = fingerprintMaze(maze->cells, maze->rows, maze->cols, canonical != 0);
+    out[0] = f.lo;
+    out[1] = f.hi;
+    return HEXMAZE_OK;
+}
+
+int hexmaze_delta(hexmaze_t* from, const hexmaze_t* to, const uint8_t** data, size_t* size) {
+    if (!from || !to || !data || !size || from->rows != to->rows || from->cols != to->cols)
+        return HEXMAZE_ERR_INVALID_ARGUMENT;
+    try {
+        if (!makeDelta(from->cells, to->cells, from->rows, from->cols, from->delta))
+            return HEXMAZE_ERR_INVALID_ARGUMENT;
+    } catch (const bad_alloc&) {
+        return HEXMAZE_ERR_OUT_OF_MEMORY;
+    }
+    *data = reinterpret_cast<const uint8_t*>(from->delta.data());
+    *size = from->delta.size();
+    return HEXMAZE_OK;
+}
+
+int hexmaze_apply_delta(hexmaze_t* maze, const uint8_t* data, size_t size) {
+    if (!maze || (!data && size))
+        return HEXMAZE_ERR_INVALID_ARGUMENT;
+    try {
+        if (!applyDelta(maze->cells, maze->rows, maze->cols, data, size))
+            return HEXMAZE_ERR_INVALID_ARGUMENT;
+    } catch (const bad_alloc&) {
+        return HEXMAZE_ERR_OUT_OF_MEMORY;
+    }
+    return HEXMAZE_OK;
+}
+
+} // extern "C"
@@ -0,0 +1,397 @@
+//
+// Persistent memory-mapped maze catalog (see hexmaze_catalog.h).
+//
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "hexmaze_catalog.h"
+
+using namespace std;
+
+static const char FILE_MAGIC[8] = {'H', 'X', 'C', 'A', 'T', 'L', 'G', '1'};
+static const char INDEX_MAGIC[8] = {'H', 'X', 'C', 'I', 'D', 'X', '0', '1'};
+static const uint32_t CATALOG_VERSION = 1;
+static const uint32_t CATALOG_RECORD_MAGIC = 0x52435848u; // "HXCR"
+
+// The walls each cell owns, in bit order within a cell's 3-bit group
+static const uint8_t OWNED_WALLS[3] = {WALL_DOWN, WALL_UP_RIGHT, WALL_DOWN_RIGHT};
+
+//-----------------------------------------------------------------------------
+// Helpers
+//-----------------------------------------------------------------------------
+static uint32_t fnv1a32(const uint8_t* data, size_t size) {
+    uint32_t h = 0x811c9dc5u;
+    for (size_t i = 0; i < size; ++i) {
+        h ^= data[i];
+        h *= 0x01000193u;
+    }
+    return h;
+}
+
+static size_t packedBytes(uint32_t rows, uint32_t cols) {
+    size_t bytes = (static_cast<size_t>(rows) * cols * 3 + 7) / 8;
+    return (bytes + 7) & ~static_cast<size_t>(7);
+}
+
+// Reads the header of the record at offset into h; true if the record is
+// whole (its payload inside size) and its payload matches the checksum
+static bool intactRecord(const uint8_t* data, size_t size, uint64_t offset, CatalogRecordHeader& h) {
+    if (offset + sizeof(h) > size)
+        return false;
+    memcpy(&h, data + offset, sizeof(h));
+    return h.magic == CATALOG_RECORD_MAGIC && h.rows != 0 && h.rows <= MAX_ROWS && h.cols != 0 &&
+           h.cols <= MAX_COLS && h.payloadBytes == packedBytes(h.rows, h.cols) &&
+           offset + sizeof(h) + h.payloadBytes <= size &&
+           fnv1a32(data + offset + sizeof(h), h.payloadBytes) == h.checksum;
+}
+
+// Calls fn(offset, header) for every intact record and returns the offset
+// just past the last one; anything after that is a torn or foreign tail
+template <class Fn>
+static uint64_t scanRecords(const uint8_t* data, size_t size, Fn fn) {
+    uint64_t offset = sizeof(CatalogFileHeader);
+    CatalogRecordHeader h;
+    while (intactRecord(data, size, offset, h)) {
+        fn(offset, h);
+        offset += sizeof(h) + h.payloadBytes;
+    }
+    return offset;
+}
+
+static bool validFileHeader(const uint8_t* data, size_t size) {
+    CatalogFileHeader h;
+    if (size < sizeof(h))
+        return false;
+    memcpy(&h, data, sizeof(h));
+    return memcmp(h.magic, FILE_MAGIC, sizeof(FILE_MAGIC)) == 0 && h.version == CATALOG_VERSION;
+}
+
+// Read-only mapping of a whole file; returns nullptr for empty or missing files
+static const uint8_t* mapFile(const string& path, size_t& size) {
+    size = 0;
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return nullptr;
+    struct stat st;
+    void* p = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        p = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        if (p != MAP_FAILED)
+            size = static_cast<size_t>(st.st_size);
+    }
+    ::close(fd);
+    return p == MAP_FAILED ? nullptr : static_cast<const uint8_t*>(p);
+}
+
+static bool writeAll(int fd, const void* buf, size_t size, uint64_t offset) {
+    const char* p = static_cast<const char*>(buf);
+    while (size > 0) {
+        ssize_t n = pwrite(fd, p, size, static_cast<off_t>(offset));
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        p += n;
+        size -= static_cast<size_t>(n);
+        offset += static_cast<uint64_t>(n);
+    }
+    return true;
+}
+
+static bool entryLess(const CatalogIndexEntry& a, const CatalogIndexEntry& b) {
+    if (a.rows != b.rows) return a.rows < b.rows;
+    if (a.cols != b.cols) return a.cols < b.cols;
+    if (a.key != b.key) return a.key < b.key;
+    return a.offset < b.offset;
+}
+
+uint32_t difficultyKey(float difficulty) {
+    if (!(difficulty > 0.0f))
+        return 0;
+    uint32_t bits;
+    memcpy(&bits, &difficulty, sizeof(bits));
+    return bits;
+}
+
+//-----------------------------------------------------------------------------
+// CatalogWriter
+//-----------------------------------------------------------------------------
+bool CatalogWriter::open(const string& path) {
+    close();
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close();
+        return false;
+    }
+
+    if (st.st_size == 0) {
+        CatalogFileHeader h;
+        memcpy(h.magic, FILE_MAGIC, sizeof(h.magic));
+        h.version = CATALOG_VERSION;
+        h.reserved = 0;
+        if (!writeAll(fd, &h, sizeof(h), 0)) {
+            close();
+            return false;
+        }
+        end = sizeof(h);
+        return true;
+    }
+
+    size_t size;
+    const uint8_t* data = mapFile(path, size);
+    bool ok = data && validFileHeader(data, size);
+    if (ok) {
+        end = scanRecords(data, size, [](uint64_t, const CatalogRecordHeader&) {});
+        if (end < size)
+            ok = ftruncate(fd, static_cast<off_t>(end)) == 0; // Drop a torn tail
+    }
+    if (data)
+        munmap(const_cast<uint8_t*>(data), size);
+    if (!ok)
+        close();
+    return ok;
+}
+
+bool CatalogWriter::append(uint8_t maze[][MAX_COLS], uint32_t nR, uint32_t nC, uint32_t seed, const MazeMetrics& metrics) {
+    if (fd < 0 || nR == 0 || nR > MAX_ROWS || nC == 0 || nC > MAX_COLS)
+        return false;
+
+    size_t payload = packedBytes(nR, nC);
+    record.assign(sizeof(CatalogRecordHeader) + payload, 0);
+    uint8_t* bits = record.data() + sizeof(CatalogRecordHeader);
+    size_t bit = 0;
+    for (uint32_t r = 0; r < nR; ++r) {
+        for (uint32_t c = 0; c < nC; ++c) {
+            for (uint8_t wall : OWNED_WALLS) {
+                if (maze[r][c] & wall)
+                    bits[bit >> 3] |= static_cast<uint8_t>(1u << (bit & 7));
+                ++bit;
+            }
+        }
+    }
+
+    CatalogRecordHeader h;
+    h.magic = CATALOG_RECORD_MAGIC;
+    h.rows = static_cast<uint16_t>(nR);
+    h.cols = static_cast<uint16_t>(nC);
+    h.seed = seed;
+    h.solutionLength = metrics.solutionLength;
+    h.deadEnds = metrics.deadEnds;
+    h.difficulty = metrics.difficulty;
+    h.payloadBytes = static_cast<uint32_t>(payload);
+    h.checksum = fnv1a32(bits, payload);
+    memcpy(record.data(), &h, sizeof(h));
+
+    if (!writeAll(fd, record.data(), record.size(), end))
+        return false;
+    end += record.size();
+    return true;
+}
+
+bool CatalogWriter::close() {
+    if (fd < 0)
+        return true;
+    bool ok = fdatasync(fd) == 0;
+    ok = ::close(fd) == 0 && ok;
+    fd = -1;
+    return ok;
+}
+
+//-----------------------------------------------------------------------------
+// Index Build
+//-----------------------------------------------------------------------------
+int64_t buildCatalogIndex(const string& path) {
+    size_t size;
+    const uint8_t* data = mapFile(path, size);
+    if (!data || !validFileHeader(data, size)) {
+        if (data)
+            munmap(const_cast<uint8_t*>(data), size);
+        return -1;
+    }
+
+    vector<CatalogIndexEntry> sections[CATALOG_KEY_COUNT];
+    uint64_t validEnd = scanRecords(data, size, [&sections](uint64_t offset, const CatalogRecordHeader& h) {
+        uint32_t keys[CATALOG_KEY_COUNT] = {h.seed, h.solutionLength, h.deadEnds, difficultyKey(h.difficulty)};
+        for (unsigned k = 0; k < CATALOG_KEY_COUNT; ++k)
+            sections[k].push_back(CatalogIndexEntry{h.rows, h.cols, keys[k], offset});
+    });
+    munmap(const_cast<uint8_t*>(data), size);
+
+    for (auto& section : sections)
+        sort(section.begin(), section.end(), entryLess);
+
+    CatalogIndexHeader h;
+    memcpy(h.magic, INDEX_MAGIC, sizeof(h.magic));
+    h.dataSize = validEnd;
+    h.count = sections[0].size();
+    h.reserved = 0;
+
+    // Write beside the old index and rename over it, so open readers keep a
+    // consistent (if stale) view
+    string indexPath = path + ".idx";
+    string tmpPath = indexPath + ".tmp." + to_string(getpid());
+    {
+        ofstream out(tmpPath.c_str(), ios::binary | ios::trunc);
+        out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+        for (const auto& section : sections)
+            out.write(reinterpret_cast<const char*>(section.data()),
+                      static_cast<streamsize>(section.size() * sizeof(CatalogIndexEntry)));
+        if (!out) {
+            unlink(tmpPath.c_str());
+            return -1;
+        }
+    }
+    if (rename(tmpPath.c_str(), indexPath.c_str()) != 0) {
+        unlink(tmpPath.c_str());
+        return -1;
+    }
+    return static_cast<int64_t>(h.count);
+}
+
+//-----------------------------------------------------------------------------
+// MazeCatalog
+//-----------------------------------------------------------------------------
+MazeCatalog::MazeCatalog()
+    : data(nullptr), dataSize(0), index(nullptr), indexSize(0), count(0), indexedDataSize(0) {}
+
+MazeCatalog::~MazeCatalog() {
+    close();
+}
+
+bool MazeCatalog::open(const string& path) {
+    close();
+    data = mapFile(path, dataSize);
+    index = mapFile(path + ".idx", indexSize);
+    if (!data || !validFileHeader(data, dataSize) || !index || indexSize < sizeof(CatalogIndexHeader)) {
+        close();
+        return false;
+    }
+
+    CatalogIndexHeader h;
+    memcpy(&h, index, sizeof(h));
+    if (memcmp(h.magic, INDEX_MAGIC, sizeof(h.magic)) != 0 || h.dataSize > dataSize ||
+        indexSize != sizeof(h) + CATALOG_KEY_COUNT * h.count * sizeof(CatalogIndexEntry)) {
+        close();
+        return false;
+    }
+    count = h.count;
+    indexedDataSize = h.dataSize;
+    madvise(const_cast<uint8_t*>(index), indexSize, MADV_RANDOM); // Binary search touches few pages
+    return true;
+}
+
+void MazeCatalog::close() {
+    if (data)
+        munmap(const_cast<uint8_t*>(data), dataSize);
+    if (index)
+        munmap(const_cast<uint8_t*>(index), indexSize);
+    data = index = nullptr;
+    dataSize = indexSize = 0;
+    count = indexedDataSize = 0;
+}
+
+bool MazeCatalog::indexCurrent() const {
+    return data && indexedDataSize == dataSize;
+}
+
+uint64_t MazeCatalog::size() const {
+    return count;
+}
+
+bool MazeCatalog::readEntry(uint64_t offset, CatalogEntry& entry) const {
+    if (offset + sizeof(CatalogRecordHeader) > dataSize)
+        return false;
+    CatalogRecordHeader h;
+    memcpy(&h, data + offset, sizeof(h));
+    if (h.magic != CATALOG_RECORD_MAGIC)
+        return false;
+    entry.rows = h.rows;
+    entry.cols = h.cols;
+    entry.seed = h.seed;
+    entry.solutionLength = h.solutionLength;
+    entry.deadEnds = h.deadEnds;
+    entry.difficulty = h.difficulty;
+    entry.offset = offset;
+    return true;
+}
+
+bool MazeCatalog::find(uint32_t rows, uint32_t cols, uint32_t seed, CatalogEntry& entry) const {
+    if (!index)
+        return false;
+    const CatalogIndexEntry* section = reinterpret_cast<const CatalogIndexEntry*>(index + sizeof(CatalogIndexHeader)) +
+                                       CATALOG_BY_SEED * count;
+    CatalogIndexEntry probe = {static_cast<uint16_t>(rows), static_cast<uint16_t>(cols), seed, 0};
+    const CatalogIndexEntry* it = lower_bound(section, section + count, probe, entryLess);
+    if (it == section + count || it->rows != rows || it->cols != cols || it->key != seed)
+        return false;
+    return readEntry(it->offset, entry);
+}
+
+void MazeCatalog::range(uint32_t rows, uint32_t cols, CatalogKey by, uint32_t lo, uint32_t hi,
+                        vector<CatalogEntry>& out, size_t limit) const {
+    if (!index || by >= CATALOG_KEY_COUNT || lo > hi)
+        return;
+    const CatalogIndexEntry* section = reinterpret_cast<const CatalogIndexEntry*>(index + sizeof(CatalogIndexHeader)) +
+                                       by * count;
+    CatalogIndexEntry probe = {static_cast<uint16_t>(rows), static_cast<uint16_t>(cols), lo, 0};
+    const CatalogIndexEntry* it = lower_bound(section, section + count, probe, entryLess);
+    for (; it != section + count && limit > 0; ++it, --limit) {
+        if (it->rows != rows || it->cols != cols || it->key > hi)
+            break;
+        CatalogEntry entry;
+        if (readEntry(it->offset, entry))
+            out.push_back(entry);
+    }
+}
+
+void MazeCatalog::all(vector<CatalogEntry>& out) const {
+    if (!index)
+        return;
+    const CatalogIndexEntry* section = reinterpret_cast<const CatalogIndexEntry*>(index + sizeof(CatalogIndexHeader)) +
+                                       CATALOG_BY_SEED * count;
+    out.reserve(out.size() + count);
+    for (uint64_t i = 0; i < count; ++i) {
+        CatalogEntry entry;
+        if (readEntry(section[i].offset, entry))
+            out.push_back(entry);
+    }
+}
+
+bool MazeCatalog::load(const CatalogEntry& entry, uint8_t maze[][MAX_COLS]) const {
+    CatalogRecordHeader h;
+    if (!data || !intactRecord(data, dataSize, entry.offset, h))
+        return false;
+
+    const uint32_t nR = h.rows, nC = h.cols;
+    for (uint32_t r = 0; r < nR; ++r)
+        for (uint32_t c = 0; c < nC; ++c)
+            maze[r][c] = ALL_WALLS;
+
+    const uint8_t* bits = data + entry.offset + sizeof(h);
+    size_t bit = 0;
+    for (uint32_t r = 0; r < nR; ++r) {
+        for (uint32_t c = 0; c < nC; ++c) {
+            for (uint8_t wall : OWNED_WALLS) {
+                uint32_t r2, c2;
+                if (!(bits[bit >> 3] & (1u << (bit & 7))) && getNeighbor(r, c, wall, nR, nC, r2, c2)) {
+                    maze[r][c] &= ~wall;
+                    maze[r2][c2] &= ~getOppositeWall(wall);
+                }
+                ++bit;
+            }
+        }
+    }
+    return true;
+}
@@ -0,0 +1,161 @@
+//
+// Persistent maze catalog: an append-only data file of compact mazes with
+// their metrics, plus a sorted index answered straight from mmap'd pages.
+//
+// <path>       data file: CatalogFileHeader, then one record per maze
+//              (CatalogRecordHeader + walls packed 3 bits per cell, padded
+//              to 8 bytes). Records are only ever appended; a torn record
+//              at the tail (crash mid-append) is ignored and overwritten by
+//              the next append.
+// <path>.idx   index file, rebuilt by buildCatalogIndex(): one array of
+//              CatalogIndexEntry per CatalogKey, each sorted by
+//              (rows, cols, key, offset). Lookups and range queries are
+//              binary searches over these arrays.
+//
+// Only the three walls each cell owns (WALL_DOWN, WALL_UP_RIGHT,
+// WALL_DOWN_RIGHT) are stored; the rest follow from symmetry and the closed
+// outer border, so a 50x50 maze takes 944 bytes plus a 32-byte header.
+//
+
+#ifndef HEXMAZE_CATALOG_H
+#define HEXMAZE_CATALOG_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "hexpathfinder.h"
+
+// Sort orders kept in the index
+enum CatalogKey : uint32_t {
+    CATALOG_BY_SEED = 0,
+    CATALOG_BY_SOLUTION_LENGTH = 1,
+    CATALOG_BY_DEAD_ENDS = 2,
+    CATALOG_BY_DIFFICULTY = 3, // Key is the float's bit pattern (orders like the value for >= 0)
+    CATALOG_KEY_COUNT = 4
+};
+
+struct CatalogFileHeader {
+    char magic[8]; // "HXCATLG1"
+    uint32_t version;
+    uint32_t reserved;
+};
+
+struct CatalogRecordHeader {
+    uint32_t magic; // CATALOG_RECORD_MAGIC
+    uint16_t rows;
+    uint16_t cols;
+    uint32_t seed;
+    uint32_t solutionLength;
+    uint32_t deadEnds;
+    float difficulty;
+    uint32_t payloadBytes; // Packed walls, including padding
+    uint32_t checksum;     // FNV-1a over the payload
+};
+
+struct CatalogIndexHeader {
+    char magic[8];     // "HXCIDX01"
+    uint64_t dataSize; // Data file size the index was built from
+    uint64_t count;    // Entries per section
+    uint64_t reserved;
+};
+
+struct CatalogIndexEntry {
+    uint16_t rows;
+    uint16_t cols;
+    uint32_t key;    // Seed or metric, per section
+    uint64_t offset; // Record offset in the data file
+};
+
+static_assert(sizeof(CatalogFileHeader) == 16, "catalog layout");
+static_assert(sizeof(CatalogRecordHeader) == 32, "catalog layout");
+static_assert(sizeof(CatalogIndexHeader) == 32, "catalog layout");
+static_assert(sizeof(CatalogIndexEntry) == 16, "catalog layout");
+
+// A record as seen through the catalog
+struct CatalogEntry {
+    uint32_t rows;
+    uint32_t cols;
+    uint32_t seed;
+    uint32_t solutionLength;
+    uint32_t deadEnds;
+    float difficulty;
+    uint64_t offset;
+};
+
+//-----------------------------------------------------------------------------
+// Catalog Writer
+// Appends records to the data file. Not safe for concurrent writers.
+//-----------------------------------------------------------------------------
+class CatalogWriter {
+public:
+    CatalogWriter() : fd(-1), end(0) {}
+    ~CatalogWriter() { close(); }
+
+    // Creates the file if needed and drops any torn tail record
+    bool open(const std::string& path);
+
+    // maze must already be solved; metrics come from analyzeMaze()
+    bool append(uint8_t maze[][MAX_COLS], uint32_t nR, uint32_t nC, uint32_t seed, const MazeMetrics& metrics);
+
+    // Flushes appended records to stable storage and closes the file
+    bool close();
+
+private:
+    int fd;
+    uint64_t end;                // Offset of the next record
+    std::vector<uint8_t> record; // Reused encode buffer
+};
+
+//-----------------------------------------------------------------------------
+// Maze Catalog
+// Read-only view of a data file and its index, both memory-mapped.
+//-----------------------------------------------------------------------------
+class MazeCatalog {
+public:
+    MazeCatalog();
+    ~MazeCatalog();
+
+    // Fails if the data file or index is missing or malformed
+    bool open(const std::string& path);
+    void close();
+
+    // False if records were appended after the index was built; those
+    // records are invisible until buildCatalogIndex() runs again
+    bool indexCurrent() const;
+    uint64_t size() const; // Indexed records
+
+    // First record with these dimensions and seed
+    bool find(uint32_t rows, uint32_t cols, uint32_t seed, CatalogEntry& entry) const;
+
+    // Records of the given size with lo <= key <= hi, in key order.
+    // For CATALOG_BY_DIFFICULTY use difficultyKey() to build lo and hi.
+    void range(uint32_t rows, uint32_t cols, CatalogKey by, uint32_t lo, uint32_t hi,
+               std::vector<CatalogEntry>& out, size_t limit = SIZE_MAX) const;
+
+    // Every indexed record, ordered by size and seed
+    void all(std::vector<CatalogEntry>& out) const;
+
+    // Decodes the record's walls into maze
+    bool load(const CatalogEntry& entry, uint8_t maze[][MAX_COLS]) const;
+
+private:
+    bool readEntry(uint64_t offset, CatalogEntry& entry) const;
+
+    const uint8_t* data;
+    size_t dataSize;
+    const uint8_t* index;
+    size_t indexSize;
+    uint64_t count;
+    uint64_t indexedDataSize;
+};
+
+// (Re)builds <path>.idx from the data file. Returns the number of records
+// indexed, or -1 on error.
+int64_t buildCatalogIndex(const std::string& path);
+
+// Index key for a difficulty value
+uint32_t difficultyKey(float difficulty);
+
+#endif // HEXMAZE_CATALOG_H
@@ -0,0 +1,220 @@
+//
+// Maze delta encoding (see hexmaze_delta.h).
+//
+
+#include <algorithm>
+#include <cstring>
+
+#include "hexmaze_delta.h"
+
+using namespace std;
+
+// The walls each cell owns, in wall-number order
+static const uint8_t OWNED_WALLS[3] = {WALL_DOWN, WALL_UP_RIGHT, WALL_DOWN_RIGHT};
+static const uint8_t OWNED_MASK = WALL_DOWN | WALL_UP_RIGHT | WALL_DOWN_RIGHT;
+static const uint64_t OWNED_MASK8 = 0x0101010101010101ull * OWNED_MASK;
+
+//-----------------------------------------------------------------------------
+// Helpers
+//-----------------------------------------------------------------------------
+static void putVarint(string& out, uint64_t v) {
+    while (v >= 0x80) {
+        out.push_back(static_cast<char>((v & 0x7F) | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<char>(v));
+}
+
+static bool getVarint(const uint8_t*& p, const uint8_t* end, uint64_t& v) {
+    v = 0;
+    for (int shift = 0; shift < 64 && p < end; shift += 7) {
+        uint8_t byte = *p++;
+        v |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+            return true;
+    }
+    return false;
+}
+
+static int ownedIndex(uint8_t direction) {
+    for (int k = 0; k < 3; ++k)
+        if (OWNED_WALLS[k] == direction)
+            return k;
+    return -1;
+}
+
+// Wall number of an edit, or -1 for a border wall or bad edit
+static int64_t wallNumber(uint32_t nR, uint32_t nC, const WallEdit& edit) {
+    if (edit.cell >= nR * nC)
+        return -1;
+    uint32_t r = edit.cell / nC, c = edit.cell % nC, r2, c2;
+    if (!getNeighbor(r, c, edit.direction, nR, nC, r2, c2))
+        return -1;
+    int k = ownedIndex(edit.direction);
+    if (k < 0) { // Name it from the owning side
+        k = ownedIndex(getOppositeWall(edit.direction));
+        r = r2;
+        c = c2;
+    }
+    return (static_cast<int64_t>(r) * nC + c) * 3 + k;
+}
+
+//-----------------------------------------------------------------------------
+// Diff, Encode, Decode
+//-----------------------------------------------------------------------------
+static inline void diffCell(uint8_t a, uint8_t b, uint32_t cell, vector<WallEdit>& edits) {
+    uint8_t changed = (a ^ b) & OWNED_MASK;
+    for (uint8_t wall : OWNED_WALLS)
+        if (changed & wall)
+            edits.push_back(WallEdit{cell, wall, (b & wall) == 0});
+}
+
+void diffMazes(const uint8_t before[][MAX_COLS], const uint8_t after[][MAX_COLS], uint32_t nR, uint32_t nC,
+               vector<WallEdit>& edits) {
+    for (uint32_t r = 0; r < nR; ++r) {
+        const uint8_t* a = before[r];
+        const uint8_t* b = after[r];
+        uint32_t c = 0;
+        // Edits are sparse: skip eight identical cells per XOR
+        for (; c + 8 <= nC; c += 8) {
+            uint64_t x, y;
+            memcpy(&x, a + c, 8);
+            memcpy(&y, b + c, 8);
+            if (((x ^ y) & OWNED_MASK8) == 0)
+                continue;
+            for (uint32_t i = c; i < c + 8; ++i)
+                diffCell(a[i], b[i], r * nC + i, edits);
+        }
+        for (; c < nC; ++c)
+            diffCell(a[c], b[c], r * nC + c, edits);
+    }
+}
+
+bool encodeDelta(uint32_t nR, uint32_t nC, const vector<WallEdit>& edits, string& out) {
+    // (wall number << 1 | open); a stable sort keeps the last edit to each
+    // wall after its earlier ones
+    vector<uint64_t> walls;
+    walls.reserve(edits.size());
+    for (const WallEdit& edit : edits) {
+        int64_t n = wallNumber(nR, nC, edit);
+        if (n < 0)
+            return false;
+        walls.push_back(static_cast<uint64_t>(n) << 1 | (edit.open ? 1 : 0));
+    }
+    stable_sort(walls.begin(), walls.end(), [](uint64_t x, uint64_t y) { return (x >> 1) < (y >> 1); });
+
+    // Runs of consecutive walls with the same operation
+    string runs;
+    uint64_t runCount = 0, prevEnd = 0;
+    for (size_t i = 0; i < walls.size();) {
+        size_t j = i;
+        while (j + 1 < walls.size() && (walls[j + 1] >> 1) == (walls[j] >> 1))
+            ++j; // Duplicates: keep the last
+        uint64_t start = walls[j] >> 1, open = walls[j] & 1, length = 1;
+        i = j + 1;
+        while (i < walls.size()) {
+            j = i;
+            while (j + 1 < walls.size() && (walls[j + 1] >> 1) == (walls[j] >> 1))
+                ++j;
+            if ((walls[j] >> 1) != start + length || (walls[j] & 1) != open)
+                break;
+            ++length;
+            i = j + 1;
+        }
+        putVarint(runs, (start - prevEnd) << 1 | open);
+        putVarint(runs, length - 1);
+        prevEnd = start + length;
+        ++runCount;
+    }
+
+    out.clear();
+    out.push_back(static_cast<char>(DELTA_FORMAT_VERSION));
+    putVarint(out, nR);
+    putVarint(out, nC);
+    putVarint(out, runCount);
+    out += runs;
+    return true;
+}
+
+bool decodeDelta(const void* data, size_t size, uint32_t nR, uint32_t nC, vector<WallEdit>& edits) {
+    edits.clear();
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    const uint8_t* end = p + size;
+    uint64_t rows, cols, runCount;
+    if (size == 0 || *p++ != DELTA_FORMAT_VERSION || !getVarint(p, end, rows) || !getVarint(p, end, cols) ||
+        !getVarint(p, end, runCount) || rows != nR || cols != nC)
+        return false;
+
+    const uint64_t wallCount = static_cast<uint64_t>(nR) * nC * 3;
+    uint64_t next = 0;
+    for (uint64_t i = 0; i < runCount; ++i) {
+        uint64_t head, extra;
+        if (!getVarint(p, end, head) || !getVarint(p, end, extra))
+            return false;
+        uint64_t gap = head >> 1;
+        if (gap > wallCount - next || extra >= wallCount - next - gap)
+            return false;
+        uint64_t wall = next + gap;
+        next = wall + extra + 1;
+        for (; wall < next; ++wall) {
+            WallEdit edit = {static_cast<uint32_t>(wall / 3), OWNED_WALLS[wall % 3], (head & 1) != 0};
+            uint32_t r2, c2;
+            if (!getNeighbor(edit.cell / nC, edit.cell % nC, edit.direction, nR, nC, r2, c2))
+                return false; // Border wall
+            edits.push_back(edit);
+        }
+    }
+    return p == end;
+}
+
+//-----------------------------------------------------------------------------
+// Apply
+//-----------------------------------------------------------------------------
+bool applyWallEdit(uint8_t maze[][MAX_COLS], uint32_t nR, uint32_t nC, const WallEdit& edit) {
+    if (edit.cell >= nR * nC)
+        return false;
+    uint32_t r = edit.cell / nC, c = edit.cell % nC, r2, c2;
+    if (!getNeighbor(r, c, edit.direction, nR, nC, r2, c2))
+        return false;
+    uint8_t opposite = getOppositeWall(edit.direction);
+    if (edit.open) {
+        maze[r][c] &= ~edit.direction;
+        maze[r2][c2] &= ~opposite;
+    } else {
+        maze[r][c] |= edit.direction;
+        maze[r2][c2] |= opposite;
+    }
+    return true;
+}
+
+bool applyDelta(uint8_t maze[][MAX_COLS], uint32_t nR, uint32_t nC, const void* data, size_t size) {
+    // Decode fully first so a malformed delta changes nothing
+    static thread_local vector<WallEdit> edits;
+    if (!decodeDelta(data, size, nR, nC, edits))
+        return false;
+    for (const WallEdit& edit : edits)
+        applyWallEdit(maze, nR, nC, edit);
+    return true;
+}
+
+bool makeDelta(const uint8_t before[][MAX_COLS], const uint8_t after[][MAX_COLS], uint32_t nR, uint32_t nC,
+               string& out) {
+    static thread_local vector<WallEdit> edits;
+    edits.clear();
+    diffMazes(before, after, nR, nC, edits);
+
+    // diffMazes only sees the owning side of each wall. Replay the edits to
+    // catch changes it cannot express: a border wall, or a wall changed on
+    // one side only.
+    uint8_t replay[MAX_ROWS][MAX_COLS];
+    for (uint32_t r = 0; r < nR; ++r)
+        memcpy(replay[r], before[r], nC);
+    for (const WallEdit& edit : edits)
+        if (!applyWallEdit(replay, nR, nC, edit))
+            return false;
+    for (uint32_t r = 0; r < nR; ++r)
+        for (uint32_t c = 0; c < nC; ++c)
+            if ((replay[r][c] ^ after[r][c]) & ALL_WALLS)
+                return false;
+    return encodeDelta(nR, nC, edits, out);
+}
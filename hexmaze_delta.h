@@ -0,0 +1,69 @@
+//
+// Compact binary deltas between two mazes of the same size, for streaming
+// wall edits to clients instead of whole mazes.
+//
+// Every interior wall is owned by exactly one cell (WALL_DOWN, WALL_UP_RIGHT
+// or WALL_DOWN_RIGHT of that cell) and gets the wall number
+// (r * cols + c) * 3 + k, k being the direction's position in that list.
+// A delta is the sorted list of changed walls, run-length encoded:
+//
+//   u8      DELTA_FORMAT_VERSION
+//   varint  rows, cols
+//   varint  run count
+//   per run:
+//     varint  (gap << 1) | open   gap = first wall - end of previous run
+//     varint  length - 1          consecutive walls, all opened or all closed
+//
+// Varints are LEB128 (7 bits per byte, low group first). An empty delta
+// (identical mazes) is 4 bytes.
+//
+
+#ifndef HEXMAZE_DELTA_H
+#define HEXMAZE_DELTA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "hexpathfinder.h"
+
+const uint8_t DELTA_FORMAT_VERSION = 1;
+
+struct WallEdit {
+    uint32_t cell;     // r * cols + c
+    uint8_t direction; // Any wall bit; normalized to the owning cell when encoded
+    bool open;         // true removes the wall, false puts it back
+};
+
+// Appends the edits that turn before into after, in wall-number order.
+// Compares eight cells per step and only looks closer where they differ.
+// Only the owning side of each wall is compared, so a change to a border
+// wall or to one side of a wall alone is not seen (makeDelta checks).
+void diffMazes(const uint8_t before[][MAX_COLS], const uint8_t after[][MAX_COLS], uint32_t nR, uint32_t nC,
+               std::vector<WallEdit>& edits);
+
+// Replaces out with the encoded delta. Edits may name a wall from either
+// side and come in any order; the last edit to a wall wins. Returns false
+// if an edit is out of range or names a border wall.
+bool encodeDelta(uint32_t nR, uint32_t nC, const std::vector<WallEdit>& edits, std::string& out);
+
+// Replaces edits with the decoded delta (owning-cell form). Returns false
+// for malformed input or a delta made for different dimensions.
+bool decodeDelta(const void* data, size_t size, uint32_t nR, uint32_t nC, std::vector<WallEdit>& edits);
+
+// Sets or clears one wall on both sides (via getNeighbor/getOppositeWall).
+// Returns false if the wall is on the border or the cell is out of range.
+bool applyWallEdit(uint8_t maze[][MAX_COLS], uint32_t nR, uint32_t nC, const WallEdit& edit);
+
+// Decodes and applies a delta in place. On malformed input the maze is
+// left untouched.
+bool applyDelta(uint8_t maze[][MAX_COLS], uint32_t nR, uint32_t nC, const void* data, size_t size);
+
+// diffMazes + encodeDelta; false unless the delta turns before into after
+// in all six wall bits of every cell, i.e. if the mazes differ on a border
+// wall or on one side of a wall only
+bool makeDelta(const uint8_t before[][MAX_COLS], const uint8_t after[][MAX_COLS], uint32_t nR, uint32_t nC,
+               std::string& out);
+
+#endif // HEXMAZE_DELTA_H
@@ -0,0 +1,152 @@
+//
+// Fast content hashing and maze fingerprints (see hexmaze_fingerprint.h).
+//
+
+#include <cstring>
+
+#include "hexmaze_fingerprint.h"
+
+using namespace std;
+
+static const uint64_t PRIME1 = 0x9E3779B185EBCA87ull;
+static const uint64_t PRIME2 = 0xC2B2AE3D27D4EB4Full;
+static const uint64_t PRIME3 = 0x165667B19E3779F9ull;
+static const uint64_t PRIME4 = 0x85EBCA77C2B2AE63ull;
+static const uint64_t PRIME5 = 0x27D4EB2F165667C5ull;
+
+// Wall bits of eight cells at once
+static const uint64_t WALL_MASK8 = 0x3F3F3F3F3F3F3F3Full;
+
+//-----------------------------------------------------------------------------
+// Hash Core
+//-----------------------------------------------------------------------------
+static inline uint64_t rotl(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t load64(const uint8_t* p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint64_t round64(uint64_t acc, uint64_t input) {
+    acc += input * PRIME2;
+    return rotl(acc, 31) * PRIME1;
+}
+
+static inline uint64_t avalanche(uint64_t h) {
+    h ^= h >> 33;
+    h *= PRIME2;
+    h ^= h >> 29;
+    h *= PRIME3;
+    h ^= h >> 32;
+    return h;
+}
+
+// 256-bit state digested into 128 bits. lo alone is a full-quality 64-bit
+// hash; hi mixes the lanes in a different order so the pair does not
+// collide when lo does.
+static MazeFingerprint digest(const void* data, size_t size, uint64_t seed) {
+    uint64_t v1 = seed + PRIME1 + PRIME2;
+    uint64_t v2 = seed + PRIME2;
+    uint64_t v3 = seed;
+    uint64_t v4 = seed - PRIME1;
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+
+    // Independent lanes: the compiler keeps all four multiplies in flight
+    const uint8_t* end = p + size;
+    while (end - p >= 32) {
+        v1 = round64(v1, load64(p));
+        v2 = round64(v2, load64(p + 8));
+        v3 = round64(v3, load64(p + 16));
+        v4 = round64(v4, load64(p + 24));
+        p += 32;
+    }
+
+    uint64_t tail[4] = {0, 0, 0, 0};
+    memcpy(tail, p, static_cast<size_t>(end - p));
+    v1 = round64(v1, tail[0]);
+    v2 = round64(v2, tail[1]);
+    v3 = round64(v3, tail[2]);
+    v4 = round64(v4, tail[3]);
+
+    uint64_t len = static_cast<uint64_t>(size) * PRIME5;
+    MazeFingerprint f;
+    f.lo = avalanche(rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18) + len);
+    f.hi = avalanche((rotl(v4, 3) ^ v1 * PRIME4) + (rotl(v2, 27) ^ v3 * PRIME3) + (len ^ PRIME4));
+    return f;
+}
+
+uint64_t hashBytes(const void* data, size_t size, uint64_t seed) {
+    return digest(data, size, seed).lo;
+}
+
+MazeFingerprint hashBytes128(const void* data, size_t size, uint64_t seed) {
+    return digest(data, size, seed);
+}
+
+//-----------------------------------------------------------------------------
+// Maze Fingerprints
+//-----------------------------------------------------------------------------
+
+// Wall bits of a 180 degree rotation: each direction becomes its opposite,
+// which in the CellValues layout is a 3-bit rotation of the six wall bits
+static inline uint8_t rotateWalls(uint8_t walls) {
+    return static_cast<uint8_t>(((walls << 3) | (walls >> 3)) & ALL_WALLS);
+}
+
+// Wall bits of a left/right mirror: UP_RIGHT <-> UP_LEFT, DOWN_RIGHT <-> DOWN_LEFT
+static inline uint8_t mirrorWalls(uint8_t walls) {
+    return static_cast<uint8_t>((walls & (WALL_UP | WALL_DOWN)) |
+                                ((walls & WALL_UP_RIGHT) << 4) | ((walls & WALL_UP_LEFT) >> 4) |
+                                ((walls & WALL_DOWN_RIGHT) << 2) | ((walls & WALL_DOWN_LEFT) >> 2));
+}
+
+static inline uint64_t dimensionSeed(uint32_t nR, uint32_t nC) {
+    return (static_cast<uint64_t>(nR) << 32) | nC;
+}
+
+MazeFingerprint fingerprintMaze(const uint8_t maze[][MAX_COLS], uint32_t nR, uint32_t nC, bool canonical) {
+    // Gather the rows into one contiguous run of wall bits. Masking eight
+    // cells per step keeps this pass at copy speed.
+    static thread_local uint8_t cells[MAX_ROWS * MAX_COLS];
+    uint8_t* out = cells;
+    for (uint32_t r = 0; r < nR; ++r) {
+        const uint8_t* row = maze[r];
+        uint32_t c = 0;
+        for (; c + 8 <= nC; c += 8) {
+            uint64_t v = load64(row + c) & WALL_MASK8;
+            memcpy(out + c, &v, sizeof(v));
+        }
+        for (; c < nC; ++c)
+            out[c] = row[c] & ALL_WALLS;
+        out += nC;
+    }
+    size_t size = static_cast<size_t>(nR) * nC;
+    MazeFingerprint f = digest(cells, size, dimensionSeed(nR, nC));
+    if (!canonical || size < 2)
+        return f;
+
+    // The one non-trivial symmetry this grid admits, applied in place:
+    // reverse the cell order (rotation) or each row (mirror), remapping
+    // directions on the way
+    if (nC % 2 == 0) {
+        for (size_t i = 0, j = size - 1; i <= j && j < size; ++i, --j) {
+            uint8_t a = cells[i];
+            cells[i] = rotateWalls(cells[j]);
+            cells[j] = rotateWalls(a);
+        }
+    } else {
+        for (uint32_t r = 0; r < nR; ++r) {
+            uint8_t* row = cells + static_cast<size_t>(r) * nC;
+            for (uint32_t i = 0, j = nC - 1; i <= j && j < nC; ++i, --j) {
+                uint8_t a = row[i];
+                row[i] = mirrorWalls(row[j]);
+                row[j] = mirrorWalls(a);
+            }
+        }
+    }
+    MazeFingerprint g = digest(cells, size, dimensionSeed(nR, nC));
+    return g < f ? g : f;
+}
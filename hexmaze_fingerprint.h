@@ -0,0 +1,49 @@
+//
+// Fast content hashing and maze fingerprints.
+//
+// hashBytes() / hashBytes128() are non-cryptographic hashes built for
+// throughput: four independent 64-bit lanes consume 32 bytes per step, so
+// the loop is limited by memory bandwidth rather than by a serial
+// multiply chain as FNV-1a is. They are stable across runs and builds and
+// may be persisted (the result cache names its disk objects with them).
+//
+// fingerprintMaze() hashes only the wall structure of a maze (CellValues
+// wall bits; VISITED and DEAD_END are ignored) together with its
+// dimensions. With canonical = true every maze related by a symmetry of
+// the odd-q grid gets the same fingerprint:
+//   - 180 degree rotation, when cols is even
+//   - left/right mirror, when cols is odd
+// (Other flips and 60 degree rotations do not map a rectangular odd-q grid
+// onto itself.)
+//
+
+#ifndef HEXMAZE_FINGERPRINT_H
+#define HEXMAZE_FINGERPRINT_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "hexpathfinder.h"
+
+struct MazeFingerprint {
+    uint64_t lo;
+    uint64_t hi;
+
+    bool operator==(const MazeFingerprint& other) const { return lo == other.lo && hi == other.hi; }
+    bool operator!=(const MazeFingerprint& other) const { return !(*this == other); }
+    bool operator<(const MazeFingerprint& other) const {
+        return hi != other.hi ? hi < other.hi : lo < other.lo;
+    }
+};
+
+// For unordered containers keyed by fingerprint
+struct MazeFingerprintHash {
+    size_t operator()(const MazeFingerprint& f) const { return static_cast<size_t>(f.lo); }
+};
+
+uint64_t hashBytes(const void* data, size_t size, uint64_t seed = 0);
+MazeFingerprint hashBytes128(const void* data, size_t size, uint64_t seed = 0);
+
+MazeFingerprint fingerprintMaze(const uint8_t maze[][MAX_COLS], uint32_t nR, uint32_t nC, bool canonical = false);
+
+#endif // HEXMAZE_FINGERPRINT_H
@@ -0,0 +1,131 @@
+//
+// Memory footprint prediction and admission (see hexmaze_footprint.h).
+//
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+#include "hexmaze_footprint.h"
+#include "hexmaze_parallel.h"
+
+using namespace std;
+
+namespace {
+
+// Code, stacks, stdio and allocator overhead of a running pathfinder
+const uint64_t PROCESS_BASE_BYTES = 16ull << 20;
+
+// Candidate walls listInternalWalls() reserves per cell
+const uint64_t WALLS_PER_CELL = 3;
+
+uint64_t generatorBytesPerCell(const MazePlan& plan) {
+    return plan.indexBytes + WALLS_PER_CELL * sizeof(Wall);
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+// Prediction
+//-----------------------------------------------------------------------------
+MemoryFootprint predictFootprint(const MazePlan& plan) {
+    const uint64_t cells = static_cast<uint64_t>(plan.rows) * plan.cols;
+    const uint64_t threads = max(plan.threads, 1u);
+    MemoryFootprint f = {};
+    f.cells = cells;
+
+    if (plan.generator == GENERATE_KRUSKAL) {
+        f.generator = cells * generatorBytesPerCell(plan);
+    } else {
+        // One workspace per band in flight; a waiting outside thread may run
+        // one more
+        const uint64_t bandRows = min(bandRowsFor(plan.rows), plan.rows);
+        const uint64_t bands = (plan.rows + bandRows - 1) / bandRows;
+        f.generator = min(bands, threads + 1) * bandRows * plan.cols * generatorBytesPerCell(plan);
+    }
+
+    if (plan.solver == SOLVE_BFS)
+        f.solver = 2 * cells * plan.indexBytes; // Distances and queue
+
+    if (plan.render == RENDER_STREAMED) {
+        // A wave of bands rendered into strings; a string's capacity runs
+        // ahead of its text while it grows, by half on average
+        const uint64_t bandCells = max<uint64_t>(RENDER_BAND_CELLS, plan.cols);
+        const uint64_t wave = 4 * (threads + 1);
+        f.render = min(wave * bandCells, cells) * RENDER_BYTES_PER_CELL * 3 / 2;
+    } else if (plan.render == RENDER_IN_MEMORY) {
+        f.render = cells * RENDER_BYTES_PER_CELL * 2 * 3 / 2; // Two pages
+    }
+
+    if (plan.validate) // One union-find parent per cell, 32-bit where that suffices
+        f.validator = cells * (cells <= UINT32_MAX ? sizeof(uint32_t) : sizeof(uint64_t));
+
+    f.peak = PROCESS_BASE_BYTES + f.cells + max(max(f.generator, f.validator), max(f.solver, f.render));
+    return f;
+}
+
+MazePlan streamingPlan(MazePlan plan) {
+    plan.generator = GENERATE_BANDS;
+    plan.solver = SOLVE_DEAD_ENDS;
+    if (plan.render == RENDER_IN_MEMORY)
+        plan.render = RENDER_STREAMED;
+    return plan;
+}
+
+Admission admitMaze(const MazePlan& plan, uint64_t budget, bool allowStreaming,
+                    MazePlan& chosen, MemoryFootprint& predicted) {
+    chosen = plan;
+    predicted = predictFootprint(plan);
+    if (predicted.peak <= budget)
+        return ADMIT;
+    if (!allowStreaming)
+        return REFUSE;
+
+    chosen = streamingPlan(plan);
+    predicted = predictFootprint(chosen);
+    return predicted.peak <= budget ? ADMIT_STREAMING : REFUSE;
+}
+
+//-----------------------------------------------------------------------------
+// Budgets
+//-----------------------------------------------------------------------------
+uint64_t availableMemory() {
+    // Line by line: some fields (HugePages_Total, ...) have no unit
+    ifstream meminfo("/proc/meminfo");
+    string line;
+    while (getline(meminfo, line)) {
+        istringstream fields(line);
+        string key;
+        uint64_t kb;
+        if (fields >> key >> kb && key == "MemAvailable:")
+            return kb * 1024;
+    }
+    return 0;
+}
+
+bool parseByteSize(const string& text, uint64_t& bytes) {
+    if (text.empty() || text.find_first_not_of("0123456789KMGkmg") != string::npos)
+        return false;
+    size_t used = 0;
+    uint64_t value;
+    try {
+        value = stoull(text, &used);
+    } catch (const exception&) {
+        return false;
+    }
+    unsigned shift = 0;
+    if (used + 1 == text.size()) {
+        switch (text[used]) {
+        case 'K': case 'k': shift = 10; break;
+        case 'M': case 'm': shift = 20; break;
+        case 'G': case 'g': shift = 30; break;
+        default: return false;
+        }
+    } else if (used != text.size()) {
+        return false;
+    }
+    if (value > (UINT64_MAX >> shift))
+        return false;
+    bytes = value << shift;
+    return true;
+}
@@ -0,0 +1,83 @@
+//
+// Peak memory prediction for building one run-time sized maze (MazeGrid),
+// and admission of that work against a memory budget.
+//
+// The prediction adds up what each phase allocates: the cell grid, the
+// generator's DSU and wall list (per band in flight for band generation),
+// the solver's distance array and queue, the validator's union-find and the
+// renderer's buffers. Phases
+// release their workspaces before the next one starts, so the peak is the
+// cell grid plus the largest phase. Figures are meant to land a little above
+// the measured peak RSS; the solution path, a vanishing fraction of the cells
+// of a random perfect maze, is left out.
+//
+// When the requested plan does not fit, admitMaze() tries the streaming plan:
+// band generation (one band per thread in memory at a time), dead-end
+// filling in the cells' own flag bits, and rendering straight to the output
+// file. Its peak is little more than the cell grid itself.
+//
+
+#ifndef HEXMAZE_FOOTPRINT_H
+#define HEXMAZE_FOOTPRINT_H
+
+#include <cstdint>
+#include <string>
+
+enum GeneratorKind { GENERATE_KRUSKAL, GENERATE_BANDS };
+enum SolverKind { SOLVE_BFS, SOLVE_DEAD_ENDS };
+enum RenderKind { RENDER_NONE, RENDER_STREAMED, RENDER_IN_MEMORY };
+
+struct MazePlan {
+    uint32_t rows;
+    uint32_t cols;
+    GeneratorKind generator;
+    SolverKind solver;
+    RenderKind render;
+    unsigned threads;    // Scheduler threads: bands and render waves in flight
+    uint32_t indexBytes; // sizeof the cell index type
+    bool validate;       // Checked with validateMaze() after generation
+};
+
+struct MemoryFootprint {
+    uint64_t cells;     // The cell grid, alive throughout
+    uint64_t generator;
+    uint64_t solver;
+    uint64_t render;
+    uint64_t validator;
+    uint64_t peak;      // Process baseline + cells + largest phase
+};
+
+// Mazes above this many cells are generated in bands (see
+// hexmaze_parallel.h), smaller ones with Kruskal over the whole grid. The
+// choice goes by size alone, so the kind of maze and its footprint never
+// depend on the thread count.
+const uint64_t BAND_GENERATION_CELLS = 1 << 20;
+
+inline GeneratorKind generatorFor(uint32_t rows, uint32_t cols) {
+    return static_cast<uint64_t>(rows) * cols > BAND_GENERATION_CELLS ? GENERATE_BANDS : GENERATE_KRUSKAL;
+}
+
+// Rough PostScript bytes per cell and page; measured output stays under it
+const uint64_t RENDER_BYTES_PER_CELL = 128;
+
+MemoryFootprint predictFootprint(const MazePlan& plan);
+
+// plan with band generation, dead-end filling and a streamed render
+MazePlan streamingPlan(MazePlan plan);
+
+enum Admission { ADMIT, ADMIT_STREAMING, REFUSE };
+
+// Decides how to run plan within budget bytes: as asked, downgraded to the
+// streaming plan (unless allowStreaming is false), or not at all. chosen and
+// predicted describe the plan to run, or the last one tried when refused.
+Admission admitMaze(const MazePlan& plan, uint64_t budget, bool allowStreaming,
+                    MazePlan& chosen, MemoryFootprint& predicted);
+
+// MemAvailable from /proc/meminfo, or 0 if unknown
+uint64_t availableMemory();
+
+// Parses a byte count with an optional K, M or G suffix (powers of 1024);
+// returns false on anything else
+bool parseByteSize(const std::string& text, uint64_t& bytes);
+
+#endif // HEXMAZE_FOOTPRINT_H
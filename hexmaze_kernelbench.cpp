@@ -0,0 +1,143 @@
+//
+// Throughput benchmark for the bulk cell kernels (hexmaze_kernels.h).
+// Runs every kernel at every level this CPU supports over buffers of a few
+// sizes, checks that all levels agree, and reports GB/s of cell bytes
+// (neighbor lookups per second for the neighbor batch kernel).
+//
+// Usage: kernelbench [--reps N]
+//
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <random>
+#include <stdexcept>
+
+#include "hexmaze_kernels.h"
+
+using namespace std;
+typedef chrono::steady_clock Clock;
+
+static const size_t BUFFER_SIZES[] = {MAX_ROWS * MAX_COLS, 1000000, 10000000};
+static const char* KERNEL_NAMES[] = {"fill", "clear", "popcount", "degrees", "deadends"};
+const int KERNEL_COUNT = 5;
+
+// Runs one kernel once and returns a checksum of its result
+static uint64_t runKernel(int kernel, vector<uint8_t>& cells, vector<uint8_t>& scratch, vector<uint64_t>& bits) {
+    switch (kernel) {
+    case 0:
+        fillCells(scratch.data(), scratch.size(), ALL_WALLS);
+        return scratch[scratch.size() - 1];
+    case 1:
+        clearCellFlags(cells.data(), cells.size(), VISITED | DEAD_END);
+        return cells[cells.size() - 1];
+    case 2:
+        return countOpenWalls(cells.data(), cells.size());
+    case 3:
+        openWallCounts(cells.data(), cells.size(), scratch.data());
+        return scratch[0] + scratch[scratch.size() - 1];
+    default:
+        return degreeBitmap(cells.data(), cells.size(), 1, bits.data());
+    }
+}
+
+int main(int argc, char* argv[]) {
+    unsigned reps = 20;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            string opt = argv[i];
+            if (opt == "--reps" && i + 1 < argc)
+                reps = static_cast<unsigned>(stoul(argv[++i]));
+            else
+                throw invalid_argument("bad option " + opt);
+        }
+        if (reps == 0)
+            throw invalid_argument("--reps must be positive");
+    } catch (const exception& e) {
+        cerr << "Error: " << e.what() << endl << "Usage: " << argv[0] << " [--reps N]" << endl;
+        return 1;
+    }
+
+    KernelLevel best = bestKernelLevel();
+    mt19937 rng(42);
+    int mismatches = 0;
+
+    cout << fixed << setprecision(2);
+    cout << "best level: " << kernelLevelName(best) << endl;
+    cout << left << setw(10) << "kernel" << setw(10) << "bytes";
+    for (int level = KERNEL_SCALAR; level <= best; ++level)
+        cout << right << setw(10) << kernelLevelName(static_cast<KernelLevel>(level));
+    cout << "  (GB/s)" << endl;
+
+    for (size_t n : BUFFER_SIZES) {
+        // Random wall bits with some VISITED/DEAD_END flags, like a solved maze
+        vector<uint8_t> source(n);
+        for (auto& cell : source)
+            cell = static_cast<uint8_t>(rng() & 0xFF);
+        vector<uint8_t> cells(n), scratch(n);
+        vector<uint64_t> bits((n + 63) / 64);
+
+        for (int kernel = 0; kernel < KERNEL_COUNT; ++kernel) {
+            cout << left << setw(10) << KERNEL_NAMES[kernel] << setw(10) << n << right;
+            uint64_t expected = 0;
+            for (int level = KERNEL_SCALAR; level <= best; ++level) {
+                setKernelLevel(static_cast<KernelLevel>(level));
+                cells = source;
+                uint64_t check = runKernel(kernel, cells, scratch, bits);
+                if (level == KERNEL_SCALAR)
+                    expected = check;
+                else if (check != expected)
+                    ++mismatches;
+
+                double fastest = 1e30;
+                for (unsigned rep = 0; rep < reps; ++rep) {
+                    Clock::time_point start = Clock::now();
+                    runKernel(kernel, cells, scratch, bits);
+                    fastest = min(fastest, chrono::duration<double>(Clock::now() - start).count());
+                }
+                cout << setw(10) << n / fastest / 1e9;
+            }
+            cout << endl;
+        }
+    }
+
+    // Neighbor batches: every direction over every cell of a 1000x1000 grid
+    const uint32_t nR = 1000, nC = 1000;
+    vector<uint32_t> cellIndices(static_cast<size_t>(nR) * nC), neighbors(cellIndices.size());
+    for (size_t i = 0; i < cellIndices.size(); ++i)
+        cellIndices[i] = static_cast<uint32_t>(i);
+    cout << left << setw(10) << "neighbors" << setw(10) << cellIndices.size() * 6 << right;
+    uint64_t expected = 0;
+    for (int level = KERNEL_SCALAR; level <= best; ++level) {
+        setKernelLevel(static_cast<KernelLevel>(level));
+        double fastest = 1e30;
+        uint64_t check = 0;
+        for (unsigned rep = 0; rep < reps; ++rep) {
+            check = 0;
+            Clock::time_point start = Clock::now();
+            for (uint32_t d = 0; d < 6; ++d) {
+                for (size_t i = 0; i < cellIndices.size(); i += NEIGHBOR_BATCH_MAX) {
+                    uint32_t valid = neighborIndices(&cellIndices[i], NEIGHBOR_BATCH_MAX, static_cast<uint8_t>(1u << d),
+                                                     nR, nC, &neighbors[i]);
+                    check += static_cast<uint64_t>(__builtin_popcount(valid)) + neighbors[i];
+                }
+            }
+            fastest = min(fastest, chrono::duration<double>(Clock::now() - start).count());
+        }
+        if (level == KERNEL_SCALAR)
+            expected = check;
+        else if (check != expected)
+            ++mismatches;
+        cout << setw(10) << cellIndices.size() * 6 / fastest / 1e9;
+    }
+    cout << "  (G lookups/s)" << endl;
+    setKernelLevel(best);
+
+    if (mismatches != 0) {
+        cerr << mismatches << " kernel results differ between levels" << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,550 @@
+//
+// Bulk cell kernels (see hexmaze_kernels.h).
+//
+
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HEXMAZE_X86_KERNELS 1
+#endif
+
+#include "hexmaze_kernels.h"
+
+using namespace std;
+
+//-----------------------------------------------------------------------------
+// Scalar
+//-----------------------------------------------------------------------------
+namespace {
+
+inline uint8_t openWalls(uint8_t cell) {
+    uint8_t x = static_cast<uint8_t>(~cell & ALL_WALLS);
+    x = static_cast<uint8_t>(x - ((x >> 1) & 0x55));
+    x = static_cast<uint8_t>((x & 0x33) + ((x >> 2) & 0x33));
+    return static_cast<uint8_t>((x + (x >> 4)) & 0x0F);
+}
+
+void clearFlagsScalar(uint8_t* cells, size_t n, uint8_t flags) {
+    for (size_t i = 0; i < n; ++i)
+        cells[i] &= static_cast<uint8_t>(~flags);
+}
+
+size_t countOpenScalar(const uint8_t* cells, size_t n) {
+    size_t total = 0;
+    for (size_t i = 0; i < n; ++i)
+        total += openWalls(cells[i]);
+    return total;
+}
+
+void degreesScalar(const uint8_t* cells, size_t n, uint8_t* degrees) {
+    for (size_t i = 0; i < n; ++i)
+        degrees[i] = openWalls(cells[i]);
+}
+
+// Writes bits for cells [start, n); start is a multiple of 64
+size_t degreeBitsScalar(const uint8_t* cells, size_t start, size_t n, uint32_t degree, uint64_t* bits) {
+    size_t count = 0;
+    for (size_t w = start; w < n; w += 64) {
+        uint64_t word = 0;
+        size_t end = w + 64 < n ? w + 64 : n;
+        for (size_t i = w; i < end; ++i)
+            word |= static_cast<uint64_t>(openWalls(cells[i]) == degree) << (i - w);
+        bits[w / 64] = word;
+        count += static_cast<size_t>(__builtin_popcountll(word));
+    }
+    return count;
+}
+
+size_t flagBitsScalar(const uint8_t* cells, size_t start, size_t n, uint8_t flags, uint64_t* bits) {
+    size_t count = 0;
+    for (size_t w = start; w < n; w += 64) {
+        uint64_t word = 0;
+        size_t end = w + 64 < n ? w + 64 : n;
+        for (size_t i = w; i < end; ++i)
+            word |= static_cast<uint64_t>((cells[i] & flags) != 0) << (i - w);
+        bits[w / 64] = word;
+        count += static_cast<size_t>(__builtin_popcountll(word));
+    }
+    return count;
+}
+
+size_t degreeBitmapScalar(const uint8_t* cells, size_t n, uint32_t degree, uint64_t* bits) {
+    return degreeBitsScalar(cells, 0, n, degree, bits);
+}
+
+size_t flagBitmapScalar(const uint8_t* cells, size_t n, uint8_t flags, uint64_t* bits) {
+    return flagBitsScalar(cells, 0, n, flags, bits);
+}
+
+// Owned walls of cell a against the cells behind them: b below, ur up-right
+// and dr down-right. Returns the disagreeing wall bits.
+inline uint8_t ownedWallMismatch(uint8_t a, uint8_t b, uint8_t ur, uint8_t dr) {
+    const uint8_t mirrored = static_cast<uint8_t>(((b << 3) & WALL_DOWN) | ((ur >> 3) & WALL_UP_RIGHT) |
+                                                  ((dr >> 3) & WALL_DOWN_RIGHT));
+    return static_cast<uint8_t>((a ^ mirrored) & (WALL_DOWN | WALL_UP_RIGHT | WALL_DOWN_RIGHT));
+}
+
+const uint8_t OWNED_OPEN_COUNT[8] = {0, 1, 1, 2, 1, 2, 2, 3}; // Indexed by owned walls >> 1
+
+size_t asymmetricScalar(const uint8_t* above, const uint8_t* row, const uint8_t* below, size_t n,
+                        uint32_t firstCol, uint64_t& passages) {
+    size_t bad = 0;
+    uint64_t open = 0;
+    for (size_t i = 0; i < n; ++i) {
+        // Up-right is the row above in even columns, down-right the row below
+        // in odd ones
+        const bool odd = ((firstCol + i) & 1) != 0;
+        const uint8_t ur = odd ? row[i + 1] : above[i + 1];
+        const uint8_t dr = odd ? below[i + 1] : row[i + 1];
+        bad += ownedWallMismatch(row[i], below[i], ur, dr) != 0;
+        open += OWNED_OPEN_COUNT[(~row[i] >> 1) & 7];
+    }
+    passages += open;
+    return bad;
+}
+
+uint32_t neighborIndicesScalar(const uint32_t* cells, size_t n, uint32_t d, uint32_t nR, uint32_t nC,
+                               uint32_t* neighbors) {
+    uint32_t valid = 0;
+    for (size_t i = 0; i < n; ++i) {
+        const uint32_t r = cells[i] / nC, c = cells[i] - r * nC;
+        const int32_t r2 = static_cast<int32_t>(r) + ((c & 1) ? NEIGHBOR_ROW_STEP_ODD[d] : NEIGHBOR_ROW_STEP_EVEN[d]);
+        const int32_t c2 = static_cast<int32_t>(c) + NEIGHBOR_COL_STEP[d];
+        neighbors[i] = static_cast<uint32_t>(r2) * nC + static_cast<uint32_t>(c2);
+        if (r2 >= 0 && r2 < static_cast<int32_t>(nR) && c2 >= 0 && c2 < static_cast<int32_t>(nC))
+            valid |= 1u << i;
+    }
+    return valid;
+}
+
+//-----------------------------------------------------------------------------
+// SSE2 (16 cells per step)
+//-----------------------------------------------------------------------------
+#if HEXMAZE_X86_KERNELS
+
+// Per-byte popcount of the open wall bits. There is no byte shift, so
+// shift 16-bit lanes and mask off what crossed between bytes.
+inline __m128i openWalls16(__m128i v) {
+    const __m128i m55 = _mm_set1_epi8(0x55), m33 = _mm_set1_epi8(0x33), m0f = _mm_set1_epi8(0x0F);
+    __m128i x = _mm_andnot_si128(v, _mm_set1_epi8(ALL_WALLS));
+    x = _mm_sub_epi8(x, _mm_and_si128(_mm_srli_epi16(x, 1), m55));
+    x = _mm_add_epi8(_mm_and_si128(x, m33), _mm_and_si128(_mm_srli_epi16(x, 2), m33));
+    return _mm_and_si128(_mm_add_epi8(x, _mm_srli_epi16(x, 4)), m0f);
+}
+
+void clearFlagsSse2(uint8_t* cells, size_t n, uint8_t flags) {
+    const __m128i f = _mm_set1_epi8(static_cast<char>(flags));
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i* p = reinterpret_cast<__m128i*>(cells + i);
+        _mm_storeu_si128(p, _mm_andnot_si128(f, _mm_loadu_si128(p)));
+    }
+    clearFlagsScalar(cells + i, n - i, flags);
+}
+
+size_t countOpenSse2(const uint8_t* cells, size_t n) {
+    __m128i sum = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i d = openWalls16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(cells + i)));
+        sum = _mm_add_epi64(sum, _mm_sad_epu8(d, _mm_setzero_si128()));
+    }
+    uint64_t lanes[2];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), sum);
+    return static_cast<size_t>(lanes[0] + lanes[1]) + countOpenScalar(cells + i, n - i);
+}
+
+void degreesSse2(const uint8_t* cells, size_t n, uint8_t* degrees) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i d = openWalls16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(cells + i)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(degrees + i), d);
+    }
+    degreesScalar(cells + i, n - i, degrees + i);
+}
+
+size_t degreeBitmapSse2(const uint8_t* cells, size_t n, uint32_t degree, uint64_t* bits) {
+    const __m128i want = _mm_set1_epi8(static_cast<char>(degree));
+    size_t count = 0, w = 0;
+    for (; w + 64 <= n; w += 64) {
+        uint64_t word = 0;
+        for (int k = 0; k < 4; ++k) {
+            __m128i d = openWalls16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(cells + w + 16 * k)));
+            word |= static_cast<uint64_t>(static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(d, want))))
+                    << (16 * k);
+        }
+        bits[w / 64] = word;
+        count += static_cast<size_t>(__builtin_popcountll(word));
+    }
+    return count + degreeBitsScalar(cells, w, n, degree, bits);
+}
+
+size_t flagBitmapSse2(const uint8_t* cells, size_t n, uint8_t flags, uint64_t* bits) {
+    const __m128i f = _mm_set1_epi8(static_cast<char>(flags)), zero = _mm_setzero_si128();
+    size_t count = 0, w = 0;
+    for (; w + 64 <= n; w += 64) {
+        uint64_t word = 0;
+        for (int k = 0; k < 4; ++k) {
+            __m128i v = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(cells + w + 16 * k)), f);
+            uint32_t none = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, zero)));
+            word |= static_cast<uint64_t>(~none & 0xFFFFu) << (16 * k);
+        }
+        bits[w / 64] = word;
+        count += static_cast<size_t>(__builtin_popcountll(word));
+    }
+    return count + flagBitsScalar(cells, w, n, flags, bits);
+}
+
+// Lanes of odd columns set, for a run starting at an even column
+inline __m128i oddColumns16() {
+    return _mm_set1_epi16(static_cast<short>(0xFF00));
+}
+
+size_t asymmetricSse2(const uint8_t* above, const uint8_t* row, const uint8_t* below, size_t n,
+                      uint32_t firstCol, uint64_t& passages) {
+    const __m128i owned = _mm_set1_epi8(WALL_DOWN | WALL_UP_RIGHT | WALL_DOWN_RIGHT);
+    const __m128i down = _mm_set1_epi8(WALL_DOWN), upRight = _mm_set1_epi8(WALL_UP_RIGHT);
+    const __m128i downRight = _mm_set1_epi8(WALL_DOWN_RIGHT), one = _mm_set1_epi8(1), zero = _mm_setzero_si128();
+    const __m128i odd = (firstCol & 1) ? _mm_andnot_si128(oddColumns16(), _mm_set1_epi8(-1)) : oddColumns16();
+    __m128i open = zero;
+    size_t bad = 0, i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+        const __m128i right = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i + 1));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(below + i));
+        const __m128i ur = _mm_or_si128(_mm_and_si128(odd, right),
+                                        _mm_andnot_si128(odd, _mm_loadu_si128(reinterpret_cast<const __m128i*>(above + i + 1))));
+        const __m128i dr = _mm_or_si128(_mm_and_si128(odd, _mm_loadu_si128(reinterpret_cast<const __m128i*>(below + i + 1))),
+                                        _mm_andnot_si128(odd, right));
+        // No byte shifts: bits that cross into a neighboring byte are masked off
+        const __m128i mirrored = _mm_or_si128(_mm_and_si128(_mm_slli_epi16(b, 3), down),
+                                              _mm_or_si128(_mm_and_si128(_mm_srli_epi16(ur, 3), upRight),
+                                                           _mm_and_si128(_mm_srli_epi16(dr, 3), downRight)));
+        const __m128i mismatch = _mm_and_si128(_mm_xor_si128(a, mirrored), owned);
+        bad += static_cast<size_t>(16 - __builtin_popcount(_mm_movemask_epi8(_mm_cmpeq_epi8(mismatch, zero))));
+        const __m128i opened = _mm_andnot_si128(a, owned);
+        const __m128i count = _mm_add_epi8(_mm_and_si128(_mm_srli_epi16(opened, 1), one),
+                                           _mm_add_epi8(_mm_and_si128(_mm_srli_epi16(opened, 2), one),
+                                                        _mm_and_si128(_mm_srli_epi16(opened, 3), one)));
+        open = _mm_add_epi64(open, _mm_sad_epu8(count, zero));
+    }
+    uint64_t lanes[2];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), open);
+    passages += lanes[0] + lanes[1];
+    return bad + asymmetricScalar(above + i, row + i, below + i, n - i, firstCol + static_cast<uint32_t>(i), passages);
+}
+
+// Rows and columns of two cell indices (in the low lanes). Integer
+// division has no vector form, but a double quotient of operands this small
+// is exact enough that truncating it gives the true row.
+inline void rowsCols2(__m128i cells, __m128d nCd, __m128i& rows, __m128i& cols) {
+    const __m128d celld = _mm_cvtepi32_pd(cells);
+    rows = _mm_cvttpd_epi32(_mm_div_pd(celld, nCd));
+    cols = _mm_cvttpd_epi32(_mm_sub_pd(celld, _mm_mul_pd(_mm_cvtepi32_pd(rows), nCd)));
+}
+
+uint32_t neighborIndicesSse2(const uint32_t* cells, size_t n, uint32_t d, uint32_t nR, uint32_t nC,
+                             uint32_t* neighbors) {
+    const __m128d nCd = _mm_set1_pd(nC);
+    const __m128i nRv = _mm_set1_epi32(static_cast<int32_t>(nR)), nCv = _mm_set1_epi32(static_cast<int32_t>(nC));
+    const __m128i rowEven = _mm_set1_epi32(NEIGHBOR_ROW_STEP_EVEN[d]);
+    const __m128i oddShift = _mm_set1_epi32(NEIGHBOR_ROW_STEP_ODD[d] - NEIGHBOR_ROW_STEP_EVEN[d]); // 0 or 1
+    const __m128i colStep = _mm_set1_epi32(NEIGHBOR_COL_STEP[d]);
+    uint32_t valid = 0;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cells + i));
+        __m128i r01, c01, r23, c23;
+        rowsCols2(v, nCd, r01, c01);
+        rowsCols2(_mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)), nCd, r23, c23);
+        const __m128i rows = _mm_unpacklo_epi64(r01, r23), cols = _mm_unpacklo_epi64(c01, c23);
+        const __m128i dr = _mm_add_epi32(rowEven, _mm_and_si128(cols, oddShift));
+        const __m128i r2 = _mm_add_epi32(rows, dr), c2 = _mm_add_epi32(cols, colStep);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(neighbors + i),
+                         _mm_add_epi32(v, _mm_add_epi32(neighborRowOffset4(dr, nCv), colStep)));
+        valid |= static_cast<uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(neighborInGrid4(r2, c2, nRv, nCv)))) << i;
+    }
+    if (i < n)
+        valid |= neighborIndicesScalar(cells + i, n - i, d, nR, nC, neighbors + i) << i;
+    return valid;
+}
+
+//-----------------------------------------------------------------------------
+// AVX2 (32 cells per step)
+//-----------------------------------------------------------------------------
+#define AVX2_TARGET __attribute__((target("avx2")))
+
+// Nibble lookup: popcount of the low and high halves of the open walls
+AVX2_TARGET inline __m256i openWalls32(__m256i v) {
+    const __m256i lut = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                         0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i m0f = _mm256_set1_epi8(0x0F);
+    __m256i x = _mm256_andnot_si256(v, _mm256_set1_epi8(ALL_WALLS));
+    __m256i lo = _mm256_shuffle_epi8(lut, _mm256_and_si256(x, m0f));
+    __m256i hi = _mm256_shuffle_epi8(lut, _mm256_and_si256(_mm256_srli_epi16(x, 4), m0f));
+    return _mm256_add_epi8(lo, hi);
+}
+
+AVX2_TARGET void clearFlagsAvx2(uint8_t* cells, size_t n, uint8_t flags) {
+    const __m256i f = _mm256_set1_epi8(static_cast<char>(flags));
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i* p = reinterpret_cast<__m256i*>(cells + i);
+        _mm256_storeu_si256(p, _mm256_andnot_si256(f, _mm256_loadu_si256(p)));
+    }
+    clearFlagsSse2(cells + i, n - i, flags);
+}
+
+AVX2_TARGET size_t countOpenAvx2(const uint8_t* cells, size_t n) {
+    __m256i sum = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i d = openWalls32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(cells + i)));
+        sum = _mm256_add_epi64(sum, _mm256_sad_epu8(d, _mm256_setzero_si256()));
+    }
+    uint64_t lanes[4];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), sum);
+    return static_cast<size_t>(lanes[0] + lanes[1] + lanes[2] + lanes[3]) + countOpenSse2(cells + i, n - i);
+}
+
+AVX2_TARGET void degreesAvx2(const uint8_t* cells, size_t n, uint8_t* degrees) {
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i d = openWalls32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(cells + i)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(degrees + i), d);
+    }
+    degreesSse2(cells + i, n - i, degrees + i);
+}
+
+AVX2_TARGET size_t degreeBitmapAvx2(const uint8_t* cells, size_t n, uint32_t degree, uint64_t* bits) {
+    const __m256i want = _mm256_set1_epi8(static_cast<char>(degree));
+    size_t count = 0, w = 0;
+    for (; w + 64 <= n; w += 64) {
+        __m256i d0 = openWalls32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(cells + w)));
+        __m256i d1 = openWalls32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(cells + w + 32)));
+        uint64_t word = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(d0, want))) |
+                        static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(d1, want))))
+                            << 32;
+        bits[w / 64] = word;
+        count += static_cast<size_t>(__builtin_popcountll(word));
+    }
+    return count + degreeBitsScalar(cells, w, n, degree, bits);
+}
+
+AVX2_TARGET size_t flagBitmapAvx2(const uint8_t* cells, size_t n, uint8_t flags, uint64_t* bits) {
+    const __m256i f = _mm256_set1_epi8(static_cast<char>(flags)), zero = _mm256_setzero_si256();
+    size_t count = 0, w = 0;
+    for (; w + 64 <= n; w += 64) {
+        __m256i v0 = _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(cells + w)), f);
+        __m256i v1 = _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(cells + w + 32)), f);
+        uint64_t none = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v0, zero))) |
+                        static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v1, zero))))
+                            << 32;
+        bits[w / 64] = ~none;
+        count += static_cast<size_t>(__builtin_popcountll(~none));
+    }
+    return count + flagBitsScalar(cells, w, n, flags, bits);
+}
+
+AVX2_TARGET size_t asymmetricAvx2(const uint8_t* above, const uint8_t* row, const uint8_t* below, size_t n,
+                                  uint32_t firstCol, uint64_t& passages) {
+    const __m256i owned = _mm256_set1_epi8(WALL_DOWN | WALL_UP_RIGHT | WALL_DOWN_RIGHT);
+    const __m256i down = _mm256_set1_epi8(WALL_DOWN), upRight = _mm256_set1_epi8(WALL_UP_RIGHT);
+    const __m256i downRight = _mm256_set1_epi8(WALL_DOWN_RIGHT), one = _mm256_set1_epi8(1);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i odd = _mm256_set1_epi16(static_cast<short>((firstCol & 1) ? 0x00FF : 0xFF00));
+    __m256i open = zero;
+    size_t bad = 0, i = 0;
+    for (; i + 32 <= n; i += 32) {
+        const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + i));
+        const __m256i right = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + i + 1));
+        const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(below + i));
+        const __m256i ur = _mm256_blendv_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(above + i + 1)),
+                                              right, odd);
+        const __m256i dr = _mm256_blendv_epi8(right, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(below + i + 1)),
+                                              odd);
+        const __m256i mirrored = _mm256_or_si256(_mm256_and_si256(_mm256_slli_epi16(b, 3), down),
+                                                 _mm256_or_si256(_mm256_and_si256(_mm256_srli_epi16(ur, 3), upRight),
+                                                                 _mm256_and_si256(_mm256_srli_epi16(dr, 3), downRight)));
+        const __m256i mismatch = _mm256_and_si256(_mm256_xor_si256(a, mirrored), owned);
+        bad += static_cast<size_t>(
+            32 - __builtin_popcount(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(mismatch, zero)))));
+        const __m256i opened = _mm256_andnot_si256(a, owned);
+        const __m256i count = _mm256_add_epi8(_mm256_and_si256(_mm256_srli_epi16(opened, 1), one),
+                                              _mm256_add_epi8(_mm256_and_si256(_mm256_srli_epi16(opened, 2), one),
+                                                              _mm256_and_si256(_mm256_srli_epi16(opened, 3), one)));
+        open = _mm256_add_epi64(open, _mm256_sad_epu8(count, zero));
+    }
+    uint64_t lanes[4];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), open);
+    passages += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    return bad + asymmetricSse2(above + i, row + i, below + i, n - i, firstCol + static_cast<uint32_t>(i), passages);
+}
+
+AVX2_TARGET inline __m128i rowsCols4(__m128i cells, __m256d nCd, __m128i& cols) {
+    const __m256d celld = _mm256_cvtepi32_pd(cells);
+    const __m128i rows = _mm256_cvttpd_epi32(_mm256_div_pd(celld, nCd));
+    cols = _mm256_cvttpd_epi32(_mm256_sub_pd(celld, _mm256_mul_pd(_mm256_cvtepi32_pd(rows), nCd)));
+    return rows;
+}
+
+AVX2_TARGET uint32_t neighborIndicesAvx2(const uint32_t* cells, size_t n, uint32_t d, uint32_t nR, uint32_t nC,
+                                         uint32_t* neighbors) {
+    const __m256d nCd = _mm256_set1_pd(nC);
+    const __m256i nRv = _mm256_set1_epi32(static_cast<int32_t>(nR)), nCv = _mm256_set1_epi32(static_cast<int32_t>(nC));
+    const __m256i minus1 = _mm256_set1_epi32(-1);
+    const __m256i rowEven = _mm256_set1_epi32(NEIGHBOR_ROW_STEP_EVEN[d]);
+    const __m256i oddShift = _mm256_set1_epi32(NEIGHBOR_ROW_STEP_ODD[d] - NEIGHBOR_ROW_STEP_EVEN[d]);
+    const __m256i colStep = _mm256_set1_epi32(NEIGHBOR_COL_STEP[d]);
+    uint32_t valid = 0;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(cells + i));
+        __m128i cLo, cHi;
+        const __m128i rLo = rowsCols4(_mm256_castsi256_si128(v), nCd, cLo);
+        const __m128i rHi = rowsCols4(_mm256_extracti128_si256(v, 1), nCd, cHi);
+        const __m256i rows = _mm256_inserti128_si256(_mm256_castsi128_si256(rLo), rHi, 1);
+        const __m256i cols = _mm256_inserti128_si256(_mm256_castsi128_si256(cLo), cHi, 1);
+        const __m256i r2 = _mm256_add_epi32(rows, _mm256_add_epi32(rowEven, _mm256_and_si256(cols, oddShift)));
+        const __m256i c2 = _mm256_add_epi32(cols, colStep);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(neighbors + i),
+                            _mm256_add_epi32(_mm256_mullo_epi32(r2, nCv), c2));
+        const __m256i in = _mm256_and_si256(
+            _mm256_and_si256(_mm256_cmpgt_epi32(r2, minus1), _mm256_cmpgt_epi32(nRv, r2)),
+            _mm256_and_si256(_mm256_cmpgt_epi32(c2, minus1), _mm256_cmpgt_epi32(nCv, c2)));
+        valid |= static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(in))) << i;
+    }
+    if (i < n)
+        valid |= neighborIndicesSse2(cells + i, n - i, d, nR, nC, neighbors + i) << i;
+    return valid;
+}
+
+#endif // HEXMAZE_X86_KERNELS
+
+//-----------------------------------------------------------------------------
+// Dispatch
+//-----------------------------------------------------------------------------
+struct KernelTable {
+    void (*clearFlags)(uint8_t*, size_t, uint8_t);
+    size_t (*countOpen)(const uint8_t*, size_t);
+    void (*degrees)(const uint8_t*, size_t, uint8_t*);
+    size_t (*degreeBitmap)(const uint8_t*, size_t, uint32_t, uint64_t*);
+    size_t (*flagBitmap)(const uint8_t*, size_t, uint8_t, uint64_t*);
+    uint32_t (*neighborIndices)(const uint32_t*, size_t, uint32_t, uint32_t, uint32_t, uint32_t*);
+    size_t (*asymmetric)(const uint8_t*, const uint8_t*, const uint8_t*, size_t, uint32_t, uint64_t&);
+};
+
+const KernelTable TABLES[] = {
+    {clearFlagsScalar, countOpenScalar, degreesScalar, degreeBitmapScalar, flagBitmapScalar, neighborIndicesScalar,
+     asymmetricScalar},
+#if HEXMAZE_X86_KERNELS
+    {clearFlagsSse2, countOpenSse2, degreesSse2, degreeBitmapSse2, flagBitmapSse2, neighborIndicesSse2, asymmetricSse2},
+    {clearFlagsAvx2, countOpenAvx2, degreesAvx2, degreeBitmapAvx2, flagBitmapAvx2, neighborIndicesAvx2, asymmetricAvx2},
+#endif
+};
+
+KernelLevel detectLevel() {
+#if HEXMAZE_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return KERNEL_AVX2;
+    return KERNEL_SSE2; // Part of every x86-64 CPU
+#else
+    return KERNEL_SCALAR;
+#endif
+}
+
+KernelLevel& activeLevel() {
+    static KernelLevel level = detectLevel();
+    return level;
+}
+
+inline const KernelTable& table() {
+    return TABLES[activeLevel()];
+}
+
+} // namespace
+
+KernelLevel kernelLevel() {
+    return activeLevel();
+}
+
+KernelLevel bestKernelLevel() {
+    static KernelLevel best = detectLevel();
+    return best;
+}
+
+void setKernelLevel(KernelLevel level) {
+    activeLevel() = level < bestKernelLevel() ? level : bestKernelLevel();
+}
+
+const char* kernelLevelName(KernelLevel level) {
+    switch (level) {
+    case KERNEL_SCALAR: return "scalar";
+    case KERNEL_SSE2: return "sse2";
+    case KERNEL_AVX2: return "avx2";
+    }
+    return "unknown";
+}
+
+// libc's memset already picks the widest stores the CPU has and beat
+// hand-written SSE2/AVX2 loops at every size, so fill does not dispatch
+void fillCells(uint8_t* cells, size_t n, uint8_t value) {
+    memset(cells, value, n);
+}
+
+void clearCellFlags(uint8_t* cells, size_t n, uint8_t flags) {
+    table().clearFlags(cells, n, flags);
+}
+
+size_t countOpenWalls(const uint8_t* cells, size_t n) {
+    return table().countOpen(cells, n);
+}
+
+void openWallCounts(const uint8_t* cells, size_t n, uint8_t* degrees) {
+    table().degrees(cells, n, degrees);
+}
+
+size_t degreeBitmap(const uint8_t* cells, size_t n, uint32_t degree, uint64_t* bits) {
+    return table().degreeBitmap(cells, n, degree, bits);
+}
+
+size_t flagBitmap(const uint8_t* cells, size_t n, uint8_t flags, uint64_t* bits) {
+    return table().flagBitmap(cells, n, flags, bits);
+}
+
+uint32_t neighborIndices(const uint32_t* cells, size_t n, uint8_t direction, uint32_t nR, uint32_t nC,
+                         uint32_t* neighbors) {
+    if (direction == 0 || (direction & (direction - 1)) != 0 || direction > WALL_UP_LEFT)
+        return 0;
+    if (n > NEIGHBOR_BATCH_MAX)
+        n = NEIGHBOR_BATCH_MAX;
+    return table().neighborIndices(cells, n, static_cast<uint32_t>(__builtin_ctz(direction)), nR, nC, neighbors);
+}
+
+size_t asymmetricWalls(const uint8_t* above, const uint8_t* row, const uint8_t* below, size_t n,
+                       uint32_t firstCol, uint64_t& passages) {
+    return table().asymmetric(above, row, below, n, firstCol, passages);
+}
+
+//-----------------------------------------------------------------------------
+// Fixed-Stride Helpers
+//-----------------------------------------------------------------------------
+void fillRows(uint8_t maze[][MAX_COLS], uint32_t nR, uint32_t nC, uint8_t value) {
+    if (nC == MAX_COLS) {
+        fillCells(maze[0], static_cast<size_t>(nR) * MAX_COLS, value);
+        return;
+    }
+    for (uint32_t r = 0; r < nR; ++r)
+        fillCells(maze[r], nC, value);
+}
+
+void clearRowFlags(uint8_t maze[][MAX_COLS], uint32_t nR, uint32_t nC, uint8_t flags) {
+    if (nC == MAX_COLS) {
+        clearCellFlags(maze[0], static_cast<size_t>(nR) * MAX_COLS, flags);
+        return;
+    }
+    for (uint32_t r = 0; r < nR; ++r)
+        clearCellFlags(maze[r], nC, flags);
+}
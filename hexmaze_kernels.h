@@ -0,0 +1,165 @@
+//
+// Bulk kernels over runs of cell bytes (CellValues bitmasks).
+//
+// Each kernel has a scalar, an SSE2 and an AVX2 implementation. The best
+// one the CPU supports is picked on first use (AVX2 via
+// __builtin_cpu_supports, so the library still runs on CPUs without it);
+// setKernelLevel() forces a lower level for benchmarks and comparisons.
+// All levels give identical results.
+//
+// Kernels work on contiguous runs; for the fixed-stride cell array use the
+// *Rows helpers, which cover whole blocks at once when nC == MAX_COLS.
+//
+
+#ifndef HEXMAZE_KERNELS_H
+#define HEXMAZE_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "hexpathfinder.h"
+
+enum KernelLevel {
+    KERNEL_SCALAR = 0,
+    KERNEL_SSE2 = 1,
+    KERNEL_AVX2 = 2
+};
+
+KernelLevel kernelLevel();
+KernelLevel bestKernelLevel(); // Highest level this CPU supports
+// Clamped to bestKernelLevel(); not thread-safe against running kernels
+void setKernelLevel(KernelLevel level);
+const char* kernelLevelName(KernelLevel level);
+
+// cells[i] = value (memset at every level)
+void fillCells(uint8_t* cells, size_t n, uint8_t value);
+
+// cells[i] &= ~flags
+void clearCellFlags(uint8_t* cells, size_t n, uint8_t flags);
+
+// Total number of open walls (clear bits of ALL_WALLS) over the run
+size_t countOpenWalls(const uint8_t* cells, size_t n);
+
+// degrees[i] = open walls of cells[i]
+void openWallCounts(const uint8_t* cells, size_t n, uint8_t* degrees);
+
+// Sets bit i of bits (which must hold (n + 63) / 64 words) if cells[i] has
+// exactly `degree` open walls; degree 1 gives the dead-end bitmap.
+// Returns the number of bits set.
+size_t degreeBitmap(const uint8_t* cells, size_t n, uint32_t degree, uint64_t* bits);
+
+// As degreeBitmap, for cells with any of flags set
+size_t flagBitmap(const uint8_t* cells, size_t n, uint8_t flags, uint64_t* bits);
+
+// Wall agreement over a run of cells away from the border: row[0..n) starts
+// at column firstCol of an interior row, above and below point at the same
+// column of the rows around it, and every cell has all six neighbors, so
+// row, above and below must be readable up to index n. Returns the number of
+// cells whose DOWN, UP_RIGHT or DOWN_RIGHT wall disagrees with the opposite
+// wall of the neighbor behind it, and adds the open ones among those three
+// walls (each passage is owned by exactly one cell) to passages.
+size_t asymmetricWalls(const uint8_t* above, const uint8_t* row, const uint8_t* below, size_t n,
+                       uint32_t firstCol, uint64_t& passages);
+
+// Neighbor kernels, on row-major cell indices (r * nC + c)
+
+const size_t NEIGHBOR_BATCH_MAX = 32;
+
+// neighbors[i] = index of the cell across wall `direction` (one CellValues
+// wall bit) from cells[i], for n <= NEIGHBOR_BATCH_MAX cells. Returns a mask
+// with bit i set if that neighbor lies inside the grid; neighbors[i] is
+// unspecified where the bit is clear. Assumes nR and nC below 2^22 and
+// cell indices below 2^31.
+uint32_t neighborIndices(const uint32_t* cells, size_t n, uint8_t direction, uint32_t nR, uint32_t nC,
+                         uint32_t* neighbors);
+
+// Neighbor steps per wall bit index d: row step in even and in odd columns
+// (odd columns sit half a cell lower), and column step. Padded to 8 lanes.
+const int32_t NEIGHBOR_ROW_STEP_EVEN[8] = {-1, -1, 0, 1, 0, -1, 0, 0};
+const int32_t NEIGHBOR_ROW_STEP_ODD[8] = {-1, 0, 1, 1, 1, 0, 0, 0};
+const int32_t NEIGHBOR_COL_STEP[8] = {0, 1, 1, 0, -1, -1, 0, 0};
+
+#if defined(__SSE2__)
+// Row offset dr * nC for dr in {-1, 0, 1}, without a 32-bit multiply
+inline __m128i neighborRowOffset4(__m128i dr, __m128i nCv) {
+    const __m128i zero = _mm_setzero_si128();
+    return _mm_sub_epi32(_mm_and_si128(_mm_cmpgt_epi32(dr, zero), nCv), _mm_and_si128(_mm_cmpgt_epi32(zero, dr), nCv));
+}
+
+inline __m128i neighborInGrid4(__m128i r2, __m128i c2, __m128i nRv, __m128i nCv) {
+    const __m128i minus1 = _mm_set1_epi32(-1);
+    return _mm_and_si128(_mm_and_si128(_mm_cmpgt_epi32(r2, minus1), _mm_cmplt_epi32(r2, nRv)),
+                         _mm_and_si128(_mm_cmpgt_epi32(c2, minus1), _mm_cmplt_epi32(c2, nCv)));
+}
+#endif
+
+// All six neighbors of one cell, for 64-bit cell indices (HEXMAZE_INDEX64
+// mazes) and dimensions of 2^31 or more; scalar. See the 32-bit overload.
+inline uint8_t cellNeighbors(uint64_t cell, uint32_t nR, uint32_t nC, uint64_t neighbors[6]) {
+    const uint64_t r = cell / nC, c = cell - r * nC;
+    const int32_t* rowStep = (c & 1) ? NEIGHBOR_ROW_STEP_ODD : NEIGHBOR_ROW_STEP_EVEN;
+    uint8_t valid = 0;
+    for (uint32_t d = 0; d < 6; ++d) {
+        const int64_t r2 = static_cast<int64_t>(r) + rowStep[d];
+        const int64_t c2 = static_cast<int64_t>(c) + NEIGHBOR_COL_STEP[d];
+        neighbors[d] = static_cast<uint64_t>(r2) * nC + static_cast<uint64_t>(c2);
+        if (r2 >= 0 && r2 < nR && c2 >= 0 && c2 < nC)
+            valid = static_cast<uint8_t>(valid | 1u << d);
+    }
+    return valid;
+}
+
+// All six neighbors of one cell: neighbors[d] is the cell across wall
+// 1 << d. Returns the walls (CellValues bits) that have a cell behind
+// them, so `mask & ~cell` is the set of open passages. Inline and not
+// dispatched, since solvers call it once per cell and SSE2 is baseline.
+inline uint8_t cellNeighbors(uint32_t cell, uint32_t nR, uint32_t nC, uint32_t neighbors[6]) {
+    if ((nR | nC) >= 0x80000000u) { // Too wide for the signed 32-bit lanes
+        uint64_t wide[6];
+        const uint8_t valid = cellNeighbors(static_cast<uint64_t>(cell), nR, nC, wide);
+        for (uint32_t d = 0; d < 6; ++d)
+            neighbors[d] = static_cast<uint32_t>(wide[d]);
+        return valid;
+    }
+    const uint32_t r = cell / nC, c = cell - r * nC;
+    const int32_t* rowStep = (c & 1) ? NEIGHBOR_ROW_STEP_ODD : NEIGHBOR_ROW_STEP_EVEN;
+#if defined(__SSE2__)
+    // Lanes 0-3 hold walls 0-3, lanes 4-5 walls 4-5; lanes 6-7 are masked off
+    const __m128i rv = _mm_set1_epi32(static_cast<int32_t>(r)), cv = _mm_set1_epi32(static_cast<int32_t>(c));
+    const __m128i nRv = _mm_set1_epi32(static_cast<int32_t>(nR)), nCv = _mm_set1_epi32(static_cast<int32_t>(nC));
+    const __m128i base = _mm_set1_epi32(static_cast<int32_t>(cell));
+    const __m128i dr0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rowStep));
+    const __m128i dr1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rowStep + 4));
+    const __m128i dc0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(NEIGHBOR_COL_STEP));
+    const __m128i dc1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(NEIGHBOR_COL_STEP + 4));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(neighbors),
+                     _mm_add_epi32(base, _mm_add_epi32(neighborRowOffset4(dr0, nCv), dc0)));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(neighbors + 4),
+                     _mm_add_epi32(base, _mm_add_epi32(neighborRowOffset4(dr1, nCv), dc1)));
+    const int lo = _mm_movemask_ps(_mm_castsi128_ps(
+        neighborInGrid4(_mm_add_epi32(rv, dr0), _mm_add_epi32(cv, dc0), nRv, nCv)));
+    const int hi = _mm_movemask_ps(_mm_castsi128_ps(
+        neighborInGrid4(_mm_add_epi32(rv, dr1), _mm_add_epi32(cv, dc1), nRv, nCv)));
+    return static_cast<uint8_t>((lo | hi << 4) & ALL_WALLS);
+#else
+    uint8_t valid = 0;
+    for (uint32_t d = 0; d < 6; ++d) {
+        const int32_t r2 = static_cast<int32_t>(r) + rowStep[d];
+        const int32_t c2 = static_cast<int32_t>(c) + NEIGHBOR_COL_STEP[d];
+        neighbors[d] = static_cast<uint32_t>(r2) * nC + static_cast<uint32_t>(c2);
+        if (r2 >= 0 && r2 < static_cast<int32_t>(nR) && c2 >= 0 && c2 < static_cast<int32_t>(nC))
+            valid = static_cast<uint8_t>(valid | 1u << d);
+    }
+    return valid;
+#endif
+}
+
+// Fixed-stride array helpers
+void fillRows(uint8_t maze[][MAX_COLS], uint32_t nR, uint32_t nC, uint8_t value);
+void clearRowFlags(uint8_t maze[][MAX_COLS], uint32_t nR, uint32_t nC, uint8_t flags);
+
+#endif // HEXMAZE_KERNELS_H
@@ -0,0 +1,286 @@
+//
+// Load generator for `pathfinder --serve`.
+// Opens one connection per client thread, keeps up to --pipeline requests
+// outstanding on each, and reports throughput and latency percentiles.
+//
+// Usage: loadgen <socket_path> [--clients N] [--requests N] [--pipeline N]
+//                [--op generate|solve|path|render] [--rows N] [--cols N] [--seed N]
+//                [--random] [--print-stats]
+//
+// --random sends unseeded (PROTO_FLAG_RANDOM) requests; --print-stats dumps
+// the server's OP_STATS metrics after the run.
+//
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <stdexcept>
+#include <cerrno>
+#include <cstring>
+#include <cstdlib>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "hexmaze_protocol.h"
+
+using namespace std;
+typedef chrono::steady_clock Clock;
+
+struct LoadOptions {
+    string socketPath;
+    unsigned clients = 4;
+    unsigned requests = 1000; // Per client
+    unsigned pipeline = 1;
+    uint8_t op = OP_RENDER;
+    uint16_t rows = 40;
+    uint16_t cols = 40;
+    uint32_t seed = 1;        // Request i of client k uses seed + k * requests + i
+    bool random = false;
+    bool printStats = false;
+};
+
+struct ClientResult {
+    vector<double> latenciesUs; // Successful requests only
+    uint64_t busy = 0;
+    uint64_t errors = 0;
+    uint64_t bytes = 0;
+    string failure;             // Set if the connection itself failed
+};
+
+static bool writeFull(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = send(fd, data, size, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+static bool readFull(int fd, char* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = recv(fd, data, size, 0);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+static int connectTo(const string& path) {
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path))
+        return -1;
+    memcpy(addr.sun_path, path.c_str(), path.size());
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return -1;
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static void runClient(const LoadOptions& opts, unsigned clientIndex, ClientResult& result) {
+    int fd = connectTo(opts.socketPath);
+    if (fd < 0) {
+        result.failure = string("connect: ") + strerror(errno);
+        return;
+    }
+
+    vector<Clock::time_point> sentAt(opts.requests);
+    vector<char> payload;
+    result.latenciesUs.reserve(opts.requests);
+
+    unsigned sent = 0, received = 0;
+    while (received < opts.requests) {
+        // Top up the pipeline
+        while (sent < opts.requests && sent - received < opts.pipeline) {
+            RequestHeader req;
+            req.magic = PROTO_REQUEST_MAGIC;
+            req.requestId = sent;
+            req.op = opts.op;
+            req.flags = opts.random ? PROTO_FLAG_RANDOM : 0;
+            req.reserved = 0;
+            req.rows = opts.rows;
+            req.cols = opts.cols;
+            req.seed = opts.seed + clientIndex * opts.requests + sent;
+            sentAt[sent] = Clock::now();
+            if (!writeFull(fd, reinterpret_cast<const char*>(&req), sizeof(req))) {
+                result.failure = "send failed";
+                close(fd);
+                return;
+            }
+            ++sent;
+        }
+
+        char headerBytes[sizeof(ResponseHeader)];
+        if (!readFull(fd, headerBytes, sizeof(headerBytes))) {
+            result.failure = "connection closed by server";
+            close(fd);
+            return;
+        }
+        ResponseHeader resp = decodeResponse(headerBytes);
+        payload.resize(resp.payloadSize);
+        if (resp.magic != PROTO_RESPONSE_MAGIC || resp.requestId >= opts.requests ||
+            !readFull(fd, payload.data(), payload.size())) {
+            result.failure = "malformed response";
+            close(fd);
+            return;
+        }
+        ++received;
+
+        if (resp.status == STATUS_OK) {
+            double us = chrono::duration<double, micro>(Clock::now() - sentAt[resp.requestId]).count();
+            result.latenciesUs.push_back(us);
+            result.bytes += resp.payloadSize;
+        } else if (resp.status == STATUS_BUSY) {
+            ++result.busy;
+        } else {
+            ++result.errors;
+        }
+    }
+    close(fd);
+}
+
+// Sends one OP_STATS request and prints the reply
+static bool printServerStats(const string& socketPath) {
+    int fd = connectTo(socketPath);
+    if (fd < 0) {
+        cerr << "Stats: connect failed: " << strerror(errno) << endl;
+        return false;
+    }
+    RequestHeader req;
+    memset(&req, 0, sizeof(req));
+    req.magic = PROTO_REQUEST_MAGIC;
+    req.op = OP_STATS;
+
+    char headerBytes[sizeof(ResponseHeader)];
+    bool ok = writeFull(fd, reinterpret_cast<const char*>(&req), sizeof(req)) &&
+              readFull(fd, headerBytes, sizeof(headerBytes));
+    ResponseHeader resp = decodeResponse(headerBytes);
+    string text(ok ? resp.payloadSize : 0, '\0');
+    ok = ok && resp.status == STATUS_OK && readFull(fd, &text[0], text.size());
+    close(fd);
+    if (!ok) {
+        cerr << "Stats: request failed" << endl;
+        return false;
+    }
+    cout << "server stats:" << endl << text;
+    return true;
+}
+
+static double percentile(const vector<double>& sorted, double p) {
+    if (sorted.empty())
+        return 0.0;
+    size_t idx = static_cast<size_t>(p / 100.0 * (sorted.size() - 1) + 0.5);
+    return sorted[min(idx, sorted.size() - 1)];
+}
+
+static uint8_t parseOp(const string& name) {
+    if (name == "generate") return OP_GENERATE;
+    if (name == "solve") return OP_SOLVE;
+    if (name == "path") return OP_PATH;
+    if (name == "render") return OP_RENDER;
+    throw invalid_argument("unknown op " + name);
+}
+
+static void printUsage(const char* prog) {
+    cerr << "Usage: " << prog << " <socket_path> [--clients N] [--requests N] [--pipeline N]" << endl
+         << "       [--op generate|solve|path|render] [--rows N] [--cols N] [--seed N]" << endl
+         << "       [--random] [--print-stats]" << endl;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    LoadOptions opts;
+    opts.socketPath = argv[1];
+    try {
+        for (int i = 2; i < argc; ++i) {
+            string opt = argv[i];
+            if (opt == "--random") {
+                opts.random = true;
+                continue;
+            }
+            if (opt == "--print-stats") {
+                opts.printStats = true;
+                continue;
+            }
+            if (i + 1 >= argc)
+                throw invalid_argument("missing value for " + opt);
+            string value = argv[++i];
+            if (opt == "--op") {
+                opts.op = parseOp(value);
+                continue;
+            }
+            unsigned long n = stoul(value);
+            if (opt == "--clients" && n > 0) opts.clients = static_cast<unsigned>(n);
+            else if (opt == "--requests" && n > 0) opts.requests = static_cast<unsigned>(n);
+            else if (opt == "--pipeline" && n > 0) opts.pipeline = static_cast<unsigned>(n);
+            else if (opt == "--rows" && n > 0 && n <= 0xFFFF) opts.rows = static_cast<uint16_t>(n);
+            else if (opt == "--cols" && n > 0 && n <= 0xFFFF) opts.cols = static_cast<uint16_t>(n);
+            else if (opt == "--seed") opts.seed = static_cast<uint32_t>(n);
+            else throw invalid_argument("bad option " + opt + " " + value);
+        }
+    } catch (const exception& e) {
+        cerr << "Error: " << e.what() << endl;
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    vector<ClientResult> results(opts.clients);
+    vector<thread> threads;
+    Clock::time_point start = Clock::now();
+    for (unsigned k = 0; k < opts.clients; ++k)
+        threads.emplace_back(runClient, cref(opts), k, ref(results[k]));
+    for (auto& t : threads)
+        t.join();
+    double elapsed = chrono::duration<double>(Clock::now() - start).count();
+
+    vector<double> all;
+    uint64_t busy = 0, errors = 0, bytes = 0;
+    int failedClients = 0;
+    for (const auto& r : results) {
+        all.insert(all.end(), r.latenciesUs.begin(), r.latenciesUs.end());
+        busy += r.busy;
+        errors += r.errors;
+        bytes += r.bytes;
+        if (!r.failure.empty()) {
+            cerr << "Client failed: " << r.failure << endl;
+            ++failedClients;
+        }
+    }
+    sort(all.begin(), all.end());
+
+    cout << fixed << setprecision(1);
+    cout << "requests: " << static_cast<uint64_t>(opts.clients) * opts.requests
+         << "  ok: " << all.size() << "  busy: " << busy << "  errors: " << errors << endl;
+    cout << "elapsed: " << elapsed << " s  throughput: " << all.size() / elapsed << " req/s  "
+         << bytes / elapsed / (1 << 20) << " MiB/s" << endl;
+    cout << "latency (us): p50 " << percentile(all, 50) << "  p90 " << percentile(all, 90)
+         << "  p99 " << percentile(all, 99) << "  max " << (all.empty() ? 0.0 : all.back()) << endl;
+
+    if (opts.printStats && !printServerStats(opts.socketPath))
+        ++failedClients;
+    return failedClients ? 1 : 0;
+}
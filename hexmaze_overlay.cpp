@@ -0,0 +1,126 @@
+//
+// Per-session overlay on a shared base maze (see hexmaze_overlay.h).
+//
+
+#include "hexmaze_overlay.h"
+
+using namespace std;
+
+SessionOverlay::SessionOverlay(const PersistentMaze& base) : base(base), filter(0), slotShift(64), used(0) {}
+
+size_t SessionOverlay::slotOf(uint64_t cell, uint64_t h) const {
+    size_t mask = keys.size() - 1;
+    size_t slot = home(h);
+    while (keys[slot] != cell && keys[slot] != EMPTY)
+        slot = (slot + 1) & mask; // Linear probing; the table is never full
+    return slot;
+}
+
+uint8_t SessionOverlay::lookup(uint64_t cell, uint64_t h, uint32_t r, uint32_t c) const {
+    size_t slot = slotOf(cell, h);
+    return keys[slot] == cell ? values[slot] : base.get(r, c);
+}
+
+void SessionOverlay::set(uint32_t r, uint32_t c, uint8_t value) {
+    uint64_t cell = static_cast<uint64_t>(r) * base.cols() + c;
+    uint64_t h = hashCell(cell);
+    bool revert = base.get(r, c) == value;
+
+    if (keys.empty()) {
+        if (revert)
+            return;
+        keys.assign(8, EMPTY);
+        values.assign(8, 0);
+        slotShift = 61;
+    }
+
+    size_t slot = slotOf(cell, h);
+    if (keys[slot] == cell) {
+        if (revert)
+            erase(slot);
+        else
+            values[slot] = value;
+        return;
+    }
+    if (revert)
+        return;
+
+    // Keep the load factor at or below 1/2 so probes stay short
+    if ((used + 1) * 2 > keys.size()) {
+        grow();
+        slot = slotOf(cell, h);
+    }
+    keys[slot] = cell;
+    values[slot] = value;
+    ++used;
+    filter |= filterBit(h);
+}
+
+bool SessionOverlay::setWall(uint32_t r, uint32_t c, uint8_t direction, bool open) {
+    uint32_t r2, c2;
+    if (!getNeighbor(r, c, direction, rows(), cols(), r2, c2))
+        return false;
+    uint8_t opposite = getOppositeWall(direction);
+    if (open) {
+        set(r, c, get(r, c) & ~direction);
+        set(r2, c2, get(r2, c2) & ~opposite);
+    } else {
+        set(r, c, get(r, c) | direction);
+        set(r2, c2, get(r2, c2) | opposite);
+    }
+    return true;
+}
+
+void SessionOverlay::reset() {
+    vector<uint64_t>().swap(keys);
+    vector<uint8_t>().swap(values);
+    used = 0;
+    filter = 0;
+    slotShift = 64;
+}
+
+size_t SessionOverlay::memoryBytes() const {
+    return keys.capacity() * sizeof(uint64_t) + values.capacity();
+}
+
+void SessionOverlay::grow() {
+    vector<uint64_t> oldKeys(keys.size() * 2, EMPTY);
+    vector<uint8_t> oldValues(values.size() * 2, 0);
+    oldKeys.swap(keys);
+    oldValues.swap(values);
+    --slotShift;
+    for (size_t i = 0; i < oldKeys.size(); ++i) {
+        if (oldKeys[i] == EMPTY)
+            continue;
+        size_t slot = slotOf(oldKeys[i], hashCell(oldKeys[i]));
+        keys[slot] = oldKeys[i];
+        values[slot] = oldValues[i];
+    }
+    rebuildFilter();
+}
+
+// Backward-shift deletion: pull later entries of the probe run into the
+// hole so lookups never need tombstones. The filter keeps the cell's bit.
+void SessionOverlay::erase(size_t slot) {
+    size_t mask = keys.size() - 1;
+    size_t hole = slot;
+    for (size_t next = (hole + 1) & mask; keys[next] != EMPTY; next = (next + 1) & mask) {
+        size_t start = home(hashCell(keys[next]));
+        // Move the entry unless its home lies cyclically in (hole, next]
+        bool stays = hole <= next ? (start > hole && start <= next) : (start > hole || start <= next);
+        if (!stays) {
+            keys[hole] = keys[next];
+            values[hole] = values[next];
+            hole = next;
+        }
+    }
+    keys[hole] = EMPTY;
+    --used;
+}
+
+void SessionOverlay::rebuildFilter() {
+    filter = 0;
+    for (uint64_t cell : keys)
+        if (cell != EMPTY)
+            filter |= filterBit(hashCell(cell));
+}
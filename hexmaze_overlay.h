@@ -0,0 +1,90 @@
+//
+// Per-session overlay on a shared, read-only base maze.
+//
+// Many sessions can play the same base maze while each opens or closes a
+// few walls of its own. The overlay keeps only the cells a session changed,
+// in a small open-addressing hash table; every other read goes straight to
+// the base. A 64-bit filter of the changed cells' hashes lets most reads of
+// unchanged cells skip the table entirely, and a session with no edits
+// costs nothing beyond the base lookup.
+//
+// The base is held as a PersistentMaze snapshot, so any number of overlays
+// share it by reference count; it is never written through the overlay.
+// Memory per session is proportional to its edits.
+//
+// Implements the maze accessor interface (see hexpathfinder.h), so
+// solveMazeBFS() and renderMaze() read through it. Solving marks the path
+// with VISITED, which lands in the overlay like any other edit; keep the
+// shared base unsolved so a session pays only for its own path.
+// An overlay is not thread-safe; the shared base may be read from any
+// number of threads.
+//
+
+#ifndef HEXMAZE_OVERLAY_H
+#define HEXMAZE_OVERLAY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "hexpathfinder.h"
+#include "hexmaze_persistent.h"
+
+class SessionOverlay {
+public:
+    explicit SessionOverlay(const PersistentMaze& base);
+
+    uint32_t rows() const { return base.rows(); }
+    uint32_t cols() const { return base.cols(); }
+
+    uint8_t get(uint32_t r, uint32_t c) const {
+        uint64_t cell = static_cast<uint64_t>(r) * base.cols() + c;
+        uint64_t h = hashCell(cell);
+        if (!(filter & filterBit(h)))
+            return base.get(r, c);
+        return lookup(cell, h, r, c);
+    }
+
+    // Writing the base value back removes the cell from the overlay
+    void set(uint32_t r, uint32_t c, uint8_t cell);
+
+    // Opens or closes one wall on both sides (via getNeighbor and
+    // getOppositeWall). Returns false for a border wall.
+    bool setWall(uint32_t r, uint32_t c, uint8_t direction, bool open);
+
+    // Drops every edit, returning to the base maze
+    void reset();
+
+    size_t editCount() const { return used; }
+    size_t memoryBytes() const; // Heap bytes owned by this overlay
+    const PersistentMaze& baseMaze() const { return base; }
+
+private:
+    // No cell has this index: rows and columns are 32-bit, so the last cell
+    // of the largest maze is (2^32 - 1)^2 - 1
+    static const uint64_t EMPTY = ~0ull;
+
+    // Multiplicative hash: only its high bits depend on every bit of the
+    // cell, so slots come from the top bits (home()) and the filter from
+    // bits 32-37, clear of them for any table under 2^26 slots
+    static uint64_t hashCell(uint64_t cell) { return cell * 0x9E3779B97F4A7C15ull; }
+    static uint64_t filterBit(uint64_t h) { return 1ull << ((h >> 32) & 63); }
+    size_t home(uint64_t h) const { return static_cast<size_t>(h >> slotShift); }
+
+    uint8_t lookup(uint64_t cell, uint64_t h, uint32_t r, uint32_t c) const;
+    size_t slotOf(uint64_t cell, uint64_t h) const; // Slot holding cell, or the empty slot it would go in
+    void grow();
+    void erase(size_t slot);
+    void rebuildFilter();
+
+    PersistentMaze base;
+    // filterBit() set for every cell in the table. Erasing leaves its bit
+    // set (a stale bit only costs a probe); grow() and reset() clear them.
+    uint64_t filter;
+    std::vector<uint64_t> keys; // Cell indices (r * cols + c); EMPTY if free
+    unsigned slotShift;         // 64 - log2(keys.size())
+    std::vector<uint8_t> values;
+    size_t used;
+};
+
+#endif // HEXMAZE_OVERLAY_H
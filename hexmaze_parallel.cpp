@@ -0,0 +1,185 @@
+//
+// Parallel generation and solving of MazeGrids (see hexmaze_parallel.h).
+// Rendering lives with the rest of the drawing code in hexpathfinder_draw.cpp.
+//
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <random>
+
+#include "hexmaze_parallel.h"
+#include "hexmaze_kernels.h"
+#include "hexmaze_probes.h"
+
+using namespace std;
+
+namespace {
+
+const size_t CELL_GRAIN = 1 << 20;        // Cells per task when resetting solver state
+const size_t FRONTIER_PARALLEL_MIN = 4096; // Smaller BFS levels are expanded inline
+const size_t FRONTIER_GRAIN = 2048;       // Frontier cells per task
+
+// Generator workspaces are handed out per band rather than per worker: a
+// thread waiting on its own tasks may help out with a band of another call
+class WorkspaceStock {
+public:
+    unique_ptr<BasicGeneratorWorkspace<CellIndex>> take() {
+        lock_guard<mutex> lock(m);
+        if (spare.empty())
+            return unique_ptr<BasicGeneratorWorkspace<CellIndex>>(new BasicGeneratorWorkspace<CellIndex>);
+        unique_ptr<BasicGeneratorWorkspace<CellIndex>> ws = move(spare.back());
+        spare.pop_back();
+        return ws;
+    }
+
+    void give(unique_ptr<BasicGeneratorWorkspace<CellIndex>> ws) {
+        lock_guard<mutex> lock(m);
+        spare.push_back(move(ws));
+    }
+
+private:
+    mutex m;
+    vector<unique_ptr<BasicGeneratorWorkspace<CellIndex>>> spare;
+};
+
+// Claims every unvisited open neighbor of cell for the next BFS level and
+// appends it to out. The claim is a CAS, so concurrent expansions of one
+// level never both take a cell.
+template <class Index>
+inline void expandCell(const MazeGrid& maze, Index cell, vector<Index>& count, vector<Index>& out) {
+    const Index UNVISITED = numeric_limits<Index>::max();
+    const Index next = count[cell] + 1;
+    HEXMAZE_COUNT(STAT_CELLS_VISITED, 1);
+    Index neighbors[6];
+    uint8_t open = cellNeighbors(cell, maze.nR, maze.nC, neighbors) & ~maze.cells[cell];
+    for (; open != 0; open &= open - 1) {
+        Index neighbor = neighbors[__builtin_ctz(open)];
+        Index expected = UNVISITED;
+        if (__atomic_compare_exchange_n(&count[neighbor], &expected, next, false,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            out.push_back(neighbor);
+            HEXMAZE_COUNT(STAT_BFS_PUSHES, 1);
+        }
+    }
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+// Band Generation
+//-----------------------------------------------------------------------------
+uint32_t bandRowsFor(uint32_t nR) {
+    return max<uint32_t>(256, (nR + 63) / 64);
+}
+
+// Band 0 is seeded with seed itself, so a maze of a single band is exactly
+// what generateMaze() makes from mt19937(seed)
+bool generateMazeBands(MazeGrid& maze, uint32_t seed, TaskScheduler& scheduler, uint32_t bandRows) {
+    const uint32_t nR = maze.nR;
+    const uint32_t nC = maze.nC;
+    if (bandRows == 0)
+        bandRows = bandRowsFor(nR);
+    const uint32_t bands = (nR + bandRows - 1) / bandRows;
+    if (!fitsCellIndex<CellIndex>(min(bandRows, nR), nC))
+        return false;
+
+    WorkspaceStock stock;
+    parallelFor(scheduler, 0, bands, 1, [&](size_t lo, size_t hi) {
+        unique_ptr<BasicGeneratorWorkspace<CellIndex>> ws = stock.take();
+        for (size_t b = lo; b < hi; ++b) {
+            uint32_t r0 = static_cast<uint32_t>(b) * bandRows;
+            MazeSpan band(maze.row(r0), min(bandRows, nR - r0), nC);
+            seed_seq bandSeed = {seed, static_cast<uint32_t>(b)};
+            mt19937 rng(seed);
+            if (b > 0)
+                rng.seed(bandSeed);
+            generateMaze(band, rng, *ws);
+        }
+        stock.give(move(ws));
+    });
+
+    // Each band is one tree; a single opening to the band above joins them
+    seed_seq joinSeed = {seed, bands};
+    mt19937 rng(joinSeed);
+    uniform_int_distribution<uint32_t> column(0, nC - 1);
+    for (uint32_t b = 1; b < bands; ++b) {
+        uint32_t r = b * bandRows;
+        uint32_t c = column(rng);
+        maze.set(r - 1, c, maze.get(r - 1, c) & ~WALL_DOWN);
+        maze.set(r, c, maze.get(r, c) & ~WALL_UP);
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// Level-Synchronous BFS
+// ws.queue ends up holding the cells level by level, as in solveMazeBFS,
+// though not in the same order within a level.
+//-----------------------------------------------------------------------------
+template <class Index>
+bool solveMazeParallel(MazeGrid& maze, BasicSolverWorkspace<Index>& ws, TaskScheduler& scheduler) {
+    const uint32_t nR = maze.nR;
+    const uint32_t nC = maze.nC;
+    const Index UNVISITED = numeric_limits<Index>::max();
+    if (!fitsCellIndex<Index>(nR, nC))
+        return false;
+    HEXMAZE_PROBE2(solve_start, nR, nC);
+
+    const size_t cells = maze.cells.size();
+    vector<Index>& count = ws.count;
+    vector<Index>& q = ws.queue;
+    count.resize(cells);
+    q.clear();
+    q.reserve(cells); // Inline levels append to q while reading it
+    ws.path.clear();
+    parallelFor(scheduler, 0, cells, CELL_GRAIN, [&](size_t lo, size_t hi) {
+        fill(count.begin() + lo, count.begin() + hi, UNVISITED);
+        clearCellFlags(maze.cells.data() + lo, hi - lo, VISITED);
+    });
+
+    Index endCellIdx = static_cast<Index>(cells - 1);
+    count[endCellIdx] = 0;
+    q.push_back(endCellIdx);
+    HEXMAZE_COUNT(STAT_BFS_PUSHES, 1);
+
+    // Chunk k of a wide level collects what it found in found[k]; appending
+    // the chunks in order keeps the queue independent of the thread count
+    vector<vector<Index>> found;
+    for (size_t levelBegin = 0, level = 0; levelBegin < q.size(); ++level) {
+        const size_t levelEnd = q.size();
+        const size_t width = levelEnd - levelBegin;
+        if (width < FRONTIER_PARALLEL_MIN) {
+            for (size_t i = levelBegin; i < levelEnd; ++i)
+                expandCell(maze, q[i], count, q);
+        } else {
+            const size_t chunks = (width + FRONTIER_GRAIN - 1) / FRONTIER_GRAIN;
+            if (found.size() < chunks)
+                found.resize(chunks);
+            parallelFor(scheduler, 0, chunks, 1, [&](size_t lo, size_t hi) {
+                for (size_t k = lo; k < hi; ++k) {
+                    found[k].clear();
+                    size_t first = levelBegin + k * FRONTIER_GRAIN;
+                    size_t last = min(levelEnd, first + FRONTIER_GRAIN);
+                    for (size_t i = first; i < last; ++i)
+                        expandCell(maze, q[i], count, found[k]);
+                }
+            });
+            for (size_t k = 0; k < chunks; ++k)
+                q.insert(q.end(), found[k].begin(), found[k].end());
+        }
+        HEXMAZE_PROBE2(bfs_level, level, width);
+        levelBegin = levelEnd;
+    }
+
+    bool solved = traceSolution(maze, ws);
+    HEXMAZE_PROBE1(solve_done, ws.path.size());
+    return solved;
+}
+
+//-----------------------------------------------------------------------------
+// Template Instantiations
+//-----------------------------------------------------------------------------
+template bool solveMazeParallel<uint32_t>(MazeGrid&, SolverWorkspace&, TaskScheduler&);
+template bool solveMazeParallel<uint64_t>(MazeGrid&, BasicSolverWorkspace<uint64_t>&, TaskScheduler&);
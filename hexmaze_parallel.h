@@ -0,0 +1,50 @@
+//
+// Parallel generation, solving and rendering of run-time sized mazes
+// (MazeGrid), all run on a TaskScheduler. Results never depend on how many
+// threads the scheduler has.
+//
+// Generation splits the maze into bands of whole rows, builds each band as
+// an independent perfect maze and then joins neighbouring bands through one
+// opened wall each, so the result is still a perfect maze. The joins are
+// visible as a structure: every path between two bands runs through that
+// one opening. Bands are tall (see bandRowsFor) to keep this mild.
+//
+// Solving is a level-synchronous BFS: each level's frontier is expanded in
+// parallel and the path is then traced exactly as solveMazeBFS does, so both
+// mark the same cells.
+//
+// Rendering draws bands of rows into strings in parallel and writes them in
+// order; the output is byte-identical to renderMaze.
+//
+
+#ifndef HEXMAZE_PARALLEL_H
+#define HEXMAZE_PARALLEL_H
+
+#include <cstdint>
+#include <ostream>
+
+#include "hexpathfinder.h"
+#include "hexmaze_scheduler.h"
+
+// Cells per band renderMazeParallel draws into one string
+const uint32_t RENDER_BAND_CELLS = 1 << 16;
+
+// Default band height for generateMazeBands: at least 256 rows, and no more
+// than 64 bands in all
+uint32_t bandRowsFor(uint32_t nR);
+
+// Generates maze from seed, bandRows rows at a time (0 = bandRowsFor).
+// Returns false, as generateMaze does, if a band has more cells than
+// CellIndex can number.
+bool generateMazeBands(MazeGrid& maze, uint32_t seed, TaskScheduler& scheduler, uint32_t bandRows = 0);
+
+// Same result as solveMazeBFS (instantiated for both index types)
+template <class Index>
+bool solveMazeParallel(MazeGrid& maze, BasicSolverWorkspace<Index>& ws, TaskScheduler& scheduler);
+
+// Same output as renderMaze (implementation in hexpathfinder_draw.cpp;
+// instantiated for ArrayMaze and MazeGrid)
+template <class Maze>
+void renderMazeParallel(std::ostream& out, const Maze& maze, TaskScheduler& scheduler);
+
+#endif // HEXMAZE_PARALLEL_H
@@ -0,0 +1,90 @@
+//
+// Persistent (copy-on-write) maze (see hexmaze_persistent.h).
+//
+
+#include <atomic>
+#include <cstring>
+
+#include "hexmaze_persistent.h"
+
+using namespace std;
+
+PersistentMaze::PersistentMaze() : nR(0), nC(0) {
+    fill(ALL_WALLS);
+}
+
+PersistentMaze::PersistentMaze(uint32_t rows, uint32_t cols, uint8_t value) : nR(rows), nC(cols) {
+    fill(value);
+}
+
+PersistentMaze::PersistentMaze(const uint8_t maze[][MAX_COLS], uint32_t rows, uint32_t cols) : nR(rows), nC(cols) {
+    fill(ALL_WALLS);
+    for (uint32_t r = 0; r < nR; ++r)
+        for (uint32_t c = 0; c < nC; ++c)
+            set(r, c, maze[r][c]);
+}
+
+// Every page and chunk starts out as the same shared object
+void PersistentMaze::fill(uint8_t value) {
+    size_t cells = static_cast<size_t>(nR) * nC;
+    size_t chunkCount = (cells + CHUNK_CELLS - 1) >> CHUNK_SHIFT;
+    size_t pageCount = (chunkCount + PAGE_CHUNKS - 1) >> PAGE_SHIFT;
+
+    shared_ptr<Chunk> chunk = make_shared<Chunk>();
+    memset(chunk->cells, value, CHUNK_CELLS);
+    shared_ptr<Page> page = make_shared<Page>();
+    for (auto& p : page->chunks)
+        p = chunk;
+    root = make_shared<Root>(pageCount > 0 ? pageCount : 1, page);
+}
+
+void PersistentMaze::set(uint32_t r, uint32_t c, uint8_t cell) {
+    if (get(r, c) == cell)
+        return;
+
+    size_t i = static_cast<size_t>(r) * nC + c;
+    size_t chunkIndex = i >> CHUNK_SHIFT;
+
+    // Unshare each level on the way down. A use count of 1 means no other
+    // version can see this object, so it may be written in place.
+    // use_count() is a relaxed load: if the last other reference was just
+    // dropped by another thread, the fence orders the writes below after
+    // that thread's reads of the object (its decrement is a release).
+    if (root.use_count() == 1)
+        atomic_thread_fence(memory_order_acquire);
+    else
+        root = make_shared<Root>(*root);
+    shared_ptr<Page>& page = (*root)[chunkIndex >> PAGE_SHIFT];
+    if (page.use_count() == 1)
+        atomic_thread_fence(memory_order_acquire);
+    else
+        page = make_shared<Page>(*page);
+    shared_ptr<Chunk>& chunk = page->chunks[chunkIndex & (PAGE_CHUNKS - 1)];
+    if (chunk.use_count() == 1)
+        atomic_thread_fence(memory_order_acquire);
+    else
+        chunk = make_shared<Chunk>(*chunk);
+    chunk->cells[i & (CHUNK_CELLS - 1)] = cell;
+}
+
+void PersistentMaze::copyTo(uint8_t maze[][MAX_COLS]) const {
+    for (uint32_t r = 0; r < nR; ++r)
+        for (uint32_t c = 0; c < nC; ++c)
+            maze[r][c] = get(r, c);
+}
+
+size_t PersistentMaze::chunkCount() const {
+    return (static_cast<size_t>(nR) * nC + CHUNK_CELLS - 1) >> CHUNK_SHIFT;
+}
+
+size_t PersistentMaze::privateChunks() const {
+    if (root.use_count() != 1)
+        return 0;
+    size_t count = 0, chunks = chunkCount();
+    for (size_t k = 0; k < chunks; ++k) {
+        const shared_ptr<Page>& page = (*root)[k >> PAGE_SHIFT];
+        if (page.use_count() == 1 && page->chunks[k & (PAGE_CHUNKS - 1)].use_count() == 1)
+            ++count;
+    }
+    return count;
+}
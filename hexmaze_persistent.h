@@ -0,0 +1,85 @@
+//
+// Persistent (copy-on-write) maze for undo stacks and branching snapshots.
+//
+// Cells live in fixed-size chunks of CHUNK_CELLS bytes (row-major cell
+// index r * cols + c). Chunks are grouped into pages of PAGE_CHUNKS chunk
+// pointers, and a root table points at the pages; every level is shared by
+// reference count. Copying a PersistentMaze is the snapshot: it shares the
+// root and costs O(1). set() copies, only if they are shared, the root, the
+// one page and the one chunk on the path to the cell, i.e. O(chunk) work;
+// every other version keeps seeing its own cells.
+//
+//   PersistentMaze v1 = ...;
+//   PersistentMaze v2 = v1;      // Snapshot
+//   v2.set(r, c, cell);          // v1 unchanged; one chunk duplicated
+//
+// A freshly filled maze shares one chunk across the whole grid, so even a
+// 10^7-cell maze costs a few kilobytes until it is edited.
+//
+// Implements the maze accessor interface (see hexpathfinder.h), so
+// solveMazeBFS() and renderMaze() work on it directly. A version must not
+// be modified while another thread copies or reads that same object;
+// distinct versions may be used from different threads freely.
+//
+
+#ifndef HEXMAZE_PERSISTENT_H
+#define HEXMAZE_PERSISTENT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "hexpathfinder.h"
+
+class PersistentMaze {
+public:
+    static const uint32_t CHUNK_SHIFT = 12;
+    static const uint32_t CHUNK_CELLS = 1u << CHUNK_SHIFT; // 4 KiB of cells
+    static const uint32_t PAGE_SHIFT = 8;
+    static const uint32_t PAGE_CHUNKS = 1u << PAGE_SHIFT;  // 1 Mi cells per page
+
+    PersistentMaze(); // 0 x 0
+    PersistentMaze(uint32_t rows, uint32_t cols, uint8_t fill = ALL_WALLS);
+    PersistentMaze(const uint8_t maze[][MAX_COLS], uint32_t rows, uint32_t cols);
+
+    // Same as copying; spelled out for readability at call sites
+    PersistentMaze snapshot() const { return *this; }
+
+    uint32_t rows() const { return nR; }
+    uint32_t cols() const { return nC; }
+
+    uint8_t get(uint32_t r, uint32_t c) const {
+        size_t i = static_cast<size_t>(r) * nC + c;
+        size_t chunk = i >> CHUNK_SHIFT;
+        return (*root)[chunk >> PAGE_SHIFT]->chunks[chunk & (PAGE_CHUNKS - 1)]->cells[i & (CHUNK_CELLS - 1)];
+    }
+
+    // No-op (and no copy) if the cell already holds this value
+    void set(uint32_t r, uint32_t c, uint8_t cell);
+
+    // Requires rows() <= MAX_ROWS and cols() <= MAX_COLS
+    void copyTo(uint8_t maze[][MAX_COLS]) const;
+
+    // Chunks this version does not share with any other version; their
+    // bytes are what keeping this version alive costs
+    size_t privateChunks() const;
+    size_t chunkCount() const;
+
+private:
+    struct Chunk {
+        uint8_t cells[CHUNK_CELLS];
+    };
+    struct Page {
+        std::shared_ptr<Chunk> chunks[PAGE_CHUNKS];
+    };
+    typedef std::vector<std::shared_ptr<Page>> Root;
+
+    void fill(uint8_t value);
+
+    uint32_t nR;
+    uint32_t nC;
+    std::shared_ptr<Root> root;
+};
+
+#endif // HEXMAZE_PERSISTENT_H
@@ -0,0 +1,207 @@
+//
+// Pre-generated maze pool (see hexmaze_pool.h).
+//
+
+#include <algorithm>
+#include <random>
+#include <ostream>
+
+#include "hexmaze_pool.h"
+#include "hexmaze_batch.h"
+#include "hexmaze_trace.h"
+
+using namespace std;
+
+//-----------------------------------------------------------------------------
+// Refill Worker
+// Per-task grids and workspaces; seeds come from a per-task engine seeded
+// from std::random_device, so pooled mazes are reproducible from
+// PooledMaze::seed but not predictable.
+//-----------------------------------------------------------------------------
+namespace {
+
+struct RefillState {
+    uint8_t cells[BATCH_MAX_MAZES][MAX_ROWS][MAX_COLS];
+    mt19937 rng;
+    mt19937 seedSource;
+    GeneratorWorkspace generator;
+    BatchSolverWorkspace solver;
+    vector<uint32_t> paths[BATCH_MAX_MAZES];
+};
+
+// Generates count mazes and solves them together with solveMazeBatch()
+void produceMazes(uint32_t rows, uint32_t cols, bool render, uint32_t count, RefillState& st,
+                  vector<unique_ptr<PooledMaze>>& out) {
+    MazeRows batch[BATCH_MAX_MAZES];
+    out.clear();
+    for (uint32_t l = 0; l < count; ++l) {
+        unique_ptr<PooledMaze> maze(new PooledMaze);
+        maze->seed = static_cast<uint32_t>(st.seedSource());
+
+        st.rng.seed(maze->seed);
+        TraceSpan span("pool_generate");
+        generateMaze(st.cells[l], rows, cols, st.rng, st.generator);
+        maze->cells.reserve(static_cast<size_t>(rows) * cols);
+        for (uint32_t r = 0; r < rows; ++r)
+            maze->cells.append(reinterpret_cast<const char*>(st.cells[l][r]), cols);
+        batch[l] = st.cells[l];
+        out.push_back(move(maze));
+    }
+
+    {
+        TraceSpan span("pool_solve");
+        solveMazeBatch(batch, count, rows, cols, st.solver, st.paths);
+    }
+    for (uint32_t l = 0; l < count; ++l) {
+        out[l]->path.swap(st.paths[l]);
+        if (render) {
+            TraceSpan span("pool_render");
+            StringSink sink(out[l]->rendered);
+            ostream ps(&sink);
+            renderMaze(ps, st.cells[l], rows, cols);
+        }
+    }
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+// MazePool
+//-----------------------------------------------------------------------------
+MazePool::SizePool::SizePool(uint32_t r, uint32_t c, size_t capacity)
+    : rows(r), cols(c), ready(capacity), readyCount(0), refillScheduled(false),
+      hits(0), misses(0), produced(0) {}
+
+MazePool::MazePool(const MazePoolOptions& opts, TaskScheduler& scheduler)
+    : options(opts), refillTasks(0), stopping(false), refills(scheduler) {
+    if (options.capacity == 0)
+        options.capacity = 1;
+    if (options.lowWatermark > options.capacity)
+        options.lowWatermark = options.capacity;
+    for (auto& slot : table)
+        slot.store(nullptr, memory_order_relaxed);
+
+    // Refills run for a while; leave a thread free for whoever takes mazes
+    unsigned spare = scheduler.threadCount() > 1 ? scheduler.threadCount() - 1 : 1;
+    maxRefillTasks = min(options.refillThreads ? options.refillThreads : 1, spare);
+
+    for (const auto& size : options.warmSizes) {
+        if (size.first >= 1 && size.first <= MAX_ROWS && size.second >= 1 && size.second <= MAX_COLS)
+            scheduleRefill(poolFor(size.first, size.second));
+    }
+}
+
+MazePool::~MazePool() {
+    {
+        lock_guard<mutex> lock(m);
+        stopping = true;
+    }
+    refills.wait();
+
+    for (auto& pool : pools) {
+        PooledMaze* maze;
+        while (pool->ready.tryPop(maze))
+            delete maze;
+    }
+}
+
+unique_ptr<PooledMaze> MazePool::take(uint32_t rows, uint32_t cols) {
+    SizePool* pool = poolFor(rows, cols);
+    PooledMaze* maze = nullptr;
+    if (pool->ready.tryPop(maze)) {
+        --pool->readyCount;
+        ++pool->hits;
+    } else {
+        ++pool->misses;
+    }
+
+    if (pool->readyCount.load(memory_order_relaxed) < static_cast<int64_t>(options.lowWatermark))
+        scheduleRefill(pool);
+    return unique_ptr<PooledMaze>(maze);
+}
+
+vector<MazePoolStats> MazePool::stats() const {
+    lock_guard<mutex> lock(m);
+    vector<MazePoolStats> out;
+    for (const auto& pool : pools) {
+        MazePoolStats s;
+        s.rows = pool->rows;
+        s.cols = pool->cols;
+        s.hits = pool->hits;
+        s.misses = pool->misses;
+        s.produced = pool->produced;
+        s.ready = pool->readyCount;
+        out.push_back(s);
+    }
+    return out;
+}
+
+// Lock-free lookup; the mutex is only taken the first time a size is seen
+MazePool::SizePool* MazePool::poolFor(uint32_t rows, uint32_t cols) {
+    atomic<SizePool*>& slot = table[(rows - 1) * MAX_COLS + (cols - 1)];
+    SizePool* pool = slot.load(memory_order_acquire);
+    if (pool)
+        return pool;
+
+    lock_guard<mutex> lock(m);
+    pool = slot.load(memory_order_relaxed);
+    if (!pool) {
+        pools.emplace_back(new SizePool(rows, cols, options.capacity));
+        pool = pools.back().get();
+        slot.store(pool, memory_order_release);
+    }
+    return pool;
+}
+
+void MazePool::scheduleRefill(SizePool* pool) {
+    if (pool->refillScheduled.exchange(true))
+        return; // Already queued or being refilled
+    lock_guard<mutex> lock(m);
+    refillQueue.push_back(pool);
+    if (stopping || refillTasks >= maxRefillTasks)
+        return; // A running refill task will get to it
+    ++refillTasks;
+    refills.run([this] { refillLoop(); });
+}
+
+// Runs as a task until the refill queue is empty
+void MazePool::refillLoop() {
+    unique_ptr<RefillState> st(new RefillState);
+    st->seedSource.seed(random_device()());
+    vector<unique_ptr<PooledMaze>> batch;
+
+    unique_lock<mutex> lock(m);
+    while (!stopping && !refillQueue.empty()) {
+        SizePool* pool = refillQueue.front();
+        refillQueue.pop_front();
+        lock.unlock();
+
+        // Only one thread refills a given pool at a time (refillScheduled)
+        // Mazes are made BATCH_MAX_MAZES at a time so they can be solved together
+        bool full = false;
+        while (!stopping && !full) {
+            int64_t missing = static_cast<int64_t>(options.capacity) - pool->readyCount.load();
+            if (missing <= 0)
+                break;
+            uint32_t count = static_cast<uint32_t>(min<int64_t>(missing, BATCH_MAX_MAZES));
+            produceMazes(pool->rows, pool->cols, options.render, count, *st, batch);
+            for (auto& maze : batch) {
+                if (!pool->ready.tryPush(maze.get())) {
+                    full = true;
+                    break;
+                }
+                maze.release();
+                ++pool->readyCount;
+                ++pool->produced;
+            }
+        }
+
+        pool->refillScheduled = false;
+        // take() calls that dipped below the watermark while the flag was
+        // still set did not queue a refill; catch up on their behalf
+        if (!stopping && pool->readyCount.load() < static_cast<int64_t>(options.lowWatermark))
+            scheduleRefill(pool);
+        lock.lock();
+    }
+    --refillTasks;
+}
@@ -0,0 +1,178 @@
+//
+// Pool of ready-made random mazes for unseeded server requests.
+//
+// Each maze size gets its own pool of generated and solved (optionally also
+// rendered) mazes. Taking one is a pop from a lock-free queue; when a pool
+// drops below its low watermark, background tasks on the shared
+// TaskScheduler refill it to capacity.
+// Pools for the sizes listed in MazePoolOptions::warmSizes are filled at
+// startup; any other size gets a pool the first time it is asked for.
+//
+
+#ifndef HEXMAZE_POOL_H
+#define HEXMAZE_POOL_H
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "hexpathfinder.h"
+#include "hexmaze_scheduler.h"
+
+//-----------------------------------------------------------------------------
+// Bounded MPMC Queue
+// Lock-free ring (Vyukov's design): every slot carries a sequence number that
+// tells producers and consumers whose turn it is, so push and pop are one
+// CAS on the shared position plus one release store on the slot.
+//-----------------------------------------------------------------------------
+template <class T>
+class BoundedMpmcQueue {
+public:
+    // capacity is rounded up to a power of two
+    explicit BoundedMpmcQueue(size_t capacity)
+        : slots(roundUpPow2(capacity)), mask(slots.size() - 1), enqueuePos(0), dequeuePos(0) {
+        for (size_t i = 0; i < slots.size(); ++i)
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    bool tryPush(const T& value) {
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        while (true) {
+            Slot& slot = slots[pos & mask];
+            size_t seq = slot.sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    slot.value = value;
+                    slot.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false; // Full
+            } else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool tryPop(T& value) {
+        size_t pos = dequeuePos.load(std::memory_order_relaxed);
+        while (true) {
+            Slot& slot = slots[pos & mask];
+            size_t seq = slot.sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    value = slot.value;
+                    slot.sequence.store(pos + mask + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false; // Empty
+            } else {
+                pos = dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+private:
+    struct Slot {
+        std::atomic<size_t> sequence;
+        T value;
+
+        Slot() : sequence(0), value() {}
+    };
+
+    static size_t roundUpPow2(size_t n) {
+        size_t size = 2;
+        while (size < n)
+            size <<= 1;
+        return size;
+    }
+
+    // Padding keeps producers and consumers off each other's cache line
+    std::vector<Slot> slots;
+    size_t mask;
+    char pad0[64];
+    std::atomic<size_t> enqueuePos;
+    char pad1[64];
+    std::atomic<size_t> dequeuePos;
+};
+
+//-----------------------------------------------------------------------------
+// Maze Pool
+//-----------------------------------------------------------------------------
+
+// A generated maze ready to be served
+struct PooledMaze {
+    uint32_t seed;
+    std::string cells;          // rows * cols cell bytes, as generated
+    std::vector<uint32_t> path; // Solution cells, start to end
+    std::string rendered;       // PostScript; empty unless MazePoolOptions::render
+};
+
+struct MazePoolOptions {
+    size_t capacity = 64;     // Mazes kept ready per size
+    size_t lowWatermark = 16; // Refill starts when a pool holds fewer than this
+    unsigned refillThreads = 1; // Refill tasks at once; at most the scheduler's threads - 1
+    bool render = false;      // Also pre-render every pooled maze
+    std::vector<std::pair<uint32_t, uint32_t>> warmSizes; // (rows, cols) filled at startup
+};
+
+struct MazePoolStats {
+    uint32_t rows;
+    uint32_t cols;
+    uint64_t hits;     // take() served from the pool
+    uint64_t misses;   // take() found the pool empty
+    uint64_t produced; // Mazes generated by the refill tasks
+    int64_t ready;     // Mazes currently waiting
+};
+
+class MazePool {
+public:
+    MazePool(const MazePoolOptions& options, TaskScheduler& scheduler);
+    ~MazePool(); // Stops refilling and waits for running refill tasks
+
+    // Returns a ready maze of the given size, or nullptr if none is ready
+    // yet. Never blocks; a miss or a low pool schedules a refill.
+    std::unique_ptr<PooledMaze> take(uint32_t rows, uint32_t cols);
+
+    // One entry per size that has a pool
+    std::vector<MazePoolStats> stats() const;
+
+private:
+    struct SizePool {
+        SizePool(uint32_t r, uint32_t c, size_t capacity);
+
+        uint32_t rows;
+        uint32_t cols;
+        BoundedMpmcQueue<PooledMaze*> ready;
+        std::atomic<int64_t> readyCount;
+        std::atomic<bool> refillScheduled;
+        std::atomic<uint64_t> hits;
+        std::atomic<uint64_t> misses;
+        std::atomic<uint64_t> produced;
+    };
+
+    SizePool* poolFor(uint32_t rows, uint32_t cols);
+    void scheduleRefill(SizePool* pool);
+    void refillLoop();
+
+    MazePoolOptions options;
+    std::atomic<SizePool*> table[MAX_ROWS * MAX_COLS]; // Indexed (rows - 1) * MAX_COLS + cols - 1
+    std::vector<std::unique_ptr<SizePool>> pools;      // Owns every SizePool; guarded by m
+
+    mutable std::mutex m;
+    std::deque<SizePool*> refillQueue; // Guarded by m
+    unsigned refillTasks;              // Running refill tasks; guarded by m
+    unsigned maxRefillTasks;
+    std::atomic<bool> stopping;
+    TaskGroup refills;
+};
+
+#endif // HEXMAZE_POOL_H
@@ -0,0 +1,79 @@
+//
+// USDT (SystemTap-style) static probes, for tracing a running binary with
+// bpftrace, perf or SystemTap:
+//
+//   bpftrace -e 'usdt:./pathfinder:hexmaze:wall_removed { @[arg2] = count(); }'
+//
+// HEXMAZE_PROBE(name, args...) emits a single nop and describes it in an
+// ELF .note.stapsdt entry, exactly as <sys/sdt.h> does, without needing that
+// header. A tracer patches the nop when it attaches; until then a probe costs
+// the nop and keeping its arguments in registers. Probes only exist in builds
+// with HEXMAZE_USDT defined (`make USDT=1`, x86-64 and AArch64 ELF targets);
+// elsewhere they compile to nothing. `readelf -n pathfinder` lists them.
+//
+// Probes (provider "hexmaze"; arguments are 64-bit):
+//   phase_start(phase), phase_end(phase, ns)  CLI phases, StatPhase numbering
+//   generate_start(rows, cols), generate_done(walls removed)
+//   wall_removed(row, col, direction)
+//   solve_start(rows, cols), solve_done(path cells, 0 if unsolved)
+//   bfs_level(level, cells)                   a BFS level has been expanded
+//   render_start(rows, cols), render_done(rows, cols)
+//   render_band(first row, end row, bytes)    a band was written out
+//
+
+#ifndef HEXMAZE_PROBES_H
+#define HEXMAZE_PROBES_H
+
+#include <cstdint>
+
+#if defined(HEXMAZE_USDT) && defined(__ELF__) && (defined(__x86_64__) || defined(__aarch64__))
+
+// The note: probe address, base used to detect prelink adjustment, no
+// semaphore, provider, name and the argument description ("8@<operand>")
+#define HEXMAZE_PROBE_ASM(name, args)                                                 \
+    "990: nop\n"                                                                     \
+    ".pushsection .note.stapsdt,\"?\",\"note\"\n"                                    \
+    ".balign 4\n"                                                                    \
+    ".4byte 992f-991f, 994f-993f, 3\n"                                               \
+    "991: .asciz \"stapsdt\"\n"                                                      \
+    "992: .balign 4\n"                                                               \
+    "993: .8byte 990b\n"                                                             \
+    ".8byte _.stapsdt.base\n"                                                        \
+    ".8byte 0\n"                                                                     \
+    ".asciz \"hexmaze\"\n"                                                           \
+    ".asciz \"" #name "\"\n"                                                         \
+    ".asciz \"" args "\"\n"                                                          \
+    "994: .balign 4\n"                                                               \
+    ".popsection\n"                                                                  \
+    ".ifndef _.stapsdt.base\n"                                                       \
+    ".pushsection .stapsdt.base,\"aG\",\"progbits\",.stapsdt.base,comdat\n"          \
+    ".weak _.stapsdt.base\n"                                                         \
+    ".hidden _.stapsdt.base\n"                                                       \
+    "_.stapsdt.base: .space 1\n"                                                     \
+    ".size _.stapsdt.base, 1\n"                                                      \
+    ".popsection\n"                                                                  \
+    ".endif\n"
+
+#define HEXMAZE_PROBE_ARG(x) "nor"(static_cast<uint64_t>(x))
+
+#define HEXMAZE_PROBE0(name) __asm__ __volatile__(HEXMAZE_PROBE_ASM(name, ""))
+#define HEXMAZE_PROBE1(name, a) \
+    __asm__ __volatile__(HEXMAZE_PROBE_ASM(name, "8@%0") :: HEXMAZE_PROBE_ARG(a))
+#define HEXMAZE_PROBE2(name, a, b) \
+    __asm__ __volatile__(HEXMAZE_PROBE_ASM(name, "8@%0 8@%1") :: HEXMAZE_PROBE_ARG(a), HEXMAZE_PROBE_ARG(b))
+#define HEXMAZE_PROBE3(name, a, b, c)                                        \
+    __asm__ __volatile__(HEXMAZE_PROBE_ASM(name, "8@%0 8@%1 8@%2")          \
+                         :: HEXMAZE_PROBE_ARG(a), HEXMAZE_PROBE_ARG(b), HEXMAZE_PROBE_ARG(c))
+#define HEXMAZE_PROBES_ENABLED 1
+
+#else
+
+#define HEXMAZE_PROBE0(name) ((void)0)
+#define HEXMAZE_PROBE1(name, a) ((void)0)
+#define HEXMAZE_PROBE2(name, a, b) ((void)0)
+#define HEXMAZE_PROBE3(name, a, b, c) ((void)0)
+#define HEXMAZE_PROBES_ENABLED 0
+
+#endif
+
+#endif // HEXMAZE_PROBES_H
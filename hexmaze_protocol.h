@@ -0,0 +1,89 @@
+//
+// Binary request protocol spoken by `pathfinder --serve` over a Unix domain
+// socket (see hexmaze_server.cpp) and by the loadgen client.
+//
+// Every request is one fixed-size RequestHeader. Every response is one
+// ResponseHeader followed by payloadSize bytes. Requests on a connection may
+// be pipelined; responses can come back out of order and are matched by
+// requestId. The socket is local-only, so all fields are in host byte order.
+//
+// Payloads of successful responses:
+//   OP_GENERATE  rows * cols cell bytes (CellValues wall bits), row-major
+//   OP_SOLVE     as OP_GENERATE, with VISITED set on the solution path
+//   OP_PATH      uint32_t cell indices (r * cols + c), start to end
+//   OP_RENDER    the two-page PostScript document
+//   OP_STATS     server metrics as "name value" text lines (rows, cols and
+//                seed are ignored)
+//
+// With PROTO_FLAG_RANDOM the seed is ignored and the server returns any
+// fresh random maze of the requested size, from its pre-generated pool
+// when one is configured.
+//
+
+#ifndef HEXMAZE_PROTOCOL_H
+#define HEXMAZE_PROTOCOL_H
+
+#include <cstdint>
+#include <cstring>
+
+const uint32_t PROTO_REQUEST_MAGIC = 0x5158484Du;  // "MHXQ"
+const uint32_t PROTO_RESPONSE_MAGIC = 0x5258484Du; // "MHXR"
+
+enum ProtoOp : uint8_t {
+    OP_GENERATE = 1,
+    OP_SOLVE = 2,
+    OP_PATH = 3,
+    OP_RENDER = 4,
+    OP_STATS = 5
+};
+
+enum ProtoFlags : uint8_t {
+    PROTO_FLAG_RANDOM = 0x01 // Unseeded: any random maze will do
+};
+
+enum ProtoStatus : uint8_t {
+    STATUS_OK = 0,
+    STATUS_BAD_REQUEST = 1,   // Unknown op or dimensions out of range
+    STATUS_BUSY = 2,          // Work queue full; retry later
+    STATUS_NO_SOLUTION = 3,
+    STATUS_INTERNAL_ERROR = 4,
+    STATUS_SHUTTING_DOWN = 5
+};
+
+struct RequestHeader {
+    uint32_t magic;     // PROTO_REQUEST_MAGIC
+    uint32_t requestId; // Echoed back in the response
+    uint8_t op;         // ProtoOp
+    uint8_t flags;      // ProtoFlags; unknown bits must be 0
+    uint16_t reserved;
+    uint16_t rows;
+    uint16_t cols;
+    uint32_t seed;      // Same seed + dimensions always give the same maze
+};
+
+struct ResponseHeader {
+    uint32_t magic;     // PROTO_RESPONSE_MAGIC
+    uint32_t requestId;
+    uint8_t status;     // ProtoStatus
+    uint8_t op;
+    uint16_t reserved;
+    uint32_t payloadSize;
+};
+
+static_assert(sizeof(RequestHeader) == 20, "RequestHeader must stay 20 bytes");
+static_assert(sizeof(ResponseHeader) == 16, "ResponseHeader must stay 16 bytes");
+
+// Copy helpers; buffers off the wire need not be aligned
+inline RequestHeader decodeRequest(const char* bytes) {
+    RequestHeader req;
+    std::memcpy(&req, bytes, sizeof(req));
+    return req;
+}
+
+inline ResponseHeader decodeResponse(const char* bytes) {
+    ResponseHeader resp;
+    std::memcpy(&resp, bytes, sizeof(resp));
+    return resp;
+}
+
+#endif // HEXMAZE_PROTOCOL_H
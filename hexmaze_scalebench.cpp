@@ -0,0 +1,280 @@
+//
+// Scaling benchmark for the task scheduler (hexmaze_scheduler.h).
+// Runs each parallel workload with 1, 2, 4, ... threads up to --max-threads
+// and reports, from the best time of --reps runs, the speedup, parallel
+// efficiency and time per cell.
+//
+//   strong  the same problem at every thread count: speedup T1/Tn,
+//           efficiency T1/(n Tn). Every thread count must produce the same
+//           result; the benchmark fails if one does not.
+//   weak    the problem grows with the threads (n times the mazes, n times
+//           the grid rows): scaled speedup n T1/Tn, efficiency T1/Tn.
+//
+//   batch   --mazes 50x50 mazes generated and solved 32 at a time
+//   bands   band generation of a --size x --size MazeGrid
+//   bfs     level-parallel BFS of that maze
+//   render  band rendering of the solved maze (output hashed, not stored)
+//   validate  perfect-maze validation of that maze (hexmaze_validate.h)
+//
+// Mazes come from --seed (batch maze i from seed + i), so runs are
+// reproducible from the command line alone.
+//
+// Usage: scalebench [--size N] [--mazes N] [--max-threads N] [--reps N]
+//                   [--seed N] [--strong | --weak] [--pin]
+//
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <memory>
+#include <stdexcept>
+#include <algorithm>
+
+#include "hexpathfinder.h"
+#include "hexmaze_batch.h"
+#include "hexmaze_parallel.h"
+#include "hexmaze_scheduler.h"
+#include "hexmaze_validate.h"
+
+using namespace std;
+typedef chrono::steady_clock Clock;
+
+static const char* WORKLOAD_NAMES[] = {"batch", "bands", "bfs", "render", "validate"};
+const int WORKLOAD_COUNT = 5;
+
+static uint64_t fnv1a(uint64_t hash, const uint8_t* data, size_t size) {
+    for (size_t i = 0; i < size; ++i)
+        hash = (hash ^ data[i]) * 0x100000001B3ull;
+    return hash;
+}
+
+const uint64_t FNV_OFFSET = 0xCBF29CE484222325ull;
+
+// Stream buffer that hashes what is written instead of keeping it
+class HashSink : public streambuf {
+public:
+    HashSink() : hash(FNV_OFFSET) {}
+    uint64_t hash;
+
+protected:
+    int_type overflow(int_type ch) override {
+        if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+            uint8_t byte = static_cast<uint8_t>(ch);
+            hash = fnv1a(hash, &byte, 1);
+        }
+        return traits_type::not_eof(ch);
+    }
+
+    streamsize xsputn(const char* s, streamsize n) override {
+        hash = fnv1a(hash, reinterpret_cast<const uint8_t*>(s), static_cast<size_t>(n));
+        return n;
+    }
+};
+
+struct BatchSlot {
+    uint8_t mazes[BATCH_MAX_MAZES][MAX_ROWS][MAX_COLS];
+    vector<uint32_t> paths[BATCH_MAX_MAZES];
+    GeneratorWorkspace generator;
+    BatchSolverWorkspace solver;
+};
+
+// Generates and solves mazes [0, count) with seeds seed.., one batch per
+// task; returns a hash of every path
+static uint64_t runBatches(TaskScheduler& scheduler, uint32_t count, uint32_t seed,
+                           vector<unique_ptr<BatchSlot>>& slots) {
+    const uint32_t batches = (count + BATCH_MAX_MAZES - 1) / BATCH_MAX_MAZES;
+    while (slots.size() < batches)
+        slots.emplace_back(new BatchSlot);
+    parallelFor(scheduler, 0, batches, 1, [&](size_t lo, size_t hi) {
+        for (size_t b = lo; b < hi; ++b) {
+            BatchSlot& slot = *slots[b];
+            uint32_t n = min<uint32_t>(BATCH_MAX_MAZES, count - static_cast<uint32_t>(b) * BATCH_MAX_MAZES);
+            MazeRows rows[BATCH_MAX_MAZES] = {};
+            for (uint32_t l = 0; l < n; ++l) {
+                mt19937 rng(seed + static_cast<uint32_t>(b) * BATCH_MAX_MAZES + l);
+                generateMaze(slot.mazes[l], MAX_ROWS, MAX_COLS, rng, slot.generator);
+                rows[l] = slot.mazes[l];
+            }
+            solveMazeBatch(rows, n, MAX_ROWS, MAX_COLS, slot.solver, slot.paths);
+        }
+    });
+
+    uint64_t hash = FNV_OFFSET;
+    for (uint32_t i = 0; i < count; ++i) {
+        const vector<uint32_t>& path = slots[i / BATCH_MAX_MAZES]->paths[i % BATCH_MAX_MAZES];
+        hash = fnv1a(hash, reinterpret_cast<const uint8_t*>(path.data()), path.size() * sizeof(uint32_t));
+    }
+    return hash;
+}
+
+// What every workload works on at one thread count
+struct Problem {
+    uint32_t mazes;
+    uint32_t rows;
+    uint32_t cols;
+    uint32_t seed;
+
+    uint64_t cells(int workload) const {
+        if (workload == 0)
+            return static_cast<uint64_t>(mazes) * MAX_ROWS * MAX_COLS;
+        return static_cast<uint64_t>(rows) * cols;
+    }
+};
+
+struct Workspaces {
+    vector<unique_ptr<BatchSlot>> slots;
+    MazeGrid grid;
+    BasicSolverWorkspace<CellIndex> solver;
+};
+
+// Best time of reps runs of every workload, and a hash of each result
+static void measure(TaskScheduler& scheduler, const Problem& problem, unsigned reps, Workspaces& ws,
+                    double best[WORKLOAD_COUNT], uint64_t result[WORKLOAD_COUNT]) {
+    fill(best, best + WORKLOAD_COUNT, 1e300);
+    for (unsigned rep = 0; rep < reps; ++rep) {
+        for (int w = 0; w < WORKLOAD_COUNT; ++w) {
+            Clock::time_point start = Clock::now();
+            if (w == 0) {
+                result[w] = runBatches(scheduler, problem.mazes, problem.seed, ws.slots);
+            } else if (w == 1) {
+                ws.grid = MazeGrid(problem.rows, problem.cols);
+                generateMazeBands(ws.grid, problem.seed, scheduler);
+            } else if (w == 2) {
+                solveMazeParallel(ws.grid, ws.solver, scheduler);
+            } else if (w == 4) {
+                MazeValidation v = validateMaze(ws.grid, scheduler);
+                result[w] = v.perfect() ? v.passages : 0;
+            } else {
+                HashSink sink;
+                ostream out(&sink);
+                renderMazeParallel(out, ws.grid, scheduler);
+                result[w] = sink.hash;
+            }
+            best[w] = min(best[w], chrono::duration<double>(Clock::now() - start).count());
+            if (w == 1)
+                result[w] = fnv1a(FNV_OFFSET, ws.grid.cells.data(), ws.grid.cells.size());
+            else if (w == 2)
+                result[w] = fnv1a(FNV_OFFSET, reinterpret_cast<const uint8_t*>(ws.solver.path.data()),
+                                  ws.solver.path.size() * sizeof(CellIndex));
+        }
+    }
+}
+
+// Runs one scaling study and prints its table; returns the number of results
+// that differ from the one-thread run (strong scaling only)
+static int runScaling(bool weak, const Problem& base, const vector<unsigned>& threadCounts, unsigned reps,
+                      bool pin) {
+    cout << (weak ? "Weak" : "Strong") << " scaling: " << base.mazes << " batch mazes and a " << base.rows
+         << "x" << base.cols << " grid" << (weak ? " per thread" : "") << ", seed " << base.seed
+         << ", best of " << reps << (pin ? ", pinned" : "") << endl;
+    cout << left << setw(8) << "workload" << right << setw(9) << "threads" << setw(13) << "cells"
+         << setw(11) << "seconds" << setw(10) << "speedup" << setw(12) << "efficiency" << setw(10)
+         << "ns/cell" << endl;
+
+    Workspaces ws;
+    double baseline[WORKLOAD_COUNT] = {};
+    uint64_t expected[WORKLOAD_COUNT] = {};
+    int mismatches = 0;
+
+    for (unsigned threads : threadCounts) {
+        Problem problem = base;
+        if (weak) {
+            problem.mazes = base.mazes * threads;
+            problem.rows = base.rows * threads;
+        }
+        TaskScheduler scheduler(threads, pin);
+        double best[WORKLOAD_COUNT];
+        uint64_t result[WORKLOAD_COUNT] = {};
+        measure(scheduler, problem, reps, ws, best, result);
+
+        for (int w = 0; w < WORKLOAD_COUNT; ++w) {
+            if (threads == threadCounts[0]) {
+                baseline[w] = best[w];
+                expected[w] = result[w];
+            } else if (!weak && result[w] != expected[w]) {
+                cerr << WORKLOAD_NAMES[w] << " result differs with " << threads << " threads" << endl;
+                ++mismatches;
+            }
+            // Relative to threadCounts[0], which is 1
+            double speedup = (weak ? threads : 1) * baseline[w] / best[w];
+            double efficiency = speedup / threads;
+            uint64_t cells = problem.cells(w);
+            cout << left << setw(8) << WORKLOAD_NAMES[w] << right << setw(9) << threads << setw(13) << cells
+                 << setw(11) << setprecision(3) << best[w] << setw(9) << setprecision(2) << speedup << "x"
+                 << setw(11) << setprecision(1) << 100.0 * efficiency << "%" << setw(10)
+                 << 1e9 * best[w] / static_cast<double>(cells) << endl;
+        }
+    }
+    return mismatches;
+}
+
+int main(int argc, char* argv[]) {
+    Problem problem = {2048, 1000, 1000, 1};
+    unsigned maxThreads = thread::hardware_concurrency();
+    unsigned reps = 3;
+    bool pin = false;
+    bool strong = true, weak = true;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            string opt = argv[i];
+            if (opt == "--pin") {
+                pin = true;
+                continue;
+            }
+            if (opt == "--strong" || opt == "--weak") {
+                strong = opt == "--strong";
+                weak = !strong;
+                continue;
+            }
+            if (i + 1 >= argc)
+                throw invalid_argument("missing value for " + opt);
+            unsigned long n = stoul(argv[++i]);
+            if (n == 0)
+                throw invalid_argument(opt + " must be positive");
+            if (opt == "--size" && n <= 20000) problem.rows = problem.cols = static_cast<uint32_t>(n);
+            else if (opt == "--mazes" && n <= 1000000) problem.mazes = static_cast<uint32_t>(n);
+            else if (opt == "--max-threads" && n <= 4096) maxThreads = static_cast<unsigned>(n);
+            else if (opt == "--reps") reps = static_cast<unsigned>(n);
+            else if (opt == "--seed" && n <= UINT32_MAX) problem.seed = static_cast<uint32_t>(n);
+            else throw invalid_argument("bad option " + opt);
+        }
+    } catch (const exception& e) {
+        cerr << "Error: " << e.what() << endl << "Usage: " << argv[0]
+             << " [--size N] [--mazes N] [--max-threads N] [--reps N] [--seed N] [--strong | --weak] [--pin]"
+             << endl;
+        return 1;
+    }
+    if (maxThreads == 0)
+        maxThreads = 1;
+
+    vector<unsigned> threadCounts;
+    for (unsigned t = 1; t < maxThreads; t *= 2)
+        threadCounts.push_back(t);
+    threadCounts.push_back(maxThreads);
+
+    cout << fixed << thread::hardware_concurrency() << " hardware threads" << endl << endl;
+    int mismatches = 0;
+    if (strong)
+        mismatches += runScaling(false, problem, threadCounts, reps, pin);
+    if (strong && weak)
+        cout << endl;
+    if (weak) {
+        try {
+            runScaling(true, problem, threadCounts, reps, pin);
+        } catch (const bad_alloc&) {
+            cerr << "Error: out of memory for a " << static_cast<uint64_t>(problem.rows) * maxThreads << "x"
+                 << problem.cols << " weak-scaling grid; lower --size or --max-threads." << endl;
+            return 1;
+        }
+    }
+
+    if (mismatches != 0) {
+        cerr << mismatches << " results differ between thread counts" << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,274 @@
+//
+// Work-stealing task scheduler (see hexmaze_scheduler.h).
+//
+
+#include <algorithm>
+#include <chrono>
+
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+
+#include "hexmaze_scheduler.h"
+
+using namespace std;
+
+namespace {
+
+const int SPIN_ROUNDS = 64; // findTask() retries (with a yield) before a worker sleeps
+
+// Set on worker threads only
+thread_local const TaskScheduler* workerOwner = nullptr;
+thread_local int workerIndex = -1;
+
+// Victim choice for stealing; any cheap per-thread sequence will do
+thread_local uint32_t stealSeed = 0x9E3779B9u;
+
+uint32_t nextVictim() {
+    stealSeed ^= stealSeed << 13;
+    stealSeed ^= stealSeed >> 17;
+    stealSeed ^= stealSeed << 5;
+    return stealSeed;
+}
+
+// CPUs the process may run on, in ascending order
+vector<int> allowedCpus() {
+    vector<int> cpus;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+            if (CPU_ISSET(cpu, &set))
+                cpus.push_back(cpu);
+    }
+    return cpus;
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+// Task Scheduler
+//-----------------------------------------------------------------------------
+TaskScheduler::TaskScheduler(unsigned threads, bool pin)
+    : pin(pin), stopping(false), epoch(0), sleepers(0) {
+    if (threads == 0)
+        threads = thread::hardware_concurrency();
+    if (threads == 0)
+        threads = 1;
+    for (unsigned i = 0; i < threads; ++i)
+        queues.emplace_back(new WorkerQueue);
+
+    vector<int> cpus = pin ? allowedCpus() : vector<int>();
+    for (unsigned i = 0; i < threads; ++i) {
+        workers.emplace_back(&TaskScheduler::workerLoop, this, i);
+        if (!cpus.empty()) {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(cpus[i % cpus.size()], &set);
+            pthread_setaffinity_np(workers.back().native_handle(), sizeof(set), &set);
+        }
+    }
+}
+
+TaskScheduler::~TaskScheduler() {
+    {
+        lock_guard<mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    sleepCv.notify_all();
+    for (auto& t : workers)
+        t.join();
+
+    // Only tasks of a group nobody waited for can be left
+    for (auto& q : queues)
+        for (Task* task : q->tasks)
+            delete task;
+    for (Task* task : injected.tasks)
+        delete task;
+}
+
+int TaskScheduler::currentWorker() const {
+    return workerOwner == this ? workerIndex : -1;
+}
+
+void TaskScheduler::submit(Task* task) {
+    int self = currentWorker();
+    WorkerQueue& q = self >= 0 ? *queues[self] : injected;
+    {
+        lock_guard<mutex> lock(q.m);
+        q.tasks.push_back(task);
+    }
+
+    // Pairs with workerLoop(): a worker either sees the new epoch before it
+    // sleeps, or is already counted in sleepers and gets notified
+    epoch.fetch_add(1);
+    if (sleepers.load() > 0) {
+        lock_guard<mutex> lock(sleepMutex);
+        sleepCv.notify_one();
+    }
+}
+
+TaskScheduler::Task* TaskScheduler::findTask(int self) {
+    Task* task = nullptr;
+    if (self >= 0) {
+        WorkerQueue& own = *queues[self];
+        lock_guard<mutex> lock(own.m);
+        if (!own.tasks.empty()) {
+            task = own.tasks.back();
+            own.tasks.pop_back();
+            return task;
+        }
+    }
+    {
+        lock_guard<mutex> lock(injected.m);
+        if (!injected.tasks.empty()) {
+            task = injected.tasks.front();
+            injected.tasks.pop_front();
+            return task;
+        }
+    }
+
+    // Steal the oldest task of some other worker, starting at a random one
+    const size_t n = queues.size();
+    const size_t start = nextVictim() % n;
+    for (size_t k = 0; k < n; ++k) {
+        size_t victim = (start + k) % n;
+        if (static_cast<int>(victim) == self)
+            continue;
+        WorkerQueue& q = *queues[victim];
+        lock_guard<mutex> lock(q.m);
+        if (!q.tasks.empty()) {
+            task = q.tasks.front();
+            q.tasks.pop_front();
+            return task;
+        }
+    }
+    return nullptr;
+}
+
+void TaskScheduler::execute(Task* task) {
+    exception_ptr error;
+    try {
+        task->run();
+    } catch (...) {
+        error = current_exception();
+    }
+    TaskGroup* group = task->group;
+    delete task;
+    group->finished(error);
+}
+
+void TaskScheduler::workerLoop(unsigned index) {
+    workerOwner = this;
+    workerIndex = static_cast<int>(index);
+
+    // Process-directed signals (SIGINT, SIGTERM, ...) go to the threads that
+    // expect them, e.g. the server's signalfd; faults still reach the worker
+    sigset_t mask;
+    sigfillset(&mask);
+    for (int sig : {SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGTRAP, SIGABRT})
+        sigdelset(&mask, sig);
+    pthread_sigmask(SIG_BLOCK, &mask, nullptr);
+    stealSeed ^= (index + 1) * 0x85EBCA6Bu;
+
+    while (true) {
+        Task* task = findTask(workerIndex);
+        if (task) {
+            execute(task);
+            continue;
+        }
+
+        // Spin briefly: new tasks usually follow soon (e.g. parallelFor splits)
+        uint64_t seen = epoch.load();
+        for (int spin = 0; spin < SPIN_ROUNDS && !task; ++spin) {
+            this_thread::yield();
+            task = findTask(workerIndex);
+        }
+        if (task) {
+            execute(task);
+            continue;
+        }
+        if (stopping)
+            break;
+
+        unique_lock<mutex> lock(sleepMutex);
+        sleepers.fetch_add(1);
+        while (!stopping && epoch.load() == seen)
+            sleepCv.wait(lock);
+        sleepers.fetch_sub(1);
+    }
+}
+
+//-----------------------------------------------------------------------------
+// Task Group
+//-----------------------------------------------------------------------------
+TaskGroup::~TaskGroup() {
+    try {
+        wait();
+    } catch (...) {
+        // Already reported to whoever called wait(); nothing to do here
+    }
+}
+
+void TaskGroup::run(function<void()> task) {
+    pending.fetch_add(1);
+    scheduler.submit(new TaskScheduler::Task{std::move(task), this});
+}
+
+// Decrements under the mutex: once wait() has taken the mutex and seen
+// pending == 0, no finishing task can still touch the group
+void TaskGroup::finished(exception_ptr taskError) {
+    lock_guard<mutex> lock(m);
+    if (taskError && !error)
+        error = taskError;
+    if (pending.fetch_sub(1) == 1)
+        cv.notify_all();
+}
+
+void TaskGroup::wait() {
+    const int self = scheduler.currentWorker();
+    while (pending.load() != 0) {
+        TaskScheduler::Task* task = scheduler.findTask(self);
+        if (task) {
+            scheduler.execute(task);
+            continue;
+        }
+        // The group's remaining tasks are running elsewhere; check back for
+        // stealable work now and then while they finish
+        unique_lock<mutex> lock(m);
+        cv.wait_for(lock, chrono::microseconds(200), [this] { return pending.load() == 0; });
+    }
+
+    exception_ptr taskError;
+    {
+        lock_guard<mutex> lock(m);
+        swap(taskError, error);
+    }
+    if (taskError)
+        rethrow_exception(taskError);
+}
+
+//-----------------------------------------------------------------------------
+// Parallel For
+//-----------------------------------------------------------------------------
+static void splitRange(TaskGroup& group, size_t begin, size_t end, size_t grain,
+                       const function<void(size_t, size_t)>& body) {
+    // Hand off the upper half until the rest is small enough to run here
+    while (end - begin > grain) {
+        size_t mid = begin + (end - begin) / 2;
+        group.run([&group, &body, mid, end, grain] { splitRange(group, mid, end, grain, body); });
+        end = mid;
+    }
+    body(begin, end);
+}
+
+void parallelFor(TaskScheduler& scheduler, size_t begin, size_t end, size_t grain,
+                 const function<void(size_t, size_t)>& body) {
+    if (begin >= end)
+        return;
+    if (grain == 0)
+        grain = max<size_t>(1, (end - begin) / (8 * static_cast<size_t>(scheduler.threadCount())));
+    TaskGroup group(scheduler);
+    splitRange(group, begin, end, grain, body);
+    group.wait();
+}
@@ -0,0 +1,124 @@
+//
+// Work-stealing task scheduler shared by every parallel part of the library
+// (band generation and rendering, level-parallel BFS, catalog batches, the
+// server and its maze pool), so a process runs one set of worker threads
+// however many subsystems are busy.
+//
+// Each worker owns a deque: it pushes and pops its own tasks at the back
+// (newest first, for cache locality) while idle workers steal from the front
+// of the others (oldest first, i.e. the largest pieces of a split range).
+// Tasks submitted from outside the pool go to a shared injection queue.
+// Idle workers sleep on a condition variable and are woken by new work.
+//
+// Tasks are grouped: TaskGroup::wait() runs queued tasks itself (any
+// group's) until every task of its group has finished, so waiting inside a
+// task never blocks a worker.
+//
+
+#ifndef HEXMAZE_SCHEDULER_H
+#define HEXMAZE_SCHEDULER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class TaskGroup;
+
+class TaskScheduler {
+public:
+    // threads == 0 starts one worker per hardware thread. With pin, worker i
+    // only runs on the i-th CPU the process may use (wrapping around).
+    explicit TaskScheduler(unsigned threads = 0, bool pin = false);
+    ~TaskScheduler(); // Joins the workers; every TaskGroup must be finished
+
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+    unsigned threadCount() const { return static_cast<unsigned>(workers.size()); }
+    bool pinned() const { return pin; }
+
+    // Index of the calling thread among this scheduler's workers, or -1 for
+    // any other thread. Handy for per-worker scratch space: size it
+    // threadCount() + 1 and use the last slot for -1.
+    int currentWorker() const;
+
+private:
+    friend class TaskGroup;
+
+    struct Task {
+        std::function<void()> run;
+        TaskGroup* group;
+    };
+
+    // Padding keeps neighbouring workers' queues off each other's cache line
+    struct WorkerQueue {
+        std::mutex m;
+        std::deque<Task*> tasks;
+        char pad[64];
+    };
+
+    void submit(Task* task);
+    Task* findTask(int self);
+    void execute(Task* task);
+    void workerLoop(unsigned index);
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues; // One per worker
+    WorkerQueue injected;                             // Submissions from other threads
+    std::vector<std::thread> workers;
+    bool pin;
+
+    std::atomic<bool> stopping;
+    std::atomic<uint64_t> epoch;    // Bumped on every submit; sleepers wait for a change
+    std::atomic<unsigned> sleepers;
+    std::mutex sleepMutex;
+    std::condition_variable sleepCv;
+};
+
+//-----------------------------------------------------------------------------
+// Task Group
+// Tasks that are waited for together. The destructor waits, so a group on
+// the stack cannot outlive the data its tasks capture by reference.
+//-----------------------------------------------------------------------------
+class TaskGroup {
+public:
+    explicit TaskGroup(TaskScheduler& scheduler) : scheduler(scheduler), pending(0) {}
+    ~TaskGroup();
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    void run(std::function<void()> task);
+
+    // Helps run tasks until all of this group's tasks have finished, then
+    // rethrows the first exception any of them threw
+    void wait();
+
+    TaskScheduler& owner() const { return scheduler; }
+
+private:
+    friend class TaskScheduler;
+
+    void finished(std::exception_ptr error);
+
+    TaskScheduler& scheduler;
+    std::atomic<size_t> pending;
+    std::mutex m; // Guards error and wakes wait() when pending reaches 0
+    std::condition_variable cv;
+    std::exception_ptr error;
+};
+
+// Calls body(lo, hi) on disjoint subranges covering [begin, end), split in
+// halves down to at most grain elements each (0 = about eight pieces per
+// worker), and returns once every piece has run
+void parallelFor(TaskScheduler& scheduler, size_t begin, size_t end, size_t grain,
+                 const std::function<void(size_t, size_t)>& body);
+
+#endif // HEXMAZE_SCHEDULER_H
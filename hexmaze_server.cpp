@@ -0,0 +1,745 @@
+//
+// Local maze server: one epoll thread owns all sockets; requests are
+// generated, solved and rendered as tasks on the process's TaskScheduler.
+// Each scheduler thread keeps its own maze grid and workspaces, so
+// steady-state requests do not allocate for maze data.
+//
+// With a MazeCache configured, each request first looks for the blob that
+// answers it directly and otherwise rebuilds from whatever parts are cached
+// (maze cells, solution path), storing what it had to compute.
+//
+// Requests flagged PROTO_FLAG_RANDOM are answered from a MazePool of
+// pre-generated mazes when one is configured.
+//
+// Backpressure: requests in flight are bounded by the queue capacity; one
+// beyond it is answered STATUS_BUSY immediately. A connection whose unsent
+// responses exceed MAX_PENDING_OUTPUT stops being read until the client
+// catches up.
+//
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <chrono>
+#include <cerrno>
+#include <cstring>
+#include <cstddef> // For offsetof
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include "hexpathfinder.h"
+#include "hexmaze_cache.h"
+#include "hexmaze_pool.h"
+#include "hexmaze_protocol.h"
+#include "hexmaze_scheduler.h"
+#include "hexmaze_server.h"
+#include "hexmaze_trace.h"
+
+using namespace std;
+
+namespace {
+
+const size_t MAX_PENDING_OUTPUT = 4u << 20; // Per connection, bytes
+const int SHUTDOWN_DRAIN_MS = 5000;         // Max time to flush responses on shutdown
+
+// epoll data tags below FIRST_CONN_ID identify the server's own descriptors
+const uint64_t TAG_LISTEN = 1;
+const uint64_t TAG_SIGNAL = 2;
+const uint64_t TAG_WAKEUP = 3;
+const uint64_t FIRST_CONN_ID = 16;
+
+struct Job {
+    uint64_t connId;
+    RequestHeader request;
+    uint64_t queuedNs; // traceClockNs() at submission, 0 when not tracing
+};
+
+//-----------------------------------------------------------------------------
+// Completions
+// Finished responses handed back to the epoll thread, which is woken through
+// an eventfd.
+//-----------------------------------------------------------------------------
+struct Completion {
+    uint64_t connId;
+    string bytes; // ResponseHeader + payload
+};
+
+class CompletionList {
+public:
+    CompletionList() : wakeupFd(-1) {}
+
+    void setWakeupFd(int fd) { wakeupFd = fd; }
+
+    void push(Completion&& done) {
+        {
+            lock_guard<mutex> lock(m);
+            items.push_back(std::move(done));
+        }
+        uint64_t one = 1;
+        ssize_t n = write(wakeupFd, &one, sizeof(one));
+        (void)n; // eventfd counter saturation is harmless; the reader drains everything
+    }
+
+    void drain(vector<Completion>& out) {
+        lock_guard<mutex> lock(m);
+        for (auto& item : items)
+            out.push_back(std::move(item));
+        items.clear();
+    }
+
+private:
+    mutex m;
+    vector<Completion> items;
+    int wakeupFd;
+};
+
+//-----------------------------------------------------------------------------
+// Worker
+// Per-thread maze grid and workspaces, reused for every request. One per
+// scheduler thread, plus one for the epoll thread, which runs leftover jobs
+// while it waits for them at shutdown.
+//-----------------------------------------------------------------------------
+struct WorkerState {
+    uint8_t cells[MAX_ROWS][MAX_COLS];
+    mt19937 rng;
+    mt19937 seedSource; // Seeds for PROTO_FLAG_RANDOM requests the pool can't serve
+    GeneratorWorkspace generator;
+    SolverWorkspace solver;
+};
+
+void appendResponseHeader(string& out, uint32_t requestId, uint8_t op, uint8_t status, uint32_t payloadSize) {
+    ResponseHeader resp;
+    resp.magic = PROTO_RESPONSE_MAGIC;
+    resp.requestId = requestId;
+    resp.status = status;
+    resp.op = op;
+    resp.reserved = 0;
+    resp.payloadSize = payloadSize;
+    out.append(reinterpret_cast<const char*>(&resp), sizeof(resp));
+}
+
+string errorResponse(const RequestHeader& req, uint8_t status) {
+    string out;
+    appendResponseHeader(out, req.requestId, req.op, status, 0);
+    return out;
+}
+
+void appendCells(string& out, WorkerState& ws, uint32_t nR, uint32_t nC) {
+    for (uint32_t r = 0; r < nR; ++r)
+        out.append(reinterpret_cast<const char*>(ws.cells[r]), nC);
+}
+
+// Finishes a response whose payload has been appended after the header
+void patchPayloadSize(string& out) {
+    uint32_t payloadSize = static_cast<uint32_t>(out.size() - sizeof(ResponseHeader));
+    memcpy(&out[offsetof(ResponseHeader, payloadSize)], &payloadSize, sizeof(payloadSize));
+}
+
+// The cache blob that answers op on its own, if any
+bool directCacheKind(uint8_t op, CacheKind& kind) {
+    switch (op) {
+    case OP_GENERATE: kind = CACHE_MAZE; return true;
+    case OP_PATH: kind = CACHE_SOLUTION; return true;
+    case OP_RENDER: kind = CACHE_RENDER; return true;
+    default: return false; // OP_SOLVE is rebuilt from CACHE_MAZE + CACHE_SOLUTION
+    }
+}
+
+// Fills ws.cells with the generated maze, from the cache when possible
+void loadMaze(const MazeCacheKey& key, WorkerState& ws, MazeCache* cache) {
+    CacheBlob cached = cache ? cache->get(key, CACHE_MAZE) : nullptr;
+    if (cached && cached->size() == static_cast<size_t>(key.rows) * key.cols) {
+        for (uint32_t r = 0; r < key.rows; ++r)
+            memcpy(ws.cells[r], cached->data() + r * key.cols, key.cols);
+        return;
+    }
+
+    ws.rng.seed(key.seed);
+    {
+        TraceSpan span("generate");
+        generateMaze(ws.cells, key.rows, key.cols, ws.rng, ws.generator);
+    }
+    if (cache) {
+        shared_ptr<string> blob = make_shared<string>();
+        appendCells(*blob, ws, key.rows, key.cols);
+        cache->put(key, CACHE_MAZE, blob);
+    }
+}
+
+// A cached CACHE_SOLUTION blob is only used if it could be this maze's path:
+// at most one entry per cell, every entry a cell, running from start to end.
+// Anything else (stale, foreign or damaged disk objects) counts as a miss.
+bool plausiblePath(const string& blob, uint32_t cells) {
+    const size_t length = blob.size() / sizeof(uint32_t);
+    if (blob.empty() || blob.size() % sizeof(uint32_t) != 0 || length > cells)
+        return false;
+    for (size_t i = 0; i < length; ++i) {
+        uint32_t idx;
+        memcpy(&idx, blob.data() + i * sizeof(uint32_t), sizeof(idx));
+        if (idx >= cells || (i == 0 && idx != 0) || (i + 1 == length && idx != cells - 1))
+            return false;
+    }
+    return true;
+}
+
+// Marks the solution on ws.cells and leaves it in ws.solver.path, reusing a
+// cached path when possible. Returns false if the maze has no solution.
+bool loadSolution(const MazeCacheKey& key, WorkerState& ws, MazeCache* cache) {
+    CacheBlob cached = cache ? cache->get(key, CACHE_SOLUTION) : nullptr;
+    if (cached && plausiblePath(*cached, key.rows * key.cols)) {
+        vector<uint32_t>& path = ws.solver.path;
+        path.resize(cached->size() / sizeof(uint32_t));
+        memcpy(path.data(), cached->data(), cached->size());
+        for (uint32_t idx : path)
+            ws.cells[idx / key.cols][idx % key.cols] |= VISITED;
+        return true;
+    }
+
+    TraceSpan span("solve");
+    if (!solveMazeBFS(ws.cells, key.rows, key.cols, ws.solver))
+        return false;
+    if (cache) {
+        const vector<uint32_t>& path = ws.solver.path;
+        cache->put(key, CACHE_SOLUTION, make_shared<string>(
+            reinterpret_cast<const char*>(path.data()), path.size() * sizeof(uint32_t)));
+    }
+    return true;
+}
+
+// Builds the complete response (header + payload) for one request
+void processRequest(const RequestHeader& req, WorkerState& ws, MazeCache* cache, string& out) {
+    const uint32_t nR = req.rows;
+    const uint32_t nC = req.cols;
+    MazeCacheKey key = {nR, nC, req.seed, GENERATOR_KRUSKAL, 0};
+
+    out.clear();
+    appendResponseHeader(out, req.requestId, req.op, STATUS_OK, 0);
+
+    CacheKind kind;
+    if (cache && directCacheKind(req.op, kind)) {
+        CacheBlob hit = cache->get(key, kind);
+        if (hit && (kind != CACHE_SOLUTION || plausiblePath(*hit, nR * nC))) {
+            out += *hit;
+            patchPayloadSize(out);
+            return;
+        }
+    }
+
+    loadMaze(key, ws, cache);
+    if (req.op != OP_GENERATE && !loadSolution(key, ws, cache)) {
+        out = errorResponse(req, STATUS_NO_SOLUTION);
+        return;
+    }
+
+    switch (req.op) {
+    case OP_GENERATE:
+    case OP_SOLVE:
+        appendCells(out, ws, nR, nC);
+        break;
+    case OP_PATH:
+        out.append(reinterpret_cast<const char*>(ws.solver.path.data()),
+                   ws.solver.path.size() * sizeof(uint32_t));
+        break;
+    case OP_RENDER: {
+        TraceSpan span("render");
+        StringSink sink(out);
+        ostream ps(&sink);
+        renderMaze(ps, ws.cells, nR, nC);
+        if (cache)
+            cache->put(key, CACHE_RENDER, make_shared<string>(out, sizeof(ResponseHeader)));
+        break;
+    }
+    }
+    patchPayloadSize(out);
+}
+
+// Builds the response for a random-maze request from a pooled maze
+void pooledResponse(const RequestHeader& req, const PooledMaze& maze, WorkerState& ws, string& out) {
+    const uint32_t nR = req.rows;
+    const uint32_t nC = req.cols;
+
+    out.clear();
+    appendResponseHeader(out, req.requestId, req.op, STATUS_OK, 0);
+    switch (req.op) {
+    case OP_GENERATE:
+        out += maze.cells;
+        break;
+    case OP_SOLVE: {
+        size_t base = out.size();
+        out += maze.cells;
+        for (uint32_t idx : maze.path)
+            out[base + idx] = static_cast<char>(out[base + idx] | VISITED);
+        break;
+    }
+    case OP_PATH:
+        out.append(reinterpret_cast<const char*>(maze.path.data()), maze.path.size() * sizeof(uint32_t));
+        break;
+    case OP_RENDER:
+        if (!maze.rendered.empty()) {
+            out += maze.rendered;
+        } else {
+            for (uint32_t r = 0; r < nR; ++r)
+                memcpy(ws.cells[r], maze.cells.data() + r * nC, nC);
+            for (uint32_t idx : maze.path)
+                ws.cells[idx / nC][idx % nC] |= VISITED;
+            TraceSpan span("render");
+            StringSink sink(out);
+            ostream ps(&sink);
+            renderMaze(ps, ws.cells, nR, nC);
+        }
+        break;
+    }
+    patchPayloadSize(out);
+}
+
+// Answers one request; runs as a scheduler task
+Completion runJob(Job job, WorkerState& ws, MazeCache* cache, MazePool* pool) {
+    Completion done;
+    done.connId = job.connId;
+    if (job.queuedNs != 0)
+        recordTraceSpan("queue_wait", "task", job.queuedNs, traceClockNs());
+    TraceSpan span("job");
+    try {
+        if (job.request.flags & PROTO_FLAG_RANDOM) {
+            unique_ptr<PooledMaze> pooled = pool ? pool->take(job.request.rows, job.request.cols) : nullptr;
+            if (pooled) {
+                pooledResponse(job.request, *pooled, ws, done.bytes);
+            } else {
+                // Pool miss: pick a seed here; one-off mazes are not worth caching
+                job.request.seed = static_cast<uint32_t>(ws.seedSource());
+                processRequest(job.request, ws, nullptr, done.bytes);
+            }
+        } else {
+            processRequest(job.request, ws, cache, done.bytes);
+        }
+    } catch (const exception&) {
+        done.bytes = errorResponse(job.request, STATUS_INTERNAL_ERROR);
+    }
+    return done;
+}
+
+//-----------------------------------------------------------------------------
+// Connections
+//-----------------------------------------------------------------------------
+struct Connection {
+    int fd;
+    string in;         // Partial request bytes
+    string out;        // Unsent response bytes
+    size_t outOffset;  // Bytes of out already sent
+    bool reading;      // EPOLLIN currently registered
+};
+
+bool validRequest(const RequestHeader& req) {
+    return req.op >= OP_GENERATE && req.op <= OP_RENDER && (req.flags & ~PROTO_FLAG_RANDOM) == 0 &&
+           req.rows >= 1 && req.rows <= MAX_ROWS && req.cols >= 1 && req.cols <= MAX_COLS;
+}
+
+class Server {
+public:
+    Server(const ServerOptions& opts, TaskScheduler& scheduler)
+        : options(opts), scheduler(scheduler),
+          listenFd(-1), epollFd(-1), signalFd(-1), wakeupFd(-1),
+          nextConnId(FIRST_CONN_ID), inFlight(0), shuttingDown(false),
+          served(0), rejectedBusy(0), jobs(scheduler) {}
+
+    ~Server() {
+        for (auto& entry : connections)
+            ::close(entry.second.fd);
+        if (listenFd >= 0) {
+            ::close(listenFd);
+            unlink(options.socketPath.c_str());
+        }
+        if (signalFd >= 0)
+            ::close(signalFd);
+        if (wakeupFd >= 0)
+            ::close(wakeupFd);
+        if (epollFd >= 0)
+            ::close(epollFd);
+    }
+
+    int run();
+
+private:
+    bool setup();
+    void acceptConnections();
+    void readConnection(uint64_t id, Connection& conn);
+    void flushConnection(uint64_t id, Connection& conn);
+    void updateInterest(uint64_t id, Connection& conn);
+    void closeConnection(uint64_t id);
+    void handleRequest(uint64_t id, Connection& conn, const RequestHeader& req);
+    void submitJob(const Job& job);
+    void drainCompletions();
+    void beginShutdown();
+    bool outputPending() const;
+    string statsText() const;
+
+    ServerOptions options;
+    TaskScheduler& scheduler;
+    unique_ptr<MazeCache> cache; // Null when caching is disabled
+    unique_ptr<MazePool> pool;   // Null when pooling is disabled
+    CompletionList completions;
+    vector<unique_ptr<WorkerState>> workerStates; // Indexed by currentWorker(), epoll thread last
+    unordered_map<uint64_t, Connection> connections;
+    vector<Completion> drained;
+    int listenFd;
+    int epollFd;
+    int signalFd;
+    int wakeupFd;
+    uint64_t nextConnId;
+    size_t inFlight; // Requests queued or being processed
+    bool shuttingDown;
+    uint64_t served;
+    uint64_t rejectedBusy;
+    TaskGroup jobs; // Last, so it is waited for before anything its tasks use goes away
+};
+
+bool Server::setup() {
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (options.socketPath.empty() || options.socketPath.size() >= sizeof(addr.sun_path)) {
+        cerr << "Error: socket path must be 1-" << sizeof(addr.sun_path) - 1 << " characters." << endl;
+        return false;
+    }
+    memcpy(addr.sun_path, options.socketPath.c_str(), options.socketPath.size());
+
+    // SIGINT/SIGTERM are delivered through a signalfd, so they are blocked
+    // here on the server thread. The TaskScheduler workers already run by
+    // now and do not inherit this mask; they block these signals themselves
+    // in workerLoop.
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGINT);
+    sigaddset(&mask, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &mask, nullptr);
+    signal(SIGPIPE, SIG_IGN);
+
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    signalFd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+    wakeupFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (epollFd < 0 || signalFd < 0 || wakeupFd < 0 || listenFd < 0) {
+        cerr << "Error: cannot create server descriptors: " << strerror(errno) << endl;
+        return false;
+    }
+
+    unlink(options.socketPath.c_str()); // Remove a stale socket from a previous run
+    if (bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || listen(listenFd, SOMAXCONN) < 0) {
+        cerr << "Error: cannot listen on " << options.socketPath << ": " << strerror(errno) << endl;
+        ::close(listenFd);
+        listenFd = -1;
+        return false;
+    }
+
+    completions.setWakeupFd(wakeupFd);
+
+    epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.u64 = TAG_LISTEN;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &ev);
+    ev.data.u64 = TAG_SIGNAL;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, signalFd, &ev);
+    ev.data.u64 = TAG_WAKEUP;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeupFd, &ev);
+    return true;
+}
+
+void Server::acceptConnections() {
+    while (true) {
+        int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+                cerr << "Warning: accept failed: " << strerror(errno) << endl;
+            return;
+        }
+        uint64_t id = nextConnId++;
+        Connection& conn = connections[id];
+        conn.fd = fd;
+        conn.outOffset = 0;
+        conn.reading = true;
+
+        epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.u64 = id;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev);
+    }
+}
+
+void Server::handleRequest(uint64_t id, Connection& conn, const RequestHeader& req) {
+    if (req.op == OP_STATS) {
+        // Answered inline; metrics must stay readable when the queue is full
+        string text = statsText();
+        appendResponseHeader(conn.out, req.requestId, req.op, STATUS_OK, static_cast<uint32_t>(text.size()));
+        conn.out += text;
+    } else if (shuttingDown) {
+        conn.out += errorResponse(req, STATUS_SHUTTING_DOWN);
+    } else if (!validRequest(req)) {
+        conn.out += errorResponse(req, STATUS_BAD_REQUEST);
+    } else if (inFlight < options.queueCapacity) {
+        ++inFlight;
+        submitJob(Job{id, req, tracingEnabled() ? traceClockNs() : 0});
+    } else {
+        ++rejectedBusy;
+        conn.out += errorResponse(req, STATUS_BUSY);
+    }
+}
+
+void Server::submitJob(const Job& job) {
+    jobs.run([this, job] {
+        int worker = scheduler.currentWorker();
+        WorkerState& ws = *workerStates[worker >= 0 ? worker : scheduler.threadCount()];
+        completions.push(runJob(job, ws, cache.get(), pool.get()));
+    });
+}
+
+void Server::readConnection(uint64_t id, Connection& conn) {
+    char buf[16384];
+    while (true) {
+        ssize_t n = recv(conn.fd, buf, sizeof(buf), 0);
+        if (n > 0) {
+            conn.in.append(buf, static_cast<size_t>(n));
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            break;
+        if (n < 0 && errno == EINTR)
+            continue;
+        closeConnection(id); // EOF or hard error
+        return;
+    }
+
+    size_t offset = 0;
+    while (conn.in.size() - offset >= sizeof(RequestHeader)) {
+        RequestHeader req = decodeRequest(conn.in.data() + offset);
+        if (req.magic != PROTO_REQUEST_MAGIC) {
+            closeConnection(id); // Out of sync; nothing sensible to reply
+            return;
+        }
+        handleRequest(id, conn, req);
+        offset += sizeof(RequestHeader);
+    }
+    conn.in.erase(0, offset);
+    flushConnection(id, conn);
+}
+
+void Server::flushConnection(uint64_t id, Connection& conn) {
+    TraceSpan span(conn.outOffset < conn.out.size() ? "write" : nullptr);
+    while (conn.outOffset < conn.out.size()) {
+        ssize_t n = send(conn.fd, conn.out.data() + conn.outOffset, conn.out.size() - conn.outOffset, MSG_NOSIGNAL);
+        if (n > 0) {
+            conn.outOffset += static_cast<size_t>(n);
+            continue;
+        }
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            break;
+        closeConnection(id);
+        return;
+    }
+    if (conn.outOffset == conn.out.size()) {
+        conn.out.clear();
+        conn.outOffset = 0;
+    }
+    updateInterest(id, conn);
+}
+
+// Re-register EPOLLIN/EPOLLOUT to match what the connection is waiting for
+void Server::updateInterest(uint64_t id, Connection& conn) {
+    bool wantRead = !shuttingDown && conn.out.size() - conn.outOffset < MAX_PENDING_OUTPUT;
+    bool wantWrite = conn.outOffset < conn.out.size();
+    epoll_event ev;
+    ev.events = (wantRead ? EPOLLIN : 0u) | (wantWrite ? EPOLLOUT : 0u);
+    ev.data.u64 = id;
+    epoll_ctl(epollFd, EPOLL_CTL_MOD, conn.fd, &ev);
+    conn.reading = wantRead;
+}
+
+void Server::closeConnection(uint64_t id) {
+    auto it = connections.find(id);
+    if (it == connections.end())
+        return;
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, it->second.fd, nullptr);
+    ::close(it->second.fd);
+    connections.erase(it);
+}
+
+void Server::drainCompletions() {
+    uint64_t counter;
+    while (read(wakeupFd, &counter, sizeof(counter)) > 0) {
+    }
+
+    drained.clear();
+    completions.drain(drained);
+    for (auto& done : drained) {
+        --inFlight;
+        ++served;
+        auto it = connections.find(done.connId);
+        if (it == connections.end())
+            continue; // Client went away while the request was running
+        it->second.out += done.bytes;
+        flushConnection(done.connId, it->second);
+    }
+}
+
+void Server::beginShutdown() {
+    if (shuttingDown)
+        return;
+    shuttingDown = true;
+    cout << "Shutting down: finishing " << inFlight << " queued request(s)..." << endl;
+
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, listenFd, nullptr);
+    ::close(listenFd);
+    listenFd = -1;
+    unlink(options.socketPath.c_str());
+
+    // Stop reading new requests; anything already buffered is still answered
+    vector<uint64_t> ids;
+    for (auto& entry : connections)
+        ids.push_back(entry.first);
+    for (uint64_t id : ids)
+        updateInterest(id, connections[id]);
+}
+
+string Server::statsText() const {
+    string text;
+    auto line = [&text](const string& name, uint64_t value) {
+        text += name + " " + to_string(value) + "\n";
+    };
+    line("served", served);
+    line("rejected_busy", rejectedBusy);
+    line("in_flight", inFlight);
+    line("connections", connections.size());
+    if (cache) {
+        MazeCacheStats stats = cache->stats();
+        line("cache_memory_hits", stats.memoryHits);
+        line("cache_disk_hits", stats.diskHits);
+        line("cache_misses", stats.misses);
+        line("cache_evictions", stats.evictions);
+        line("cache_memory_bytes", stats.memoryBytes);
+    }
+    if (pool) {
+        uint64_t hits = 0, misses = 0, produced = 0;
+        for (const MazePoolStats& s : pool->stats()) {
+            string size = to_string(s.rows) + "x" + to_string(s.cols);
+            line("pool_hits{" + size + "}", s.hits);
+            line("pool_misses{" + size + "}", s.misses);
+            line("pool_ready{" + size + "}", static_cast<uint64_t>(s.ready > 0 ? s.ready : 0));
+            hits += s.hits;
+            misses += s.misses;
+            produced += s.produced;
+        }
+        line("pool_hits", hits);
+        line("pool_misses", misses);
+        line("pool_produced", produced);
+    }
+    return text;
+}
+
+bool Server::outputPending() const {
+    for (const auto& entry : connections)
+        if (entry.second.outOffset < entry.second.out.size())
+            return true;
+    return false;
+}
+
+int Server::run() {
+    if (!setup())
+        return 1;
+
+    if (options.cacheBytes > 0 || !options.cacheDir.empty())
+        cache.reset(new MazeCache(options.cacheBytes, options.cacheDir));
+    if (options.poolEnabled)
+        pool.reset(new MazePool(options.pool, scheduler));
+
+    for (unsigned i = 0; i <= scheduler.threadCount(); ++i) {
+        workerStates.emplace_back(new WorkerState);
+        workerStates.back()->seedSource.seed(random_device()());
+    }
+
+    cout << "Serving on " << options.socketPath << " with " << scheduler.threadCount()
+         << (scheduler.pinned() ? " pinned" : "") << " worker(s), queue capacity "
+         << options.queueCapacity << endl;
+
+    chrono::steady_clock::time_point drainDeadline;
+    epoll_event events[64];
+    while (true) {
+        int timeoutMs = -1;
+        if (shuttingDown) {
+            if (inFlight == 0 && !outputPending())
+                break;
+            auto left = chrono::duration_cast<chrono::milliseconds>(drainDeadline - chrono::steady_clock::now()).count();
+            if (left <= 0) {
+                cerr << "Warning: shutdown drain timed out; dropping unsent responses." << endl;
+                break;
+            }
+            timeoutMs = static_cast<int>(left);
+        }
+
+        int n = epoll_wait(epollFd, events, 64, timeoutMs);
+        if (n < 0 && errno != EINTR) {
+            cerr << "Error: epoll_wait failed: " << strerror(errno) << endl;
+            break;
+        }
+
+        for (int i = 0; i < n; ++i) {
+            uint64_t tag = events[i].data.u64;
+            if (tag == TAG_LISTEN) {
+                acceptConnections();
+            } else if (tag == TAG_SIGNAL) {
+                signalfd_siginfo info;
+                while (read(signalFd, &info, sizeof(info)) == static_cast<ssize_t>(sizeof(info))) {
+                }
+                beginShutdown();
+                drainDeadline = chrono::steady_clock::now() + chrono::milliseconds(SHUTDOWN_DRAIN_MS);
+            } else if (tag == TAG_WAKEUP) {
+                drainCompletions();
+            } else {
+                auto it = connections.find(tag);
+                if (it == connections.end())
+                    continue;
+                if (events[i].events & EPOLLOUT)
+                    flushConnection(tag, it->second);
+                it = connections.find(tag);
+                if (it != connections.end() && (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)))
+                    readConnection(tag, it->second);
+            }
+        }
+    }
+
+    jobs.wait();
+
+    cout << "Server stopped: " << served << " request(s) served, "
+         << rejectedBusy << " rejected as busy." << endl;
+    if (pool) {
+        uint64_t hits = 0, misses = 0;
+        for (const MazePoolStats& s : pool->stats()) {
+            hits += s.hits;
+            misses += s.misses;
+        }
+        cout << "Pool: " << hits << " hit(s), " << misses << " miss(es)." << endl;
+    }
+    if (cache) {
+        MazeCacheStats stats = cache->stats();
+        cout << "Cache: " << stats.memoryHits << " memory hit(s), " << stats.diskHits
+             << " disk hit(s), " << stats.misses << " miss(es), " << stats.evictions
+             << " eviction(s), " << stats.memoryBytes << " bytes in memory." << endl;
+    }
+    return 0;
+}
+
+} // namespace
+
+int runServer(const ServerOptions& options, TaskScheduler& scheduler) {
+    Server server(options, scheduler);
+    return server.run();
+}
@@ -0,0 +1,30 @@
+//
+// Long-running local maze server (`pathfinder --serve <socket>`).
+// Speaks the protocol in hexmaze_protocol.h over a Unix domain socket.
+//
+
+#ifndef HEXMAZE_SERVER_H
+#define HEXMAZE_SERVER_H
+
+#include <cstddef>
+#include <string>
+
+#include "hexmaze_pool.h"
+#include "hexmaze_scheduler.h"
+
+struct ServerOptions {
+    std::string socketPath;
+    size_t queueCapacity = 1024; // Requests in flight beyond this are answered STATUS_BUSY
+    size_t cacheBytes = 0;       // In-memory result cache size (0 = none)
+    std::string cacheDir;        // On-disk result cache directory ("" = none)
+    bool poolEnabled = false;    // Serve PROTO_FLAG_RANDOM requests from a MazePool
+    MazePoolOptions pool;
+};
+
+// Serves until SIGINT or SIGTERM, then stops accepting, finishes queued
+// requests, flushes pending responses and removes the socket file.
+// Requests (and pool refills) run on scheduler's threads. Returns a process
+// exit code.
+int runServer(const ServerOptions& options, TaskScheduler& scheduler);
+
+#endif // HEXMAZE_SERVER_H
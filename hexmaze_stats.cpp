@@ -0,0 +1,231 @@
+//
+// Counter registry and --stats reports (see hexmaze_stats.h).
+//
+
+#include <algorithm>
+#include <iomanip>
+#include <mutex>
+#include <vector>
+
+#include <sys/resource.h>
+
+#include "hexmaze_stats.h"
+#include "hexmaze_probes.h"
+#include "hexmaze_trace.h"
+
+using namespace std;
+
+namespace {
+
+const char* COUNTER_NAMES[STAT_COUNTER_COUNT] = {
+    "dsu_finds", "dsu_find_hops", "walls_examined", "walls_removed",
+    "bfs_pushes", "cells_visited", "path_cells", "segments_drawn"
+};
+
+const char* PHASE_NAMES[PHASE_COUNT] = {"generate", "solve", "render", "write"};
+
+// Every block ever handed out; blocks are never freed, so a thread that has
+// exited still counts
+mutex registryLock;
+vector<CounterBlock*>& registry() {
+    static vector<CounterBlock*>* blocks = new vector<CounterBlock*>;
+    return *blocks;
+}
+
+// Allocation totals; plain atomics, since the hooks may run before any
+// constructor and after every destructor
+atomic<uint64_t> allocations(0);
+atomic<uint64_t> frees(0);
+atomic<uint64_t> allocatedBytes(0);
+atomic<uint64_t> liveBytes(0);
+atomic<uint64_t> peakBytes(0);
+atomic<bool> hooksActive(false);
+
+double quotient(uint64_t a, uint64_t b) {
+    return b == 0 ? 0.0 : static_cast<double>(a) / static_cast<double>(b);
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+// Counters
+//-----------------------------------------------------------------------------
+CounterBlock* newCounterBlock() {
+    CounterBlock* block = new CounterBlock;
+    for (int i = 0; i < STAT_COUNTER_COUNT; ++i)
+        block->values[i].store(0, memory_order_relaxed);
+    lock_guard<mutex> lock(registryLock);
+    registry().push_back(block);
+    return block;
+}
+
+bool countersEnabled() {
+#ifdef HEXMAZE_STATS
+    return true;
+#else
+    return false;
+#endif
+}
+
+CounterTotals collectCounters() {
+    CounterTotals totals = {};
+    lock_guard<mutex> lock(registryLock);
+    for (CounterBlock* block : registry())
+        for (int i = 0; i < STAT_COUNTER_COUNT; ++i)
+            totals.values[i] += block->values[i].load(memory_order_relaxed);
+    return totals;
+}
+
+//-----------------------------------------------------------------------------
+// Allocation Tracking
+//-----------------------------------------------------------------------------
+void recordAllocation(size_t bytes) {
+    allocations.fetch_add(1, memory_order_relaxed);
+    allocatedBytes.fetch_add(bytes, memory_order_relaxed);
+    uint64_t live = liveBytes.fetch_add(bytes, memory_order_relaxed) + bytes;
+    uint64_t peak = peakBytes.load(memory_order_relaxed);
+    while (live > peak && !peakBytes.compare_exchange_weak(peak, live, memory_order_relaxed)) {
+    }
+}
+
+void recordFree(size_t bytes) {
+    frees.fetch_add(1, memory_order_relaxed);
+    liveBytes.fetch_sub(bytes, memory_order_relaxed);
+}
+
+AllocationTotals allocationTotals() {
+    AllocationTotals totals;
+    totals.allocations = allocations.load(memory_order_relaxed);
+    totals.frees = frees.load(memory_order_relaxed);
+    totals.bytes = allocatedBytes.load(memory_order_relaxed);
+    totals.liveBytes = liveBytes.load(memory_order_relaxed);
+    totals.peakBytes = peakBytes.load(memory_order_relaxed);
+    return totals;
+}
+
+void resetAllocationPeak() {
+    peakBytes.store(liveBytes.load(memory_order_relaxed), memory_order_relaxed);
+}
+
+bool allocationHooksActive() {
+    return hooksActive.load(memory_order_relaxed);
+}
+
+void activateAllocationHooks() {
+    hooksActive.store(true, memory_order_relaxed);
+}
+
+uint64_t peakRssBytes() {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+    return static_cast<uint64_t>(usage.ru_maxrss) * 1024; // Linux reports KiB
+}
+
+//-----------------------------------------------------------------------------
+// Phase Timers
+//-----------------------------------------------------------------------------
+StatsReport::StatsReport() : phases(), counters(), outputBytes(0), predictedPeakBytes(0) {
+    for (int p = 0; p < PHASE_COUNT; ++p)
+        phases[p].seconds = -1.0;
+}
+
+PhaseTimer::PhaseTimer(StatsReport& report, StatPhase phase)
+    : report(report), phase(phase), running(true), start(chrono::steady_clock::now()) {
+    resetAllocationPeak();
+    startAllocations = allocationTotals();
+    HEXMAZE_PROBE1(phase_start, phase);
+}
+
+void PhaseTimer::stop() {
+    if (!running)
+        return;
+    running = false;
+    chrono::steady_clock::time_point end = chrono::steady_clock::now();
+    chrono::steady_clock::duration elapsed = end - start;
+    if (tracingEnabled()) {
+        recordTraceSpan(PHASE_NAMES[phase], "phase",
+                        chrono::duration_cast<chrono::nanoseconds>(start.time_since_epoch()).count(),
+                        chrono::duration_cast<chrono::nanoseconds>(end.time_since_epoch()).count());
+    }
+    HEXMAZE_PROBE2(phase_end, phase, chrono::duration_cast<chrono::nanoseconds>(elapsed).count());
+    double seconds = chrono::duration<double>(elapsed).count();
+    AllocationTotals now = allocationTotals();
+    PhaseStats& stats = report.phases[phase];
+    stats.seconds = max(stats.seconds, 0.0) + seconds;
+    stats.allocations += now.allocations - startAllocations.allocations;
+    stats.allocatedBytes += now.bytes - startAllocations.bytes;
+    stats.peakHeapBytes = max(stats.peakHeapBytes, now.peakBytes);
+    stats.peakRssBytes = peakRssBytes();
+}
+
+//-----------------------------------------------------------------------------
+// Reports
+//-----------------------------------------------------------------------------
+void writeStatsText(ostream& out, const StatsReport& report) {
+    const uint64_t* v = report.counters.values;
+    ios::fmtflags flags = out.flags();
+    const bool allocs = allocationHooksActive();
+    out << left << setw(20) << "Phase" << right << setw(12) << "seconds" << setw(14) << "peak RSS";
+    if (allocs)
+        out << setw(12) << "allocs" << setw(14) << "bytes" << setw(14) << "peak heap";
+    out << endl << fixed << setprecision(6);
+    for (int p = 0; p < PHASE_COUNT; ++p) {
+        const PhaseStats& phase = report.phases[p];
+        if (phase.seconds < 0)
+            continue;
+        out << "  " << left << setw(18) << PHASE_NAMES[p] << right << setw(12) << phase.seconds
+            << setw(14) << phase.peakRssBytes;
+        if (allocs)
+            out << setw(12) << phase.allocations << setw(14) << phase.allocatedBytes << setw(14) << phase.peakHeapBytes;
+        out << endl;
+    }
+    if (!allocs)
+        out << "Allocations: not tracked in this build (make ALLOC_TRACKING=1)" << endl;
+    out << "Output bytes:       " << report.outputBytes << endl;
+    if (report.predictedPeakBytes != 0)
+        out << "Predicted peak:     " << report.predictedPeakBytes << endl;
+    if (!countersEnabled()) {
+        out << "Counters: disabled in this build (make STATS=1)" << endl;
+        out.flags(flags);
+        return;
+    }
+    out << "Counters:" << endl;
+    for (int i = 0; i < STAT_COUNTER_COUNT; ++i)
+        out << "  " << left << setw(18) << COUNTER_NAMES[i] << right << v[i] << endl;
+    out << setprecision(3);
+    out << "  avg find path     " << quotient(v[STAT_DSU_FIND_HOPS], v[STAT_DSU_FINDS]) << endl;
+    out << "  removed/examined  " << quotient(v[STAT_WALLS_REMOVED], v[STAT_WALLS_EXAMINED]) << endl;
+    out.flags(flags);
+}
+
+void writeStatsJson(ostream& out, const StatsReport& report) {
+    const uint64_t* v = report.counters.values;
+    ios::fmtflags flags = out.flags();
+    out << "{\"phases\":{" << fixed << setprecision(6);
+    bool first = true;
+    for (int p = 0; p < PHASE_COUNT; ++p) {
+        const PhaseStats& phase = report.phases[p];
+        if (phase.seconds < 0)
+            continue;
+        out << (first ? "" : ",") << "\"" << PHASE_NAMES[p] << "\":{\"seconds\":" << phase.seconds
+            << ",\"peak_rss_bytes\":" << phase.peakRssBytes;
+        if (allocationHooksActive())
+            out << ",\"allocations\":" << phase.allocations << ",\"allocated_bytes\":" << phase.allocatedBytes
+                << ",\"peak_heap_bytes\":" << phase.peakHeapBytes;
+        out << "}";
+        first = false;
+    }
+    out << "},\"allocations_tracked\":" << (allocationHooksActive() ? "true" : "false") << ",\"output_bytes\":" << report.outputBytes
+        << ",\"predicted_peak_bytes\":" << report.predictedPeakBytes << ",\"counters\":";
+    if (!countersEnabled()) {
+        out << "null}" << endl;
+        out.flags(flags);
+        return;
+    }
+    out << "{";
+    for (int i = 0; i < STAT_COUNTER_COUNT; ++i)
+        out << (i ? "," : "") << "\"" << COUNTER_NAMES[i] << "\":" << v[i];
+    out << ",\"avg_find_path\":" << quotient(v[STAT_DSU_FIND_HOPS], v[STAT_DSU_FINDS]) << "}}" << endl;
+    out.flags(flags);
+}
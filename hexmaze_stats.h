@@ -0,0 +1,154 @@
+//
+// Hot-path counters and phase timers behind `pathfinder --stats`.
+//
+// Counters are bumped with HEXMAZE_COUNT(counter, n) in the generator,
+// solver and renderer. They only exist in builds with HEXMAZE_STATS defined
+// (`make STATS=1`); otherwise the macro expands to nothing and the hot
+// paths compile exactly as before.
+//
+// Each thread counts into its own block, so counting never contends: the
+// update is a relaxed load and store on a cache line no other thread
+// writes. collectCounters() sums every block a thread has ever used.
+//
+// Phase timers (PhaseTimer) measure wall-clock time and peak RSS of each
+// phase in every build. When the binary links the allocation hooks
+// (hexmaze_alloc_hooks.cpp, `make ALLOC_TRACKING=1`), they also record the
+// heap allocations, bytes and peak heap use of the phase.
+//
+
+#ifndef HEXMAZE_STATS_H
+#define HEXMAZE_STATS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+enum StatCounter {
+    STAT_DSU_FINDS = 0,
+    STAT_DSU_FIND_HOPS,      // Parent links followed to reach the root
+    STAT_WALLS_EXAMINED,     // Candidate walls generateMaze looked at
+    STAT_WALLS_REMOVED,
+    STAT_BFS_PUSHES,
+    STAT_CELLS_VISITED,      // Cells the BFS expanded
+    STAT_PATH_CELLS,         // Cells on traced solution paths
+    STAT_SEGMENTS_DRAWN,     // PostScript line segments
+    STAT_COUNTER_COUNT
+};
+
+enum StatPhase {
+    PHASE_GENERATE = 0,
+    PHASE_SOLVE,
+    PHASE_RENDER,
+    PHASE_WRITE,
+    PHASE_COUNT
+};
+
+struct CounterBlock {
+    std::atomic<uint64_t> values[STAT_COUNTER_COUNT];
+    char pad[64]; // Keeps the next thread's block off this one's last line
+
+    void add(StatCounter counter, uint64_t n) {
+        std::atomic<uint64_t>& value = values[counter];
+        value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+};
+
+// Allocates and registers a block for the calling thread; blocks live until
+// the process exits so their counts outlast the thread
+CounterBlock* newCounterBlock();
+
+inline CounterBlock& threadCounters() {
+    static thread_local CounterBlock* block = nullptr;
+    if (!block)
+        block = newCounterBlock();
+    return *block;
+}
+
+#ifdef HEXMAZE_STATS
+#define HEXMAZE_COUNT(counter, n) threadCounters().add(counter, n)
+#define HEXMAZE_STATS_ONLY(code) code
+#else
+#define HEXMAZE_COUNT(counter, n) ((void)0)
+#define HEXMAZE_STATS_ONLY(code)
+#endif
+
+// True if this build counts (HEXMAZE_STATS)
+bool countersEnabled();
+
+// Sums of every thread's counters
+struct CounterTotals {
+    uint64_t values[STAT_COUNTER_COUNT];
+};
+CounterTotals collectCounters();
+
+//-----------------------------------------------------------------------------
+// Allocation Tracking
+// Sizes are what malloc_usable_size reports, so frees balance allocations.
+//-----------------------------------------------------------------------------
+struct AllocationTotals {
+    uint64_t allocations;
+    uint64_t frees;
+    uint64_t bytes;     // Allocated in all
+    uint64_t liveBytes; // Allocated and not yet freed
+    uint64_t peakBytes; // Highest liveBytes since the last resetAllocationPeak()
+};
+
+void recordAllocation(size_t bytes);
+void recordFree(size_t bytes);
+AllocationTotals allocationTotals();
+void resetAllocationPeak();
+
+// True if the binary links the global operator new hooks, which call
+// activateAllocationHooks() during static initialization
+bool allocationHooksActive();
+void activateAllocationHooks();
+
+// Peak resident set size of the process so far, in bytes
+uint64_t peakRssBytes();
+
+//-----------------------------------------------------------------------------
+// Reports
+//-----------------------------------------------------------------------------
+struct PhaseStats {
+    double seconds;         // Negative if the phase did not run
+    uint64_t allocations;
+    uint64_t allocatedBytes;
+    uint64_t peakHeapBytes; // Highest live heap during the phase
+    uint64_t peakRssBytes;  // Process peak RSS at the end of the phase
+};
+
+// What --stats prints: the phases, the counters and the bytes written
+struct StatsReport {
+    PhaseStats phases[PHASE_COUNT];
+    CounterTotals counters;
+    uint64_t outputBytes;
+    uint64_t predictedPeakBytes; // From hexmaze_footprint.h; 0 = not predicted
+
+    StatsReport();
+};
+
+// Times a phase from construction to stop() (or destruction) and adds it to
+// the report, so a phase run in several pieces accumulates
+class PhaseTimer {
+public:
+    PhaseTimer(StatsReport& report, StatPhase phase);
+    ~PhaseTimer() { stop(); }
+    void stop();
+
+private:
+    StatsReport& report;
+    StatPhase phase;
+    bool running;
+    std::chrono::steady_clock::time_point start;
+    AllocationTotals startAllocations;
+
+    PhaseTimer(const PhaseTimer&);
+    PhaseTimer& operator=(const PhaseTimer&);
+};
+
+void writeStatsText(std::ostream& out, const StatsReport& report);
+void writeStatsJson(std::ostream& out, const StatsReport& report);
+
+#endif // HEXMAZE_STATS_H
@@ -0,0 +1,108 @@
+//
+// Per-thread span rings and the Chrome trace-event writer (see
+// hexmaze_trace.h).
+//
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <mutex>
+#include <vector>
+
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "hexmaze_trace.h"
+
+using namespace std;
+
+atomic<bool> tracingOn(false);
+
+namespace {
+
+struct TraceEvent {
+    const char* name;
+    const char* category;
+    uint64_t startNs;
+    uint64_t durationNs;
+};
+
+// Written only by its thread; head counts every span ever recorded, so
+// span i lives in events[i % TRACE_RING_SPANS]
+struct TraceRing {
+    TraceEvent events[TRACE_RING_SPANS];
+    atomic<uint64_t> head;
+    long tid;
+
+    TraceRing() : head(0), tid(syscall(SYS_gettid)) {}
+};
+
+// Rings are never freed, so spans of threads that have exited still get
+// written
+mutex registryLock;
+vector<TraceRing*>& registry() {
+    static vector<TraceRing*>* rings = new vector<TraceRing*>;
+    return *rings;
+}
+
+uint64_t traceStartNs = 0;
+
+TraceRing& threadRing() {
+    static thread_local TraceRing* ring = nullptr;
+    if (!ring) {
+        ring = new TraceRing;
+        lock_guard<mutex> lock(registryLock);
+        registry().push_back(ring);
+    }
+    return *ring;
+}
+
+} // namespace
+
+void startTracing() {
+    traceStartNs = traceClockNs();
+    tracingOn.store(true, memory_order_relaxed);
+}
+
+uint64_t traceClockNs() {
+    return static_cast<uint64_t>(
+        chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void recordTraceSpan(const char* name, const char* category, uint64_t startNs, uint64_t endNs) {
+    if (!tracingEnabled())
+        return;
+    TraceRing& ring = threadRing();
+    uint64_t h = ring.head.load(memory_order_relaxed);
+    TraceEvent& e = ring.events[h % TRACE_RING_SPANS];
+    e.name = name;
+    e.category = category;
+    e.startNs = startNs;
+    e.durationNs = endNs - startNs;
+    ring.head.store(h + 1, memory_order_release);
+}
+
+uint64_t writeChromeTrace(ostream& out) {
+    const long pid = getpid();
+    uint64_t written = 0, dropped = 0;
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << pid << ",\"tid\":" << pid
+        << ",\"args\":{\"name\":\"pathfinder\"}}";
+    out << fixed << setprecision(3);
+
+    lock_guard<mutex> lock(registryLock);
+    for (TraceRing* ring : registry()) {
+        const uint64_t head = ring->head.load(memory_order_acquire);
+        const uint64_t first = head > TRACE_RING_SPANS ? head - TRACE_RING_SPANS : 0;
+        dropped += first;
+        for (uint64_t i = first; i < head; ++i) {
+            const TraceEvent& e = ring->events[i % TRACE_RING_SPANS];
+            double ts = (static_cast<double>(e.startNs) - static_cast<double>(traceStartNs)) / 1000.0;
+            out << ",\n{\"name\":\"" << e.name << "\",\"cat\":\"" << e.category << "\",\"ph\":\"X\",\"ts\":" << ts
+                << ",\"dur\":" << e.durationNs / 1000.0 << ",\"pid\":" << pid << ",\"tid\":" << ring->tid << "}";
+            ++written;
+        }
+    }
+    out << "\n],\"otherData\":{\"dropped_spans\":" << dropped << "}}\n";
+    return written;
+}
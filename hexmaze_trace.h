@@ -0,0 +1,65 @@
+//
+// Span tracing exported as Chrome trace-event JSON, for Perfetto or
+// chrome://tracing (`pathfinder --trace FILE`).
+//
+// Each thread records complete spans (name, start, duration) into its own
+// fixed-size ring, so recording takes no lock and never allocates after the
+// thread's first span: two clock reads and a few stores. When a ring fills
+// up the oldest spans are overwritten and counted as dropped. Nothing is
+// recorded until startTracing() is called.
+//
+// writeChromeTrace() is meant to run once the traced work has finished; a
+// span recorded while it runs may or may not make it into the file.
+//
+
+#ifndef HEXMAZE_TRACE_H
+#define HEXMAZE_TRACE_H
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+
+// Spans each thread keeps before overwriting its oldest
+const uint32_t TRACE_RING_SPANS = 1 << 16;
+
+extern std::atomic<bool> tracingOn;
+
+inline bool tracingEnabled() {
+    return tracingOn.load(std::memory_order_relaxed);
+}
+
+void startTracing();
+
+// Nanoseconds on the trace clock (steady_clock)
+uint64_t traceClockNs();
+
+// Records a span on the calling thread's ring. name and category must be
+// string literals (or otherwise outlive the trace).
+void recordTraceSpan(const char* name, const char* category, uint64_t startNs, uint64_t endNs);
+
+// Records the span from construction to destruction; a null name records
+// nothing
+class TraceSpan {
+public:
+    explicit TraceSpan(const char* name, const char* category = "task")
+        : name(name), category(category), startNs(name && tracingEnabled() ? traceClockNs() : 0) {}
+
+    ~TraceSpan() {
+        if (startNs != 0)
+            recordTraceSpan(name, category, startNs, traceClockNs());
+    }
+
+private:
+    const char* name;
+    const char* category;
+    uint64_t startNs;
+
+    TraceSpan(const TraceSpan&);
+    TraceSpan& operator=(const TraceSpan&);
+};
+
+// Writes every thread's spans as a Chrome trace-event JSON object; returns
+// the number of spans written
+uint64_t writeChromeTrace(std::ostream& out);
+
+#endif // HEXMAZE_TRACE_H
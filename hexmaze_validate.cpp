@@ -0,0 +1,243 @@
+//
+// Perfect-maze validation (see hexmaze_validate.h).
+//
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "hexmaze_validate.h"
+#include "hexmaze_kernels.h"
+#include "hexmaze_parallel.h"
+
+using namespace std;
+
+namespace {
+
+const uint8_t WALLS[6] = {WALL_UP, WALL_UP_RIGHT, WALL_DOWN_RIGHT, WALL_DOWN, WALL_DOWN_LEFT, WALL_UP_LEFT};
+const uint8_t OWNED = WALL_DOWN | WALL_UP_RIGHT | WALL_DOWN_RIGHT;
+
+struct BandResult {
+    uint64_t passages;
+    uint64_t asymmetricCells;
+    uint64_t borderBreaches;
+    uint64_t unions; // Joins of two components
+};
+
+struct Rows {
+    const uint8_t* cells;
+    uint32_t nR;
+    uint32_t nC;
+    size_t stride;
+
+    const uint8_t* row(uint32_t r) const { return cells + r * stride; }
+};
+
+// Union-find over cell numbers with Rem's algorithm: every parent is at
+// most its child, and a union splices the two paths together as it climbs
+// them, so neither needs a separate find. Cells are joined in row-major
+// order, so the later cell is usually still alone and is linked in one step.
+// Links only ever point at cells already on one of the two paths, so a
+// band's sets stay inside the band until the bands are joined.
+template <class Index>
+inline bool join(Index* parent, Index a, Index b) {
+    while (parent[a] != parent[b]) {
+        if (parent[a] > parent[b]) {
+            if (parent[a] == a) {
+                parent[a] = parent[b];
+                return true;
+            }
+            Index next = parent[a];
+            parent[a] = parent[b];
+            a = next;
+        } else {
+            if (parent[b] == b) {
+                parent[b] = parent[a];
+                return true;
+            }
+            Index next = parent[b];
+            parent[b] = parent[a];
+            b = next;
+        }
+    }
+    return false;
+}
+
+// Wall by wall, for cells on the border (and grids too narrow for the kernel)
+void checkCell(const Rows& m, uint32_t r, uint32_t c, BandResult& out) {
+    const uint8_t cell = m.row(r)[c];
+    bool asymmetric = false, breach = false;
+    for (uint8_t wall : WALLS) {
+        uint32_t r2, c2;
+        if (!getNeighbor(r, c, wall, m.nR, m.nC, r2, c2)) {
+            breach = breach || !(cell & wall);
+            continue;
+        }
+        if (!(wall & OWNED))
+            continue;
+        asymmetric = asymmetric || ((cell & wall) != 0) != ((m.row(r2)[c2] & getOppositeWall(wall)) != 0);
+        out.passages += !(cell & wall);
+    }
+    out.asymmetricCells += asymmetric;
+    out.borderBreaches += breach;
+}
+
+const uint64_t ODD_COLUMNS = 0xAAAAAAAAAAAAAAAAull; // Bit c of a 64-column word
+
+// Joins cell i + c with i + c + step for every bit c of bits
+template <class Index>
+inline uint64_t joinBits(Index* parent, Index i, Index step, uint64_t bits) {
+    uint64_t unions = 0;
+    for (; bits; bits &= bits - 1) {
+        const Index a = i + static_cast<Index>(__builtin_ctzll(bits));
+        unions += join<Index>(parent, a, a + step);
+    }
+    return unions;
+}
+
+// As joinBits, with i + c - step
+template <class Index>
+inline uint64_t joinBitsUp(Index* parent, Index i, Index step, uint64_t bits) {
+    uint64_t unions = 0;
+    for (; bits; bits &= bits - 1) {
+        const Index a = i + static_cast<Index>(__builtin_ctzll(bits));
+        unions += join<Index>(parent, a, a - step);
+    }
+    return unions;
+}
+
+// Checks the cells of rows [r0, r1) and joins the passages between them
+template <class Index>
+void validateBand(const Rows& m, uint32_t r0, uint32_t r1, Index* parent, BandResult& out) {
+    const uint32_t nC = m.nC;
+    const size_t words = (nC + 63) / 64;
+    vector<uint64_t> down(words), upRight(words), downRight(words); // Walls present
+    Index first = static_cast<Index>(r0) * nC;
+    for (Index i = first; i < static_cast<Index>(r1) * nC; ++i)
+        parent[i] = i;
+
+    for (uint32_t r = r0; r < r1; ++r) {
+        const uint8_t* row = m.row(r);
+        if (r == 0 || r + 1 == m.nR || nC < 3) {
+            for (uint32_t c = 0; c < nC; ++c)
+                checkCell(m, r, c, out);
+        } else {
+            checkCell(m, r, 0, out);
+            out.asymmetricCells += asymmetricWalls(row - m.stride + 1, row + 1, row + m.stride + 1, nC - 2, 1,
+                                                   out.passages);
+            checkCell(m, r, nC - 1, out);
+        }
+
+        // Passages to cells below and to the right, staying inside the band,
+        // 64 columns at a time: bitmaps of the open walls, walked bit by bit,
+        // keep the branches off the cells themselves
+        flagBitmap(row, nC, WALL_DOWN, down.data());
+        flagBitmap(row, nC, WALL_UP_RIGHT, upRight.data());
+        flagBitmap(row, nC, WALL_DOWN_RIGHT, downRight.data());
+        const Index base = static_cast<Index>(r) * nC;
+        const uint64_t below = r + 1 < r1 ? ~0ull : 0, above = r > r0 ? ~0ull : 0;
+        for (size_t w = 0; w < words; ++w) {
+            const uint32_t c0 = static_cast<uint32_t>(w * 64);
+            // Columns that exist, and those with a column to their right
+            const uint64_t inGrid = nC - c0 >= 64 ? ~0ull : (1ull << (nC - c0)) - 1;
+            const uint64_t hasRight = nC - c0 > 64 ? ~0ull : (1ull << (nC - c0 - 1)) - 1;
+            const uint64_t ur = ~upRight[w] & hasRight, dr = ~downRight[w] & hasRight;
+            const Index i = base + c0;
+            out.unions += joinBits<Index>(parent, i, 1, (ur & ODD_COLUMNS) | (dr & ~ODD_COLUMNS));
+            out.unions += joinBits<Index>(parent, i, nC, ~down[w] & inGrid & below);
+            out.unions += joinBits<Index>(parent, i, static_cast<Index>(nC) + 1, dr & ODD_COLUMNS & below);
+            out.unions += joinBitsUp<Index>(parent, i, nC - 1, ur & ~ODD_COLUMNS & above);
+        }
+    }
+}
+
+// Passages across the edge between rows b - 1 and b; returns the joins made
+template <class Index>
+uint64_t joinBandEdge(const Rows& m, uint32_t b, Index* parent) {
+    const uint32_t nC = m.nC;
+    const uint8_t* up = m.row(b - 1);
+    const uint8_t* down = m.row(b);
+    const Index base = static_cast<Index>(b - 1) * nC;
+    uint64_t unions = 0;
+    for (uint32_t c = 0; c < nC; ++c) {
+        const Index i = base + c;
+        if (!(up[c] & WALL_DOWN))
+            unions += join<Index>(parent, i, i + nC);
+        if (c + 1 == nC)
+            continue;
+        if ((c & 1) && !(up[c] & WALL_DOWN_RIGHT))
+            unions += join<Index>(parent, i, i + nC + 1);
+        if (!(c & 1) && !(down[c] & WALL_UP_RIGHT))
+            unions += join<Index>(parent, i + nC, i + 1);
+    }
+    return unions;
+}
+
+// With a scheduler, bands run in parallel; without, one band on the caller
+template <class Index>
+MazeValidation validateRows(const Rows& m, TaskScheduler* scheduler) {
+    MazeValidation v = {};
+    v.cells = static_cast<uint64_t>(m.nR) * m.nC;
+    if (v.cells == 0)
+        return v;
+
+    const uint32_t bandRows = scheduler ? min(bandRowsFor(m.nR), m.nR) : m.nR;
+    const uint32_t bands = (m.nR + bandRows - 1) / bandRows;
+    unique_ptr<Index[]> parent(new Index[static_cast<size_t>(v.cells)]); // Bands fill in their own part
+    vector<BandResult> results(bands, BandResult());
+    auto run = [&](size_t lo, size_t hi) {
+        for (size_t b = lo; b < hi; ++b) {
+            uint32_t r0 = static_cast<uint32_t>(b) * bandRows;
+            validateBand<Index>(m, r0, min(m.nR, r0 + bandRows), parent.get(), results[b]);
+        }
+    };
+    if (scheduler)
+        parallelFor(*scheduler, 0, bands, 1, run);
+    else
+        run(0, bands);
+
+    uint64_t unions = 0;
+    for (uint32_t b = 1; b < bands; ++b)
+        unions += joinBandEdge<Index>(m, b * bandRows, parent.get());
+    for (const BandResult& r : results) {
+        v.passages += r.passages;
+        v.asymmetricCells += r.asymmetricCells;
+        v.borderBreaches += r.borderBreaches;
+        unions += r.unions;
+    }
+    v.components = v.cells - unions;
+    return v;
+}
+
+MazeValidation validate(const Rows& m, TaskScheduler* scheduler) {
+    if (fitsCellIndex<uint32_t>(m.nR, m.nC))
+        return validateRows<uint32_t>(m, scheduler);
+    return validateRows<uint64_t>(m, scheduler);
+}
+
+} // namespace
+
+MazeValidation validateMaze(const uint8_t* cells, uint32_t nR, uint32_t nC, size_t stride,
+                            TaskScheduler& scheduler) {
+    return validate(Rows{cells, nR, nC, stride}, &scheduler);
+}
+
+MazeValidation validateMaze(uint8_t maze[][MAX_COLS], uint32_t nR, uint32_t nC) {
+    return validate(Rows{maze[0], nR, nC, MAX_COLS}, nullptr);
+}
+
+void writeValidation(ostream& out, const MazeValidation& v) {
+    if (v.perfect()) {
+        out << "Perfect maze: " << v.cells << " cells, " << v.passages << " passages" << endl;
+        return;
+    }
+    if (v.asymmetricCells != 0)
+        out << "Walls disagree with a neighbor in " << v.asymmetricCells << " cells" << endl;
+    if (v.borderBreaches != 0)
+        out << "Outer border open in " << v.borderBreaches << " cells" << endl;
+    if (v.passages + 1 != v.cells)
+        out << v.passages << " passages for " << v.cells << " cells (a perfect maze has "
+            << (v.cells == 0 ? 0 : v.cells - 1) << ")" << endl;
+    if (v.components != 1)
+        out << v.components << " connected components" << endl;
+}
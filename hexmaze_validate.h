@@ -0,0 +1,66 @@
+//
+// Perfect-maze validation: the checks a maze has to pass before it ships.
+//
+//   symmetry    each wall agrees with the opposite wall of the cell behind it
+//   border      no opening leads out of the grid
+//   passages    exactly cells - 1 openings (each counted once), so no cycles
+//   connected   every cell reachable from every other
+//
+// Symmetry, border and passages come from one pass over the cells with the
+// asymmetricWalls kernel (see hexmaze_kernels.h); connectivity from a
+// union-find over the same rows, done band by band in parallel and joined
+// across band edges afterwards. Each band's union-find touches only its own
+// rows, so bands run at close to the speed the cells stream in.
+//
+// The checks only read the wall bits; VISITED and DEAD_END are ignored.
+//
+
+#ifndef HEXMAZE_VALIDATE_H
+#define HEXMAZE_VALIDATE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+#include "hexpathfinder.h"
+#include "hexmaze_scheduler.h"
+
+struct MazeValidation {
+    uint64_t cells;
+    uint64_t passages;        // Openings between two cells
+    uint64_t asymmetricCells; // Cells with a wall the neighbor behind it does not mirror
+    uint64_t borderBreaches;  // Cells with an opening in the outer border
+    uint64_t components;      // Connected components, following each cell's own walls
+
+    bool perfect() const {
+        return asymmetricCells == 0 && borderBreaches == 0 && components == 1 && passages + 1 == cells;
+    }
+};
+
+// Rows of cells owned elsewhere: row r starts at cells + r * stride
+MazeValidation validateMaze(const uint8_t* cells, uint32_t nR, uint32_t nC, size_t stride,
+                            TaskScheduler& scheduler);
+
+inline MazeValidation validateMaze(const MazeGrid& maze, TaskScheduler& scheduler) {
+    return validateMaze(maze.cells.data(), maze.nR, maze.nC, maze.nC, scheduler);
+}
+
+// On the calling thread, for the small fixed-size mazes of batches and the
+// catalog
+MazeValidation validateMaze(uint8_t maze[][MAX_COLS], uint32_t nR, uint32_t nC);
+
+// Any other accessor (PersistentMaze, SessionOverlay, ...): copied into a
+// MazeGrid first
+template <class Maze>
+MazeValidation validateMaze(const Maze& maze, TaskScheduler& scheduler) {
+    MazeGrid grid(maze.rows(), maze.cols());
+    for (uint32_t r = 0; r < grid.nR; ++r)
+        for (uint32_t c = 0; c < grid.nC; ++c)
+            grid.set(r, c, maze.get(r, c));
+    return validateMaze(grid, scheduler);
+}
+
+// One line per failed check, or "perfect maze"
+void writeValidation(std::ostream& out, const MazeValidation& v);
+
+#endif // HEXMAZE_VALIDATE_H
@@ -0,0 +1,562 @@
+//
+// Maze generation and solving for the hexagonal maze library (libhexmaze).
+// Drawing lives in hexpathfinder_draw.cpp, the C ABI in hexmaze_capi.cpp.
+//
+
+#include <vector>
+#include <random>    // For std::mt19937
+#include <algorithm> // For std::shuffle
+
+#include "hexpathfinder.h"
+#include "hexmaze_kernels.h"
+#include "hexmaze_persistent.h"
+#include "hexmaze_overlay.h"
+#include "hexmaze_probes.h"
+
+using namespace std;
+
+//-----------------------------------------------------------------------------
+// Helper function: Get Neighbor Coordinates
+// Calculates the coordinates (neighborR, neighborC) of the cell adjacent
+// to (r, c) in the given wallDirection.
+// Returns true if the neighbor is within the grid bounds (0 <= r < nR, 0 <= c < nC),
+// false otherwise.
+//-----------------------------------------------------------------------------
+bool getNeighbor(uint32_t r, uint32_t c, uint8_t wallDirection, uint32_t nR, uint32_t nC, uint32_t &neighborR, uint32_t &neighborC) {
+    // Signed 64-bit for calculations, so no uint32_t row or column overflows
+    int64_t nr_int = static_cast<int64_t>(r);
+    int64_t nc_int = static_cast<int64_t>(c);
+    int64_t nR_int = static_cast<int64_t>(nR);
+    int64_t nC_int = static_cast<int64_t>(nC);
+
+    int64_t tempR = nr_int;
+    int64_t tempC = nc_int;
+
+    // Calculate potential neighbor coordinates based on direction and column parity
+    switch (wallDirection) {
+        case WALL_UP:
+            tempR--;
+            break;
+        case WALL_DOWN:
+            tempR++;
+            break;
+        case WALL_UP_RIGHT:
+            tempR = nr_int - 1 + (nc_int & 1); // r = r - 1 (even col), r (odd col)
+            tempC++;
+            break;
+        case WALL_DOWN_RIGHT:
+            tempR = nr_int + (nc_int & 1);     // r = r (even col), r + 1 (odd col)
+            tempC++;
+            break;
+        case WALL_UP_LEFT:
+            tempR = nr_int - 1 + (nc_int & 1); // r = r - 1 (even col), r (odd col)
+            tempC--;
+            break;
+        case WALL_DOWN_LEFT:
+            tempR = nr_int + (nc_int & 1);     // r = r (even col), r + 1 (odd col)
+            tempC--;
+            break;
+        default:
+            return false; // Invalid direction
+    }
+
+    // Check if the calculated neighbor coordinates are within the grid bounds
+    if (tempR >= 0 && tempR < nR_int && tempC >= 0 && tempC < nC_int) {
+        neighborR = static_cast<uint32_t>(tempR);
+        neighborC = static_cast<uint32_t>(tempC);
+        return true;
+    } else {
+        return false; // Neighbor is outside the grid
+    }
+}
+
+
+// Sets every cell to value; cell arrays go through the bulk kernels
+template <class Maze>
+static void fillMaze(Maze& maze, uint8_t value) {
+    for (uint32_t r = 0; r < maze.rows(); ++r)
+        for (uint32_t c = 0; c < maze.cols(); ++c)
+            maze.set(r, c, value);
+}
+
+static void fillMaze(ArrayMaze& maze, uint8_t value) {
+    fillRows(maze.cells, maze.nR, maze.nC, value);
+}
+
+static void fillMaze(MazeGrid& maze, uint8_t value) {
+    fillCells(maze.cells.data(), maze.cells.size(), value);
+}
+
+static void fillMaze(MazeSpan& maze, uint8_t value) {
+    fillCells(maze.cells, static_cast<size_t>(maze.nR) * maze.nC, value);
+}
+
+// Lists every internal wall once: the DOWN, UP_RIGHT and DOWN_RIGHT walls
+// of each cell that has a neighbor there, in row-major order. Adding
+// WALL_UP, WALL_UP_LEFT and WALL_DOWN_LEFT as well would be redundant.
+static void listInternalWalls(vector<Wall>& internalWalls, uint32_t nR, uint32_t nC) {
+    const uint8_t owned[] = {WALL_DOWN, WALL_UP_RIGHT, WALL_DOWN_RIGHT};
+
+    // Beyond the batch neighbor kernel's limits, check one wall at a time
+    if (nR >= (1u << 22) || nC >= (1u << 22) || static_cast<uint64_t>(nR) * nC > (1u << 31)) {
+        for (uint32_t r = 0; r < nR; ++r) {
+            for (uint32_t c = 0; c < nC; ++c) {
+                uint32_t neighborR, neighborC;
+                for (uint8_t dir : owned)
+                    if (getNeighbor(r, c, dir, nR, nC, neighborR, neighborC))
+                        internalWalls.push_back({r, c, dir});
+            }
+        }
+        return;
+    }
+
+    // Otherwise a batch of cells at a time
+    uint32_t cells[NEIGHBOR_BATCH_MAX], neighbors[NEIGHBOR_BATCH_MAX], has[3];
+    for (uint32_t r = 0; r < nR; ++r) {
+        for (uint32_t c0 = 0; c0 < nC; c0 += NEIGHBOR_BATCH_MAX) {
+            uint32_t n = min<uint32_t>(nC - c0, NEIGHBOR_BATCH_MAX);
+            for (uint32_t i = 0; i < n; ++i)
+                cells[i] = r * nC + c0 + i;
+            for (uint32_t k = 0; k < 3; ++k)
+                has[k] = neighborIndices(cells, n, owned[k], nR, nC, neighbors);
+
+            for (uint32_t i = 0; i < n; ++i)
+                for (uint32_t k = 0; k < 3; ++k)
+                    if (has[k] & (1u << i))
+                        internalWalls.push_back({r, c0 + i, owned[k]});
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+// Maze Generation (Algorithm 1 from PDF)
+// Uses DSU and randomized wall removal.
+//-----------------------------------------------------------------------------
+template <class Maze, class Index>
+bool generateMaze(Maze& maze, mt19937& rng, BasicGeneratorWorkspace<Index>& ws) {
+    const uint32_t nR = maze.rows();
+    const uint32_t nC = maze.cols();
+    if (!fitsCellIndex<Index>(nR, nC)) {
+        return false;
+    }
+
+    HEXMAZE_PROBE2(generate_start, nR, nC);
+
+    // 1. Initialize maze with all walls present
+    fillMaze(maze, ALL_WALLS);
+
+    // 2. Initialize Disjoint Set Union (DSU) structure
+    Index totalCells = static_cast<Index>(nR) * nC;
+    BasicDSU<Index>& dsu = ws.dsu;
+    dsu.reset(totalCells);
+
+    // 3. Create a list of all *internal* walls to consider removing
+    vector<Wall>& internalWalls = ws.internalWalls;
+    internalWalls.clear();
+    internalWalls.reserve(static_cast<size_t>(totalCells) * 3); // Approximate reservation
+    listInternalWalls(internalWalls, nR, nC);
+
+    // 4. Shuffle the list of internal walls randomly
+    shuffle(internalWalls.begin(), internalWalls.end(), rng);
+
+    // 5. Remove walls until nR * nC - 1 walls have been removed (or all cells are connected)
+    Index wallsRemoved = 0;
+    Index targetWallsToRemove = totalCells - 1;
+
+    for (const auto& wall : internalWalls) {
+        if (wallsRemoved >= targetWallsToRemove) {
+            break; // Stop once the maze is a spanning tree
+        }
+
+        HEXMAZE_COUNT(STAT_WALLS_EXAMINED, 1);
+        uint32_t r1 = wall.r;
+        uint32_t c1 = wall.c;
+        uint8_t direction = wall.direction;
+        uint32_t r2, c2;
+
+        // Get the neighbor cell on the other side of the wall
+        if (getNeighbor(r1, c1, direction, nR, nC, r2, c2)) {
+            // Convert cell coordinates to DSU indices
+            Index cell1_idx = static_cast<Index>(r1) * nC + c1;
+            Index cell2_idx = static_cast<Index>(r2) * nC + c2;
+
+            // Check if the cells are already connected using DSU
+            if (dsu.find(cell1_idx) != dsu.find(cell2_idx)) {
+                // If not connected, remove the wall and unite the sets
+                uint8_t oppositeWall = getOppositeWall(direction);
+
+                maze.set(r1, c1, maze.get(r1, c1) & ~direction);    // Remove wall from cell 1
+                maze.set(r2, c2, maze.get(r2, c2) & ~oppositeWall); // Remove corresponding wall from cell 2
+
+                dsu.unite(cell1_idx, cell2_idx); // Unite the sets in DSU
+                wallsRemoved++;
+                HEXMAZE_COUNT(STAT_WALLS_REMOVED, 1);
+                HEXMAZE_PROBE3(wall_removed, r1, c1, direction);
+            }
+        }
+    }
+    // Over a connected grid Kruskal always removes totalCells - 1 walls
+
+    // Optional: Implement Algorithm 2 here to remove additional walls if desired
+    HEXMAZE_PROBE1(generate_done, wallsRemoved);
+    return true;
+}
+
+void generateMaze(uint8_t maze[][MAX_COLS], uint32_t nR, uint32_t nC, mt19937& rng, GeneratorWorkspace& ws) {
+    ArrayMaze view(maze, nR, nC);
+    generateMaze(view, rng, ws);
+}
+
+void generateMaze(uint8_t maze[][MAX_COLS], uint32_t nR, uint32_t nC, mt19937& rng) {
+    GeneratorWorkspace ws;
+    generateMaze(maze, nR, nC, rng, ws);
+}
+
+
+// Clears flags in every cell; cell arrays go through the bulk kernels
+template <class Maze>
+static void clearFlags(Maze& maze, uint8_t flags) {
+    for (uint32_t r = 0; r < maze.rows(); ++r) {
+        for (uint32_t c = 0; c < maze.cols(); ++c) {
+            uint8_t cell = maze.get(r, c);
+            if (cell & flags)
+                maze.set(r, c, cell & ~flags); // Untouched cells stay shared (PersistentMaze, SessionOverlay)
+        }
+    }
+}
+
+static void clearFlags(ArrayMaze& maze, uint8_t flags) {
+    clearRowFlags(maze.cells, maze.nR, maze.nC, flags);
+}
+
+static void clearFlags(MazeGrid& maze, uint8_t flags) {
+    clearCellFlags(maze.cells.data(), maze.cells.size(), flags);
+}
+
+
+//-----------------------------------------------------------------------------
+// Maze Solving (Algorithm 3 from PDF)
+// Uses Breadth-First Search (BFS) to find the shortest path.
+//-----------------------------------------------------------------------------
+
+// Order in which the search and the path trace try a cell's neighbors
+static const uint8_t directions[] = {WALL_UP, WALL_DOWN, WALL_UP_LEFT, WALL_UP_RIGHT, WALL_DOWN_LEFT, WALL_DOWN_RIGHT};
+
+template <class Maze, class Index>
+bool solveMazeBFS(Maze& maze, BasicSolverWorkspace<Index>& ws) {
+    const uint32_t nR = maze.rows();
+    const uint32_t nC = maze.cols();
+    const Index UNVISITED = numeric_limits<Index>::max();
+    if (!fitsCellIndex<Index>(nR, nC)) {
+        return false;
+    }
+
+    HEXMAZE_PROBE2(solve_start, nR, nC);
+
+    // 1. Initialize count array and queue for BFS
+    vector<Index>& count = ws.count; // Stores distance from end cell
+    vector<Index>& q = ws.queue;     // Stores cell indices (r * nC + c)
+    size_t qHead = 0;
+
+    count.assign(static_cast<size_t>(nR) * nC, UNVISITED); // Initialize all counts to unvisited
+    q.clear();
+    q.reserve(static_cast<size_t>(nR) * nC);
+    ws.path.clear();
+
+    clearFlags(maze, VISITED); // Clear any previous VISITED flags
+
+    // 2. Start BFS from the end cell (bottom-right)
+    uint32_t endR = nR - 1;
+    uint32_t endC = nC - 1;
+
+    if (endR >= nR || endC >= nC)
+        return false; // Empty maze
+
+
+    Index endCellIdx = static_cast<Index>(endR) * nC + endC;
+    count[endCellIdx] = 0; // Distance from end cell to itself is 0
+    q.push_back(endCellIdx);
+    HEXMAZE_COUNT(STAT_BFS_PUSHES, 1);
+
+    // 3. Perform BFS
+#if HEXMAZE_PROBES_ENABLED
+    Index level = 0;
+    size_t levelStart = 0;
+#endif
+    while (qHead < q.size()) {
+        Index currentIdx = q[qHead++];
+        HEXMAZE_COUNT(STAT_CELLS_VISITED, 1);
+#if HEXMAZE_PROBES_ENABLED
+        if (count[currentIdx] != level) { // First cell of the next level
+            HEXMAZE_PROBE2(bfs_level, level, qHead - 1 - levelStart);
+            level = count[currentIdx];
+            levelStart = qHead - 1;
+        }
+#endif
+
+        uint32_t r = static_cast<uint32_t>(currentIdx / nC);
+        uint32_t c = static_cast<uint32_t>(currentIdx % nC);
+
+        // Explore neighbors: open walls with a cell behind them
+        Index neighbors[6];
+        uint8_t open = cellNeighbors(currentIdx, nR, nC, neighbors) & ~maze.get(r, c);
+        for (uint8_t dir : directions) {
+            if (open & dir) {
+                // Check if the neighbor hasn't been visited yet
+                Index neighborIdx = neighbors[__builtin_ctz(dir)];
+                if (count[neighborIdx] == UNVISITED) {
+                    count[neighborIdx] = count[currentIdx] + 1; // Set distance
+                    q.push_back(neighborIdx);                  // Add neighbor to queue
+                    HEXMAZE_COUNT(STAT_BFS_PUSHES, 1);
+                }
+            }
+        }
+    }
+
+#if HEXMAZE_PROBES_ENABLED
+    HEXMAZE_PROBE2(bfs_level, level, qHead - levelStart);
+#endif
+
+    // 4. Trace the path back from the start cell (top-left) if reachable
+    bool solved = traceSolution(maze, ws);
+    HEXMAZE_PROBE1(solve_done, ws.path.size());
+    return solved;
+}
+
+// Walks from the start cell down the distance gradient left in ws.count
+template <class Maze, class Index>
+bool traceSolution(Maze& maze, BasicSolverWorkspace<Index>& ws) {
+    const uint32_t nR = maze.rows();
+    const uint32_t nC = maze.cols();
+    const Index UNVISITED = numeric_limits<Index>::max();
+    const vector<Index>& count = ws.count;
+    uint32_t startR = 0;
+    uint32_t startC = 0;
+
+    ws.path.clear();
+    Index currentIdx = static_cast<Index>(startR) * nC + startC;
+    if (count[currentIdx] == UNVISITED)
+        return false; // Start cell was not reached by BFS
+
+    uint32_t currentR = startR;
+    uint32_t currentC = startC;
+    maze.set(currentR, currentC, maze.get(currentR, currentC) | VISITED); // Mark start cell as visited
+    ws.path.push_back(currentIdx);
+
+    while (count[currentIdx] != 0) { // While not back at the end cell
+        bool foundNext = false;
+        Index neighbors[6];
+        uint8_t open = cellNeighbors(currentIdx, nR, nC, neighbors) & ~maze.get(currentR, currentC);
+        for (uint8_t dir : directions) {
+            if (open & dir) {
+                // Check if this neighbor is the next step towards the end (count is one less)
+                Index neighborIdx = neighbors[__builtin_ctz(dir)];
+                if (count[neighborIdx] == count[currentIdx] - 1) {
+                    currentIdx = neighborIdx;
+                    currentR = static_cast<uint32_t>(neighborIdx / nC);
+                    currentC = static_cast<uint32_t>(neighborIdx % nC);
+                    maze.set(currentR, currentC, maze.get(currentR, currentC) | VISITED); // Mark this cell as part of the path
+                    ws.path.push_back(neighborIdx);
+                    foundNext = true;
+                    break; // Move to the next step
+                }
+            }
+        }
+         if (!foundNext) {
+             // This should not happen if BFS completed correctly and start was reachable
+             return false;
+         }
+    }
+    HEXMAZE_COUNT(STAT_PATH_CELLS, ws.path.size());
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// Dead-End Filling
+// Fills (flags DEAD_END) every cell other than start and end with at most
+// one unfilled open neighbor, following each chain of fills from the cell
+// it left behind, so one scan of the maze is enough. If a walk over the
+// unfilled cells gets from start to end, they are then flagged VISITED.
+// Besides the maze's own flag bits, only the walk's few branch cells are
+// kept.
+//-----------------------------------------------------------------------------
+template <class Maze>
+bool solveMazeDeadEnds(Maze& maze) {
+    const uint32_t nR = maze.rows();
+    const uint32_t nC = maze.cols();
+    const uint64_t cells = static_cast<uint64_t>(nR) * nC;
+    const uint64_t startIdx = 0;
+    const uint64_t endIdx = cells - 1;
+    HEXMAZE_PROBE2(solve_start, nR, nC);
+    clearFlags(maze, VISITED | DEAD_END);
+
+    // Open neighbors not yet filled; next is set to one of them
+    auto liveExits = [&](uint64_t idx, uint64_t& next) {
+        uint64_t neighbors[6];
+        uint32_t r = static_cast<uint32_t>(idx / nC);
+        uint32_t c = static_cast<uint32_t>(idx % nC);
+        uint8_t open = cellNeighbors(idx, nR, nC, neighbors) & ~maze.get(r, c);
+        int exits = 0;
+        for (; open != 0; open &= open - 1) {
+            uint64_t neighbor = neighbors[__builtin_ctz(open)];
+            if ((maze.get(static_cast<uint32_t>(neighbor / nC), static_cast<uint32_t>(neighbor % nC)) & DEAD_END) == 0) {
+                next = neighbor;
+                ++exits;
+            }
+        }
+        return exits;
+    };
+
+    for (uint64_t idx = 0; idx < cells; ++idx) {
+        uint64_t cur = idx;
+        uint64_t next = 0;
+        while (cur != startIdx && cur != endIdx) {
+            uint32_t r = static_cast<uint32_t>(cur / nC);
+            uint32_t c = static_cast<uint32_t>(cur % nC);
+            uint8_t cell = maze.get(r, c);
+            if ((cell & DEAD_END) != 0)
+                break;
+            int exits = liveExits(cur, next);
+            if (exits > 1)
+                break;
+            maze.set(r, c, cell | DEAD_END);
+            if (exits == 0)
+                break;
+            cur = next; // The only cell this fill can have turned into a dead end
+        }
+    }
+
+    // Filling leaves loops standing, so the start having an unfilled exit
+    // does not mean the end is behind it: walk the unfilled cells from the
+    // start, marking them VISITED, and solve only if the walk gets to the
+    // end. The walk follows a chain of cells and only stacks the cells it
+    // leaves with another way still open, none at all in a perfect maze.
+    bool solved = false;
+    vector<uint64_t> branches;
+    uint64_t cur = startIdx;
+    maze.set(0, 0, maze.get(0, 0) | VISITED);
+    for (;;) {
+        if (cur == endIdx) {
+            solved = true;
+            break;
+        }
+        uint64_t neighbors[6];
+        uint32_t r = static_cast<uint32_t>(cur / nC);
+        uint32_t c = static_cast<uint32_t>(cur % nC);
+        uint8_t open = cellNeighbors(cur, nR, nC, neighbors) & ~maze.get(r, c);
+        uint64_t next = cur;
+        int ways = 0;
+        for (; open != 0; open &= open - 1) {
+            uint64_t neighbor = neighbors[__builtin_ctz(open)];
+            if ((maze.get(static_cast<uint32_t>(neighbor / nC), static_cast<uint32_t>(neighbor % nC)) &
+                 (DEAD_END | VISITED)) == 0) {
+                next = neighbor;
+                ++ways;
+            }
+        }
+        if (ways == 0) {
+            if (branches.empty())
+                break;
+            cur = branches.back();
+            branches.pop_back();
+            continue;
+        }
+        if (ways > 1)
+            branches.push_back(cur);
+        uint32_t r2 = static_cast<uint32_t>(next / nC);
+        uint32_t c2 = static_cast<uint32_t>(next % nC);
+        maze.set(r2, c2, maze.get(r2, c2) | VISITED);
+        cur = next;
+    }
+
+    uint64_t pathCells = 0;
+    for (uint32_t r = 0; r < nR; ++r) {
+        for (uint32_t c = 0; c < nC; ++c) {
+            uint8_t cell = maze.get(r, c);
+            bool onPath = solved && (cell & DEAD_END) == 0;
+            pathCells += onPath;
+            maze.set(r, c, static_cast<uint8_t>((cell & ~(DEAD_END | VISITED)) | (onPath ? VISITED : 0)));
+        }
+    }
+    HEXMAZE_COUNT(STAT_PATH_CELLS, pathCells);
+    HEXMAZE_PROBE1(solve_done, pathCells);
+    return solved;
+}
+
+bool solveMazeBFS(uint8_t maze[][MAX_COLS], uint32_t nR, uint32_t nC, SolverWorkspace& ws) {
+    ArrayMaze view(maze, nR, nC);
+    return solveMazeBFS(view, ws);
+}
+
+bool solveMazeBFS(uint8_t maze[][MAX_COLS], uint32_t nR, uint32_t nC) {
+    SolverWorkspace ws;
+    return solveMazeBFS(maze, nR, nC, ws);
+}
+
+
+//-----------------------------------------------------------------------------
+// Maze Analysis
+//-----------------------------------------------------------------------------
+
+// Odd columns sit half a cell lower (see computeY), i.e. "odd-q" offset
+// coordinates; converting to cube coordinates makes distance a max()
+uint32_t hexDistance(uint32_t r1, uint32_t c1, uint32_t r2, uint32_t c2) {
+    int64_t x1 = c1, z1 = static_cast<int64_t>(r1) - (c1 - (c1 & 1)) / 2;
+    int64_t x2 = c2, z2 = static_cast<int64_t>(r2) - (c2 - (c2 & 1)) / 2;
+    int64_t dx = x1 - x2, dz = z1 - z2, dy = -dx - dz;
+    int64_t d = max(max(dx < 0 ? -dx : dx, dy < 0 ? -dy : dy), dz < 0 ? -dz : dz);
+    return static_cast<uint32_t>(d);
+}
+
+static uint32_t openWallCount(uint8_t cell) {
+    uint32_t open = 0;
+    for (uint8_t dir = WALL_UP; dir <= WALL_UP_LEFT; dir <<= 1)
+        if ((cell & dir) == 0)
+            ++open;
+    return open;
+}
+
+MazeMetrics analyzeMaze(uint8_t maze[][MAX_COLS], uint32_t nR, uint32_t nC, const vector<uint32_t>& path) {
+    MazeMetrics m;
+    m.solutionLength = path.empty() ? 0 : static_cast<uint32_t>(path.size() - 1);
+    m.deadEnds = 0;
+    m.junctions = 0;
+
+    uint64_t deadEnds[(MAX_COLS + 63) / 64];
+    for (uint32_t r = 0; r < nR; ++r)
+        m.deadEnds += static_cast<uint32_t>(degreeBitmap(maze[r], nC, 1, deadEnds));
+
+    for (uint32_t idx : path)
+        if (openWallCount(maze[idx / nC][idx % nC]) >= 3)
+            ++m.junctions;
+
+    uint32_t straight = hexDistance(0, 0, nR - 1, nC - 1);
+    if (straight == 0 || m.solutionLength == 0) {
+        m.difficulty = 0.0f;
+    } else {
+        m.difficulty = static_cast<float>(m.solutionLength) / straight *
+                       (1.0f + static_cast<float>(m.junctions) / m.solutionLength);
+    }
+    return m;
+}
+
+
+//-----------------------------------------------------------------------------
+// Accessor Instantiations
+//-----------------------------------------------------------------------------
+template bool generateMaze<ArrayMaze, uint32_t>(ArrayMaze&, mt19937&, BasicGeneratorWorkspace<uint32_t>&);
+template bool generateMaze<MazeGrid, uint32_t>(MazeGrid&, mt19937&, BasicGeneratorWorkspace<uint32_t>&);
+template bool generateMaze<MazeGrid, uint64_t>(MazeGrid&, mt19937&, BasicGeneratorWorkspace<uint64_t>&);
+template bool generateMaze<MazeSpan, uint32_t>(MazeSpan&, mt19937&, BasicGeneratorWorkspace<uint32_t>&);
+template bool generateMaze<MazeSpan, uint64_t>(MazeSpan&, mt19937&, BasicGeneratorWorkspace<uint64_t>&);
+
+template bool solveMazeBFS<ArrayMaze, uint32_t>(ArrayMaze&, SolverWorkspace&);
+template bool solveMazeBFS<PersistentMaze, uint32_t>(PersistentMaze&, SolverWorkspace&);
+template bool solveMazeBFS<SessionOverlay, uint32_t>(SessionOverlay&, SolverWorkspace&);
+template bool solveMazeBFS<MazeGrid, uint32_t>(MazeGrid&, SolverWorkspace&);
+template bool solveMazeBFS<MazeGrid, uint64_t>(MazeGrid&, BasicSolverWorkspace<uint64_t>&);
+
+template bool traceSolution<MazeGrid, uint32_t>(MazeGrid&, SolverWorkspace&);
+template bool traceSolution<MazeGrid, uint64_t>(MazeGrid&, BasicSolverWorkspace<uint64_t>&);
+
+template bool solveMazeDeadEnds<MazeGrid>(MazeGrid&);
@@ -2,7 +2,15 @@
 #define HEXPATHFINDER_H
 
 #include <cstdint>
-#include <vector> // Needed for potential helper structures/functions if added later
+#include <limits>
+#include <vector>
+#include <numeric> // For std::iota
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <random>  // For std::mt19937
+
+#include "hexmaze_stats.h"
 
 // --- Constants ---
 const uint32_t MAX_ROWS = 50;
@@ -14,9 +22,10 @@ const uint32_t DRAW_V = 5;       // Vertical distance between center and horizon
 const uint32_t DRAW_X_LEFT = 54; // Leftmost X coordinate for drawing
 const uint32_t DRAW_Y_TOP = 708; // Topmost Y coordinate for drawing
 
-// Macros to compute drawing coordinates (as provided)
-#define computeX(c) (DRAW_X_LEFT + DRAW_E + (3 * DRAW_E * (c)) / 2)
-#define computeY(r, c) (DRAW_Y_TOP - DRAW_V - 2 * DRAW_V * (r) - ((c)&1u) * DRAW_V)
+// Macros to compute drawing coordinates (as provided; signed, so rows and
+// columns past the edge of the page give negative coordinates, not wrap)
+#define computeX(c) (DRAW_X_LEFT + DRAW_E + (3 * DRAW_E * static_cast<int64_t>(c)) / 2)
+#define computeY(r, c) (DRAW_Y_TOP - DRAW_V - 2 * DRAW_V * static_cast<int64_t>(r) - (static_cast<int64_t>(c) & 1) * DRAW_V)
 
 // --- Cell Values (Bitmasks) ---
 // Represents walls *present* in a cell
@@ -32,9 +41,265 @@ enum CellValues : uint8_t { // Use uint8_t explicitly
     DEAD_END = 0x80u   // Flag for dead ends (optional, not used in final solution path marking)
 };
 
+// --- Library Types ---
+
+//-----------------------------------------------------------------------------
+// Cell Indexing
+// Cells are numbered r * nC + c. Rows and columns are always 32-bit, but
+// their product need not be, so everything that holds cell numbers (DSU,
+// BFS queue and distances, solution path) is templated on the index type.
+// uint32_t is the fast default and every workspace typedef below uses it;
+// the library also instantiates the core for uint64_t. CellIndex is the
+// type run-time sized mazes (MazeGrid, the CLI) use: building with
+// HEXMAZE_INDEX64 (`make INDEX64=1`) makes it 64-bit for mazes of 2^32
+// cells and more.
+//-----------------------------------------------------------------------------
+#if defined(HEXMAZE_INDEX64)
+typedef uint64_t CellIndex;
+#else
+typedef uint32_t CellIndex;
+#endif
+
+// True if Index can number every cell of an nR x nC maze and still has a
+// spare value left over (the solver's "unvisited" marker)
+template <class Index>
+inline bool fitsCellIndex(uint64_t nR, uint64_t nC) {
+    return nR * nC <= std::numeric_limits<Index>::max();
+}
+
+//-----------------------------------------------------------------------------
+// Disjoint Set Union (DSU) Data Structure
+// Used for maze generation to detect cycles.
+//-----------------------------------------------------------------------------
+template <class Index>
+struct BasicDSU {
+    std::vector<Index> parent;
+    BasicDSU() {}
+    BasicDSU(Index n) {
+        reset(n);
+    }
+
+    // Re-initialize for n elements, reusing the existing buffer
+    // (resize never releases capacity, so repeated resets don't allocate)
+    void reset(Index n) {
+        parent.resize(n);
+        iota(parent.begin(), parent.end(), Index(0)); // Fill with 0, 1, 2, ...
+    }
+
+    // Find the representative (root) of the set containing element i.
+    // Iterative, so long chains in huge mazes cannot overflow the stack.
+    Index find(Index i) {
+        HEXMAZE_STATS_ONLY(uint64_t hops = 0;)
+        Index root = i;
+        while (parent[root] != root) {
+            root = parent[root];
+            HEXMAZE_STATS_ONLY(++hops;)
+        }
+        HEXMAZE_COUNT(STAT_DSU_FINDS, 1);
+        HEXMAZE_COUNT(STAT_DSU_FIND_HOPS, hops);
+        while (parent[i] != root) { // Path compression
+            Index next = parent[i];
+            parent[i] = root;
+            i = next;
+        }
+        return root;
+    }
+
+    // Unite the sets containing elements i and j
+    void unite(Index i, Index j) {
+        Index root_i = find(i);
+        Index root_j = find(j);
+        if (root_i != root_j) {
+            parent[root_i] = root_j; // Make root_j the parent of root_i
+        }
+    }
+};
+
+typedef BasicDSU<uint32_t> DSU;
+
+//-----------------------------------------------------------------------------
+// Wall Structure
+// Represents a potential wall to be removed during generation.
+// Stores the coordinates of *one* cell and the direction of the wall relative to that cell.
+// Coordinates stay 32-bit whatever the cell index type: only r * nC + c can
+// outgrow them.
+//-----------------------------------------------------------------------------
+struct Wall {
+    uint32_t r;          // Row of the cell
+    uint32_t c;          // Column of the cell
+    uint8_t direction; // Direction of the wall (e.g., WALL_DOWN, WALL_UP_RIGHT)
+
+    // Overload == operator for potential use in Sampler if needed (e.g., checking duplicates)
+    bool operator==(const Wall& other) const {
+        return r == other.r && c == other.c && direction == other.direction;
+    }
+};
+
+//-----------------------------------------------------------------------------
+// Workspaces
+// Own the scratch buffers used by generateMaze / solveMazeBFS so repeated
+// calls can reuse them. Buffers only ever grow; once a workspace has seen a
+// maze of a given size, further calls of that size or smaller do no heap
+// allocation. A workspace must not be shared between threads.
+//-----------------------------------------------------------------------------
+template <class Index>
+struct BasicGeneratorWorkspace {
+    BasicDSU<Index> dsu;             // Cell connectivity
+    std::vector<Wall> internalWalls; // Candidate walls, shuffled each call
+};
+
+template <class Index>
+struct BasicSolverWorkspace {
+    std::vector<Index> count; // Distance from end cell, indexed r * nC + c (max() = unvisited)
+    std::vector<Index> queue; // BFS queue; every cell is pushed at most once
+    std::vector<Index> path;  // Solution cells (r * nC + c), start to end, after a successful solve
+};
+
+typedef BasicGeneratorWorkspace<uint32_t> GeneratorWorkspace;
+typedef BasicSolverWorkspace<uint32_t> SolverWorkspace;
+
+//-----------------------------------------------------------------------------
+// String Sink
+// Stream buffer that appends into a caller-owned std::string, so rendering
+// repeatedly into the same string reuses its capacity instead of the fresh
+// allocations std::ostringstream makes.
+//-----------------------------------------------------------------------------
+class StringSink : public std::streambuf {
+public:
+    explicit StringSink(std::string& target) : out(target) {}
+
+protected:
+    int_type overflow(int_type ch) override {
+        if (!traits_type::eq_int_type(ch, traits_type::eof()))
+            out.push_back(traits_type::to_char_type(ch));
+        return traits_type::not_eof(ch);
+    }
+
+    std::streamsize xsputn(const char* s, std::streamsize n) override {
+        out.append(s, static_cast<size_t>(n));
+        return n;
+    }
+
+private:
+    std::string& out;
+};
+
+//-----------------------------------------------------------------------------
+// Maze Accessors
+// The generator, solver and renderer are written against this interface
+// rather than a raw cell array, so any maze representation can be built,
+// solved and drawn:
+//   uint32_t rows() const;
+//   uint32_t cols() const;
+//   uint8_t get(uint32_t r, uint32_t c) const;     // CellValues bitmask
+//   void set(uint32_t r, uint32_t c, uint8_t cell);
+// Each template is explicitly instantiated for every accessor in the
+// library (see the end of hexpathfinder.cpp and hexpathfinder_draw.cpp).
+//-----------------------------------------------------------------------------
+
+// The classic fixed-size cell array
+struct ArrayMaze {
+    ArrayMaze(uint8_t maze[][MAX_COLS], uint32_t nR, uint32_t nC) : cells(maze), nR(nR), nC(nC) {}
+
+    uint32_t rows() const { return nR; }
+    uint32_t cols() const { return nC; }
+    uint8_t get(uint32_t r, uint32_t c) const { return cells[r][c]; }
+    void set(uint32_t r, uint32_t c, uint8_t cell) { cells[r][c] = cell; }
+
+    uint8_t (*cells)[MAX_COLS];
+    uint32_t nR;
+    uint32_t nC;
+};
+
+// A heap-allocated maze of any size, one byte per cell, row-major
+struct MazeGrid {
+    MazeGrid() : nR(0), nC(0) {}
+    MazeGrid(uint32_t nR, uint32_t nC) : cells(static_cast<size_t>(nR) * nC, ALL_WALLS), nR(nR), nC(nC) {}
+
+    uint32_t rows() const { return nR; }
+    uint32_t cols() const { return nC; }
+    uint8_t get(uint32_t r, uint32_t c) const { return cells[static_cast<size_t>(r) * nC + c]; }
+    void set(uint32_t r, uint32_t c, uint8_t cell) { cells[static_cast<size_t>(r) * nC + c] = cell; }
+    uint8_t* row(uint32_t r) { return &cells[static_cast<size_t>(r) * nC]; }
+    const uint8_t* row(uint32_t r) const { return &cells[static_cast<size_t>(r) * nC]; }
+
+    std::vector<uint8_t> cells;
+    uint32_t nR;
+    uint32_t nC;
+};
+
+// Rows of cells owned elsewhere, row-major, e.g. one band of a MazeGrid
+struct MazeSpan {
+    MazeSpan(uint8_t* cells, uint32_t nR, uint32_t nC) : cells(cells), nR(nR), nC(nC) {}
+
+    uint32_t rows() const { return nR; }
+    uint32_t cols() const { return nC; }
+    uint8_t get(uint32_t r, uint32_t c) const { return cells[static_cast<size_t>(r) * nC + c]; }
+    void set(uint32_t r, uint32_t c, uint8_t cell) { cells[static_cast<size_t>(r) * nC + c] = cell; }
+
+    uint8_t* cells;
+    uint32_t nR;
+    uint32_t nC;
+};
+
 // --- Function Declarations ---
 
-// Provided drawing function (implementation in hexpathfinder_draw.cpp)
+// Maze generation and solving (implementation in hexpathfinder.cpp)
+// The workspace overloads reuse the caller's buffers; the others allocate a
+// temporary workspace per call.
+void generateMaze(uint8_t maze[][MAX_COLS], uint32_t nR, uint32_t nC, std::mt19937& rng, GeneratorWorkspace& ws);
+void generateMaze(uint8_t maze[][MAX_COLS], uint32_t nR, uint32_t nC, std::mt19937& rng);
+// Any accessor and index type; returns false (and leaves the maze alone) if
+// the maze has more cells than Index can number. Instantiated for ArrayMaze
+// and for MazeGrid and MazeSpan with both index types.
+template <class Maze, class Index>
+bool generateMaze(Maze& maze, std::mt19937& rng, BasicGeneratorWorkspace<Index>& ws);
+
+// Marks the shortest path from (0, 0) to (nR - 1, nC - 1) with VISITED.
+// Returns false if no path exists.
+bool solveMazeBFS(uint8_t maze[][MAX_COLS], uint32_t nR, uint32_t nC, SolverWorkspace& ws);
+bool solveMazeBFS(uint8_t maze[][MAX_COLS], uint32_t nR, uint32_t nC);
+// As above, also false if Index cannot number every cell
+template <class Maze, class Index>
+bool solveMazeBFS(Maze& maze, BasicSolverWorkspace<Index>& ws);
+// The second half of solveMazeBFS: with ws.count holding every cell's
+// distance from the end cell, marks the path from the start and stores it
+// in ws.path. For solvers that fill ws.count some other way; instantiated
+// for MazeGrid.
+template <class Maze, class Index>
+bool traceSolution(Maze& maze, BasicSolverWorkspace<Index>& ws);
+// Marks the path from (0, 0) to (nR - 1, nC - 1) with VISITED by dead-end
+// filling, using no memory beyond the maze itself (DEAD_END flags serve as
+// scratch and are cleared again). Gives the same marks as solveMazeBFS on a
+// perfect maze; on a maze with loops the loops stay marked too. Returns
+// false if no path exists. Instantiated for MazeGrid.
+template <class Maze>
+bool solveMazeDeadEnds(Maze& maze);
+
+// Summary statistics of a solved maze (implementation in hexpathfinder.cpp)
+struct MazeMetrics {
+    uint32_t solutionLength; // Moves from start to end (path cells - 1)
+    uint32_t deadEnds;       // Cells with exactly one open wall
+    uint32_t junctions;      // Path cells with three or more open walls
+    // Solution length relative to the straight-line hex distance from start
+    // to end, scaled up by the share of path cells that are junctions (each
+    // one is a wrong turn the solver could take). 1.0 = a straight corridor.
+    float difficulty;
+};
+
+// path is SolverWorkspace::path from a successful solveMazeBFS
+MazeMetrics analyzeMaze(uint8_t maze[][MAX_COLS], uint32_t nR, uint32_t nC, const std::vector<uint32_t>& path);
+
+// Number of moves between two cells on an open grid
+uint32_t hexDistance(uint32_t r1, uint32_t c1, uint32_t r2, uint32_t c2);
+
+// Writes the two-page PostScript document (maze, maze with solution) to out
+// (implementation in hexpathfinder_draw.cpp)
+void renderMaze(std::ostream& out, uint8_t maze[][MAX_COLS], uint32_t nR, uint32_t nC);
+template <class Maze>
+void renderMaze(std::ostream& out, const Maze& maze);
+
+// Provided drawing function: renders to maze.ps (implementation in hexpathfinder_draw.cpp)
 void printMaze(uint8_t maze[][MAX_COLS], uint32_t nR, uint32_t nC);
 
 // --- Helper Function Declarations (Optional but Recommended) ---
@@ -4,49 +4,85 @@
 // Contains the implementation for drawing the maze to a PostScript file.
 //
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
+#include <ostream>
+#include <string>
+#include <vector>
 #include "hexpathfinder.h"
+#include "hexmaze_kernels.h"
+#include "hexmaze_parallel.h"
+#include "hexmaze_persistent.h"
+#include "hexmaze_overlay.h"
+#include "hexmaze_probes.h"
 
 using namespace std;
 
 // Helper function to draw a line in PostScript format
-void drawLine(ofstream &outFile, uint32_t x1, uint32_t y1, uint32_t x2, uint32_t y2) {
+// (signed: mazes taller or wider than the page run off its edges)
+void drawLine(ostream &outFile, int64_t x1, int64_t y1, int64_t x2, int64_t y2) {
+    HEXMAZE_COUNT(STAT_SEGMENTS_DRAWN, 1);
     outFile << "newpath "
             << x1 << ' ' << y1 << " moveto "
             << x2 << ' ' << y2 << " lineto stroke\n";
 }
 
-// Main function to draw the maze structure and optionally the solution path
-void drawMaze(ofstream &outFile, uint8_t maze[][MAX_COLS], uint32_t nR, uint32_t nC,
-              bool drawSolution, bool drawDeadEnds) { // drawDeadEnds is unused based on printMaze call
-    uint32_t
-        r, c,
-        r2, c2,
-        x, y,
-        x2, y2;
+// Bit i is set if cell (r, c0 + i) is on the solution path, for the up to
+// 64 columns from c0; cell arrays go through the bulk kernels
+template <class Maze>
+static uint64_t pathCells(const Maze& maze, uint32_t r, uint32_t c0) {
+    uint64_t bits = 0;
+    for (uint32_t i = 0; i < 64 && c0 + i < maze.cols(); ++i)
+        if (maze.get(r, c0 + i) & VISITED)
+            bits |= 1ull << i;
+    return bits;
+}
+
+static uint64_t pathCells(const ArrayMaze& maze, uint32_t r, uint32_t c0) {
+    uint64_t bits;
+    flagBitmap(maze.cells[r] + c0, min<uint32_t>(maze.nC - c0, 64), VISITED, &bits);
+    return bits;
+}
 
-    outFile << "0.25 setlinewidth\n"; // Set line width for walls
+static uint64_t pathCells(const MazeGrid& maze, uint32_t r, uint32_t c0) {
+    uint64_t bits;
+    flagBitmap(maze.row(r) + c0, min<uint32_t>(maze.nC - c0, 64), VISITED, &bits);
+    return bits;
+}
 
-    // --- Draw Internal Walls ---
-    // Iterate through each cell and draw walls that are present
-    for (r = 0; r < nR; r++) {
-        for (c = 0; c < nC; c++) {
+// Internal walls of rows [r0, r1): each cell draws only the UP_RIGHT,
+// DOWN_RIGHT and DOWN walls it owns, so no wall is drawn twice
+template <class Maze>
+static void drawWallRows(ostream &outFile, const Maze& maze, uint32_t r0, uint32_t r1) {
+    const uint32_t nC = maze.cols();
+    int64_t x, y;
+
+    for (uint32_t r = r0; r < r1; r++) {
+        for (uint32_t c = 0; c < nC; c++) {
             x = computeX(c);
             y = computeY(r, c);
 
             // Draw walls based on flags set in the maze array
-            // Only draw UP_RIGHT, DOWN_RIGHT, and DOWN to avoid drawing walls twice
-            if (maze[r][c] & WALL_UP_RIGHT)
+            if (maze.get(r, c) & WALL_UP_RIGHT)
                 drawLine(outFile, x + DRAW_E / 2, y + DRAW_V, x + DRAW_E, y);
-            if (maze[r][c] & WALL_DOWN_RIGHT)
+            if (maze.get(r, c) & WALL_DOWN_RIGHT)
                 drawLine(outFile, x + DRAW_E, y, x + DRAW_E / 2, y - DRAW_V);
-            if (maze[r][c] & WALL_DOWN)
+            if (maze.get(r, c) & WALL_DOWN)
                 drawLine(outFile, x + DRAW_E / 2, y - DRAW_V, x - DRAW_E / 2, y - DRAW_V);
         }
     }
+}
+
+// Exterior walls no cell owns: the left edge, the top edge and the
+// diagonals along the top and bottom rows
+template <class Maze>
+static void drawBorder(ostream &outFile, const Maze& maze) {
+    const uint32_t nR = maze.rows();
+    const uint32_t nC = maze.cols();
+    uint32_t r, c;
+    int64_t x, y;
 
-    // --- Draw Exterior Walls ---
     // These walls are always present unless explicitly removed at borders (which isn't typical for this maze type)
 
     // Draw the left walls (UP_LEFT and DOWN_LEFT) for column 0
@@ -79,48 +115,52 @@ void drawMaze(ofstream &outFile, uint8_t maze[][MAX_COLS], uint32_t nR, uint32_t
         y = computeY(nR - 1, c);
         drawLine(outFile, x - DRAW_E / 2, y - DRAW_V, x - DRAW_E, y); // Down-Left
     }
+}
 
+// Solution path segments starting in rows [r0, r1)
+template <class Maze>
+static void drawSolutionRows(ostream &outFile, const Maze& maze, uint32_t r0, uint32_t r1) {
+    const uint32_t nR = maze.rows();
+    const uint32_t nC = maze.cols();
+    uint32_t r, c;
+    int64_t
+        x, y,
+        x2, y2;
 
-    // --- Draw Solution Path (if requested) ---
-    if (drawSolution) {
-        // Set color (blue) and line width for the solution path
-        outFile << "0 0 1 setrgbcolor gsave currentlinewidth 5 mul setlinewidth "
-                   " 1 setlinecap\n"; // Blue, thicker line, rounded caps
-
-        int count[MAX_ROWS][MAX_COLS]; // Need the count array from BFS to trace path
-        // NOTE: This drawMaze function doesn't have access to the 'count' array
-        // The logic below assumes 'VISITED' flag correctly marks the path cells.
-
-        for (r = 0; r < nR; r++) {
-            for (c = 0; c < nC; c++) {
-                // Check if the cell is part of the solution path (marked as VISITED but not a DEAD_END)
-                // The original PDF implies VISITED marks the final path.
-                if ((maze[r][c] & VISITED) != 0) {
-                     x = computeX(c);
-                     y = computeY(r, c);
-
-                    // Check each neighbor. If the neighbor is also on the path and there's no wall, draw a line segment.
-                    uint32_t neighborR, neighborC;
-                    uint8_t directions[] = {WALL_UP, WALL_DOWN, WALL_UP_LEFT, WALL_UP_RIGHT, WALL_DOWN_LEFT, WALL_DOWN_RIGHT};
-
-                    for(uint8_t dir : directions) {
-                        // Check if there is *no* wall in this direction for the current cell
-                        if ((maze[r][c] & dir) == 0) {
-                             // Get the coordinates of the neighbor in that direction
-                            if (getNeighbor(r, c, dir, nR, nC, neighborR, neighborC)) {
-                                // Check if the neighbor is also part of the visited path
-                                if ((maze[neighborR][neighborC] & VISITED) != 0) {
-                                    // Calculate neighbor's center coordinates
-                                    x2 = computeX(neighborC);
-                                    y2 = computeY(neighborR, neighborC);
-
-                                    // Draw line segment between centers (or midpoints for smoother look)
-                                    // Draw only half the line to avoid drawing each segment twice?
-                                    // Let's draw the full line for simplicity, PostScript might handle overlaps.
-                                    // Only draw if neighbor has higher index to draw each segment once
-                                    if (neighborR * nC + neighborC > r * nC + c) {
-                                         drawLine(outFile, x, y, x2, y2);
-                                    }
+    // NOTE: This function doesn't have access to the BFS 'count' array
+    // The logic below assumes 'VISITED' flag correctly marks the path cells.
+
+    for (r = r0; r < r1; r++) {
+        for (uint32_t c0 = 0; c0 < nC; c0 += 64) {
+            // Visit only the cells on the solution path (marked as VISITED)
+            // The original PDF implies VISITED marks the final path.
+            for (uint64_t bits = pathCells(maze, r, c0); bits != 0; bits &= bits - 1) {
+                 c = c0 + static_cast<uint32_t>(__builtin_ctzll(bits));
+                 x = computeX(c);
+                 y = computeY(r, c);
+
+                // Check each neighbor. If the neighbor is also on the path and there's no wall, draw a line segment.
+                uint32_t neighborR, neighborC;
+                uint8_t directions[] = {WALL_UP, WALL_DOWN, WALL_UP_LEFT, WALL_UP_RIGHT, WALL_DOWN_LEFT, WALL_DOWN_RIGHT};
+
+                for(uint8_t dir : directions) {
+                    // Check if there is *no* wall in this direction for the current cell
+                    if ((maze.get(r, c) & dir) == 0) {
+                         // Get the coordinates of the neighbor in that direction
+                        if (getNeighbor(r, c, dir, nR, nC, neighborR, neighborC)) {
+                            // Check if the neighbor is also part of the visited path
+                            if ((maze.get(neighborR, neighborC) & VISITED) != 0) {
+                                // Calculate neighbor's center coordinates
+                                x2 = computeX(neighborC);
+                                y2 = computeY(neighborR, neighborC);
+
+                                // Draw line segment between centers (or midpoints for smoother look)
+                                // Draw only half the line to avoid drawing each segment twice?
+                                // Let's draw the full line for simplicity, PostScript might handle overlaps.
+                                // Only draw if neighbor has higher index to draw each segment once
+                                // (compared as (row, col) so huge mazes cannot overflow r * nC + c)
+                                if (neighborR > r || (neighborR == r && neighborC > c)) {
+                                     drawLine(outFile, x, y, x2, y2);
                                 }
                             }
                         }
@@ -128,7 +168,35 @@ void drawMaze(ofstream &outFile, uint8_t maze[][MAX_COLS], uint32_t nR, uint32_t
                 }
             }
         }
-        outFile << "grestore\n"; // Restore graphics state (color, line width)
+    }
+}
+
+// Page preambles and trailers shared by drawMaze and drawMazeParallel
+static const char* const WALL_STYLE = "0.25 setlinewidth\n"; // Set line width for walls
+static const char* const SOLUTION_STYLE =
+    "0 0 1 setrgbcolor gsave currentlinewidth 5 mul setlinewidth "
+    " 1 setlinecap\n"; // Blue, thicker line, rounded caps
+static const char* const SOLUTION_END = "grestore\n"; // Restore graphics state (color, line width)
+
+// Main function to draw the maze structure and optionally the solution path
+template <class Maze>
+static void drawMaze(ostream &outFile, const Maze& maze,
+                     bool drawSolution, bool drawDeadEnds) { // drawDeadEnds is unused based on printMaze call
+    const uint32_t nR = maze.rows();
+
+    outFile << WALL_STYLE;
+
+    // --- Draw Internal Walls ---
+    drawWallRows(outFile, maze, 0, nR);
+
+    // --- Draw Exterior Walls ---
+    drawBorder(outFile, maze);
+
+    // --- Draw Solution Path (if requested) ---
+    if (drawSolution) {
+        outFile << SOLUTION_STYLE;
+        drawSolutionRows(outFile, maze, 0, nR);
+        outFile << SOLUTION_END;
     }
      // --- Draw Dead Ends (if requested) ---
      // This section was commented out in the original printMaze, keeping it commented.
@@ -139,12 +207,12 @@ void drawMaze(ofstream &outFile, uint8_t maze[][MAX_COLS], uint32_t nR, uint32_t
             for (c = 0; c < nC; c++) {
                 x = computeX(c);
                 y = computeY(r, c);
-                if ((maze[r][c] & DEAD_END) != 0) {
+                if ((maze.get(r, c) & DEAD_END) != 0) {
                     // Logic to draw lines indicating dead ends (e.g., short lines into the dead end passage)
                     // This requires checking which passage is open from the dead end cell.
                     uint8_t directions[] = {WALL_UP, WALL_DOWN, WALL_UP_LEFT, WALL_UP_RIGHT, WALL_DOWN_LEFT, WALL_DOWN_RIGHT};
                      for(uint8_t dir : directions) {
-                        if ((maze[r][c] & dir) == 0) { // If there's no wall (it's an open passage)
+                        if ((maze.get(r, c) & dir) == 0) { // If there's no wall (it's an open passage)
                             if (getNeighbor(r, c, dir, nR, nC, r2, c2)) {
                                  x2 = computeX(c2);
                                  y2 = computeY(r2, c2);
@@ -164,15 +232,13 @@ void drawMaze(ofstream &outFile, uint8_t maze[][MAX_COLS], uint32_t nR, uint32_t
 }
 
 
-// Function to create the PostScript file and call drawMaze
-void printMaze(uint8_t maze[][MAX_COLS], uint32_t nR, uint32_t nC) {
-    ofstream outFile;
-
-    outFile.open("maze.ps"); // Open the output file
-    if (!outFile) {
-        cerr << "Error: cannot open maze.ps for writing." << endl; // Use cerr for errors
-        return;
-    }
+// Function to write both PostScript pages to an output stream; drawPage(out,
+// drawSolution) draws the body of each page
+template <class Maze, class DrawPage>
+static void writeDocument(ostream &outFile, const Maze& maze, DrawPage drawPage) {
+    const uint32_t nR = maze.rows();
+    const uint32_t nC = maze.cols();
+    HEXMAZE_PROBE2(render_start, nR, nC);
 
     // --- Page 1: Maze Only ---
     outFile << "%!PS-Adobe-2.0\n\n%%Pages: 2\n%%Page: 1 1\n"; // PS Header
@@ -182,7 +248,7 @@ void printMaze(uint8_t maze[][MAX_COLS], uint32_t nR, uint32_t nC) {
             << "54 730 moveto (Random Maze - " << nR << "x" << nC << ") show\n";
 
     // Draw the maze without the solution
-    drawMaze(outFile, maze, nR, nC, false, false);
+    drawPage(outFile, false);
 
     outFile << "showpage\n"; // End page 1
 
@@ -194,9 +260,10 @@ void printMaze(uint8_t maze[][MAX_COLS], uint32_t nR, uint32_t nC) {
             << "54 730 moveto (Random Maze With Solution - " << nR << "x" << nC << ") show\n";
 
     // Draw the maze *with* the solution path highlighted
-    drawMaze(outFile, maze, nR, nC, true, false); // drawSolution = true
+    drawPage(outFile, true); // drawSolution = true
 
     outFile << "showpage\n"; // End page 2
+    HEXMAZE_PROBE2(render_done, nR, nC);
 
     // --- Optional Page 3 (Commented out as in original) ---
     /*
@@ -206,7 +273,105 @@ void printMaze(uint8_t maze[][MAX_COLS], uint32_t nR, uint32_t nC) {
     drawMaze(outFile, maze, nR, nC, true, true); // drawSolution = true, drawDeadEnds = true
     outFile << "showpage\n";
     */
+}
+
+template <class Maze>
+void renderMaze(ostream &outFile, const Maze& maze) {
+    writeDocument(outFile, maze, [&maze](ostream& out, bool drawSolution) {
+        drawMaze(out, maze, drawSolution, false);
+    });
+}
+
+//-----------------------------------------------------------------------------
+// Parallel Rendering (see hexmaze_parallel.h)
+// Bands of rows are drawn into strings a wave at a time and written in row
+// order, so the output matches drawMaze byte for byte while memory stays
+// bounded by one wave rather than the whole document.
+//-----------------------------------------------------------------------------
+
+// Writes drawRows(out, r0, r1) for every band, in order
+template <class DrawRows>
+static void drawBands(ostream &outFile, uint32_t nR, uint32_t nC, TaskScheduler& scheduler, DrawRows drawRows) {
+    const uint32_t bandRows = max<uint32_t>(1, RENDER_BAND_CELLS / max<uint32_t>(nC, 1));
+    const size_t bands = (static_cast<size_t>(nR) + bandRows - 1) / bandRows;
+    const size_t wave = 4 * (static_cast<size_t>(scheduler.threadCount()) + 1);
+    vector<string> text(min(bands, wave));
+
+    for (size_t first = 0; first < bands; first += wave) {
+        const size_t n = min(wave, bands - first);
+        parallelFor(scheduler, 0, n, 1, [&](size_t lo, size_t hi) {
+            for (size_t i = lo; i < hi; ++i) {
+                text[i].clear();
+                StringSink sink(text[i]);
+                ostream band(&sink);
+                uint32_t r0 = static_cast<uint32_t>((first + i) * bandRows);
+                drawRows(band, r0, min(nR, r0 + bandRows));
+            }
+        });
+        for (size_t i = 0; i < n; ++i) {
+            outFile.write(text[i].data(), static_cast<streamsize>(text[i].size()));
+            HEXMAZE_PROBE3(render_band, (first + i) * bandRows, min<size_t>(nR, (first + i + 1) * bandRows),
+                           text[i].size());
+        }
+    }
+}
+
+// drawMaze, band by band
+template <class Maze>
+static void drawMazeParallel(ostream &outFile, const Maze& maze, TaskScheduler& scheduler, bool drawSolution) {
+    const uint32_t nR = maze.rows();
+    const uint32_t nC = maze.cols();
+
+    outFile << WALL_STYLE;
+    drawBands(outFile, nR, nC, scheduler, [&maze](ostream& out, uint32_t r0, uint32_t r1) {
+        drawWallRows(out, maze, r0, r1);
+    });
+    drawBorder(outFile, maze);
+
+    if (drawSolution) {
+        outFile << SOLUTION_STYLE;
+        drawBands(outFile, nR, nC, scheduler, [&maze](ostream& out, uint32_t r0, uint32_t r1) {
+            drawSolutionRows(out, maze, r0, r1);
+        });
+        outFile << SOLUTION_END;
+    }
+}
+
+template <class Maze>
+void renderMazeParallel(ostream &outFile, const Maze& maze, TaskScheduler& scheduler) {
+    writeDocument(outFile, maze, [&maze, &scheduler](ostream& out, bool drawSolution) {
+        drawMazeParallel(out, maze, scheduler, drawSolution);
+    });
+}
+
+
+void renderMaze(ostream &outFile, uint8_t maze[][MAX_COLS], uint32_t nR, uint32_t nC) {
+    renderMaze(outFile, ArrayMaze(maze, nR, nC));
+}
+
+
+// Function to create the PostScript file and call renderMaze
+void printMaze(uint8_t maze[][MAX_COLS], uint32_t nR, uint32_t nC) {
+    ofstream outFile;
+
+    outFile.open("maze.ps"); // Open the output file
+    if (!outFile) {
+        cerr << "Error: cannot open maze.ps for writing." << endl; // Use cerr for errors
+        return;
+    }
+
+    renderMaze(outFile, maze, nR, nC);
 
     outFile.close(); // Close the file
     cout << "Maze written to maze.ps" << endl; // Confirmation message
 }
+
+
+// Accessor instantiations (see "Maze Accessors" in hexpathfinder.h)
+template void renderMaze<ArrayMaze>(ostream&, const ArrayMaze&);
+template void renderMaze<PersistentMaze>(ostream&, const PersistentMaze&);
+template void renderMaze<SessionOverlay>(ostream&, const SessionOverlay&);
+template void renderMaze<MazeGrid>(ostream&, const MazeGrid&);
+
+template void renderMazeParallel<ArrayMaze>(ostream&, const ArrayMaze&, TaskScheduler&);
+template void renderMazeParallel<MazeGrid>(ostream&, const MazeGrid&, TaskScheduler&);
@@ -1,315 +1,624 @@
+//
+// Command-line front end. Mazes up to 50x50 go through libhexmaze's C API
+// (hexmaze.h); larger mazes (largeMazeMain), the server (serveMain), the
+// catalog commands and --validate use the C++ internals directly.
+//
+
 #include <iostream>
-#include <vector>
-#include <numeric> // For std::iota
-#include <random>  // For std::mt19937, std::uniform_int_distribution
+#include <iomanip>
+#include <fstream>
 #include <ctime>   // For std::time
-#include <cstdlib> // For std::atoi, std::exit
-#include <queue>   // For std::queue (BFS)
+#include <string>
+#include <utility> // For std::make_pair
 #include <stdexcept> // For std::invalid_argument, std::out_of_range
-#include <algorithm> // For std::shuffle
-
+#include <vector>
+#include <memory>  // For std::unique_ptr
+#include <algorithm> // For std::min
+#include <random>
+#include <new>     // For std::bad_alloc
+#include <climits> // For UINT32_MAX
+#include <sys/stat.h>
+
+#include "hexmaze.h"
 #include "hexpathfinder.h"
+#include "hexmaze_server.h"
+#include "hexmaze_catalog.h"
+#include "hexmaze_batch.h"
+#include "hexmaze_parallel.h"
+#include "hexmaze_scheduler.h"
+#include "hexmaze_stats.h"
+#include "hexmaze_trace.h"
+#include "hexmaze_footprint.h"
+#include "hexmaze_validate.h"
 
 using namespace std;
 
 //-----------------------------------------------------------------------------
-// Disjoint Set Union (DSU) Data Structure
-// Used for maze generation to detect cycles.
+// Main Function
 //-----------------------------------------------------------------------------
-struct DSU {
-    vector<uint32_t> parent;
-    DSU(uint32_t n) {
-        parent.resize(n);
-        iota(parent.begin(), parent.end(), 0); // Fill with 0, 1, 2, ...
-    }
-
-    // Find the representative (root) of the set containing element i
-    uint32_t find(uint32_t i) {
-        if (parent[i] == i)
-            return i;
-        return parent[i] = find(parent[i]); // Path compression
-    }
-
-    // Unite the sets containing elements i and j
-    void unite(uint32_t i, uint32_t j) {
-        uint32_t root_i = find(i);
-        uint32_t root_j = find(j);
-        if (root_i != root_j) {
-            parent[root_i] = root_j; // Make root_j the parent of root_i
+
+enum StatsFormat { STATS_OFF, STATS_TEXT, STATS_JSON };
+
+// Options accepted anywhere on the command line, for every mode
+struct GlobalOptions {
+    unsigned threads = 0;         // Scheduler threads; 0 = one per hardware thread
+    bool pin = false;             // Pin scheduler threads to CPUs
+    StatsFormat stats = STATS_OFF; // Report phase times and counters on exit
+    string tracePath;             // Chrome trace-event JSON written on exit
+    uint64_t memBudget = 0;       // Bytes a large maze may use; 0 = MemAvailable
+    bool allowStreaming = true;   // Over budget: stream rather than refuse
+    bool validate = false;        // Check the generated maze is perfect
+};
+
+static void printUsage(const char* prog) {
+    cerr << "Usage: " << prog << " <num_rows> <num_cols>" << endl
+         << "       (beyond " << HEXMAZE_MAX_ROWS << "x" << HEXMAZE_MAX_COLS
+         << ", built in memory with " << 8 * sizeof(CellIndex) << "-bit cell indices;" << endl
+         << "       in bands beyond " << BAND_GENERATION_CELLS << " cells)" << endl
+         << "       " << prog << " --serve <socket_path> [--workers N] [--queue N]" << endl
+         << "                 [--cache-mem BYTES] [--cache-dir DIR]" << endl
+         << "                 [--pool ROWSxCOLS]... [--pool-capacity N] [--pool-low N]" << endl
+         << "                 [--pool-threads N] [--pool-render]" << endl
+         << "       " << prog << " --catalog <file> add <rows> <cols> <first_seed> <count>" << endl
+         << "       " << prog << " --catalog <file> index" << endl
+         << "       " << prog << " --catalog <file> find <rows> <cols> <seed>" << endl
+         << "       " << prog << " --catalog <file> query <rows> <cols> length|dead-ends|difficulty <min> <max> [limit]" << endl
+         << "       " << prog << " --catalog <file> validate" << endl
+         << "Any mode: [--threads N] [--pin] sizes and pins the worker threads" << endl
+         << "          (--serve also takes --workers N for --threads N)" << endl
+         << "Maze and catalog add: [--stats[=json]] reports phase times and counters" << endl
+         << "          to stderr on exit (counters need `make STATS=1`)" << endl
+         << "Any mode: [--trace FILE] writes per-thread spans as Chrome trace JSON on exit" << endl
+         << "Large mazes: [--mem-budget BYTES[K|M|G]] (default: available memory); a maze" << endl
+         << "          predicted to need more is built in streaming mode, or refused" << endl
+         << "          with [--no-streaming]" << endl
+         << "Maze: [--validate] checks the maze is perfect before solving it" << endl;
+}
+
+// Removes --threads N, --pin, --stats, --trace FILE, --mem-budget BYTES,
+// --no-streaming and --validate from argv, wherever they appear
+static bool takeGlobalOptions(int& argc, char* argv[], GlobalOptions& options) {
+    int kept = 1;
+    for (int i = 1; i < argc; ++i) {
+        string opt = argv[i];
+        if (opt == "--pin") {
+            options.pin = true;
+        } else if (opt == "--stats" || opt == "--stats=text") {
+            options.stats = STATS_TEXT;
+        } else if (opt == "--stats=json") {
+            options.stats = STATS_JSON;
+        } else if (opt == "--validate") {
+            options.validate = true;
+        } else if (opt == "--no-streaming") {
+            options.allowStreaming = false;
+        } else if (opt == "--mem-budget") {
+            if (i + 1 >= argc || !parseByteSize(argv[i + 1], options.memBudget) || options.memBudget == 0) {
+                cerr << "Error: --mem-budget expects a byte count such as 512M or 4G." << endl;
+                return false;
+            }
+            ++i;
+        } else if (opt == "--trace") {
+            if (i + 1 >= argc) {
+                cerr << "Error: --trace expects a file name." << endl;
+                return false;
+            }
+            options.tracePath = argv[++i];
+        } else if (opt == "--threads") {
+            long long n = 0;
+            try {
+                n = i + 1 < argc ? stoll(argv[i + 1]) : 0;
+            } catch (const exception&) {
+                n = 0;
+            }
+            if (n <= 0 || n > 4096) {
+                cerr << "Error: --threads expects a number from 1 to 4096." << endl;
+                return false;
+            }
+            options.threads = static_cast<unsigned>(n);
+            ++i;
+        } else {
+            argv[kept++] = argv[i];
         }
     }
-};
+    argc = kept;
+    return true;
+}
 
-//-----------------------------------------------------------------------------
-// Wall Structure
-// Represents a potential wall to be removed during generation.
-// Stores the coordinates of *one* cell and the direction of the wall relative to that cell.
-//-----------------------------------------------------------------------------
-struct Wall {
-    uint32_t r;          // Row of the cell
-    uint32_t c;          // Column of the cell
-    uint8_t direction; // Direction of the wall (e.g., WALL_DOWN, WALL_UP_RIGHT)
+static uint64_t fileSize(const string& path) {
+    struct stat st;
+    return stat(path.c_str(), &st) == 0 ? static_cast<uint64_t>(st.st_size) : 0;
+}
 
-    // Overload == operator for potential use in Sampler if needed (e.g., checking duplicates)
-    bool operator==(const Wall& other) const {
-        return r == other.r && c == other.c && direction == other.direction;
+// Prints the --stats report to stderr, so stdout stays as without --stats
+static void reportStats(const GlobalOptions& global, StatsReport& report) {
+    if (global.stats == STATS_OFF)
+        return;
+    report.counters = collectCounters();
+    if (global.stats == STATS_JSON)
+        writeStatsJson(cerr, report);
+    else
+        writeStatsText(cerr, report);
+}
+
+// Starts tracing for --trace and writes the trace when main() returns
+class TraceFile {
+public:
+    explicit TraceFile(const string& path) : path(path) {
+        if (!path.empty())
+            startTracing();
     }
-};
 
+    ~TraceFile() {
+        if (path.empty())
+            return;
+        ofstream out(path);
+        uint64_t spans = writeChromeTrace(out);
+        if (!out.flush())
+            cerr << "Error: cannot write trace '" << path << "'." << endl;
+        else
+            cerr << "Wrote " << spans << " spans to " << path << endl;
+    }
 
-//-----------------------------------------------------------------------------
-// Helper function: Get Neighbor Coordinates
-// Calculates the coordinates (neighborR, neighborC) of the cell adjacent
-// to (r, c) in the given wallDirection.
-// Returns true if the neighbor is within the grid bounds (0 <= r < nR, 0 <= c < nC),
-// false otherwise.
-//-----------------------------------------------------------------------------
-bool getNeighbor(uint32_t r, uint32_t c, uint8_t wallDirection, uint32_t nR, uint32_t nC, uint32_t &neighborR, uint32_t &neighborC) {
-    int nr_int = static_cast<int>(r); // Use signed int for calculations
-    int nc_int = static_cast<int>(c);
-    int nR_int = static_cast<int>(nR);
-    int nC_int = static_cast<int>(nC);
-
-    int tempR = nr_int;
-    int tempC = nc_int;
-
-    // Calculate potential neighbor coordinates based on direction and column parity
-    switch (wallDirection) {
-        case WALL_UP:
-            tempR--;
-            break;
-        case WALL_DOWN:
-            tempR++;
-            break;
-        case WALL_UP_RIGHT:
-            tempR = nr_int - 1 + (nc_int & 1); // r = r - 1 (even col), r (odd col)
-            tempC++;
-            break;
-        case WALL_DOWN_RIGHT:
-            tempR = nr_int + (nc_int & 1);     // r = r (even col), r + 1 (odd col)
-            tempC++;
-            break;
-        case WALL_UP_LEFT:
-            tempR = nr_int - 1 + (nc_int & 1); // r = r - 1 (even col), r (odd col)
-            tempC--;
-            break;
-        case WALL_DOWN_LEFT:
-            tempR = nr_int + (nc_int & 1);     // r = r (even col), r + 1 (odd col)
-            tempC--;
-            break;
-        default:
-            return false; // Invalid direction
-    }
-
-    // Check if the calculated neighbor coordinates are within the grid bounds
-    if (tempR >= 0 && tempR < nR_int && tempC >= 0 && tempC < nC_int) {
-        neighborR = static_cast<uint32_t>(tempR);
-        neighborC = static_cast<uint32_t>(tempC);
+private:
+    string path;
+};
+
+// Parses "ROWSxCOLS", e.g. "40x40"
+static bool parseSize(const string& text, uint32_t& rows, uint32_t& cols) {
+    size_t x = text.find('x');
+    if (x == string::npos)
+        return false;
+    try {
+        int r = stoi(text.substr(0, x));
+        int c = stoi(text.substr(x + 1));
+        if (r <= 0 || r > static_cast<int>(HEXMAZE_MAX_ROWS) || c <= 0 || c > static_cast<int>(HEXMAZE_MAX_COLS))
+            return false;
+        rows = static_cast<uint32_t>(r);
+        cols = static_cast<uint32_t>(c);
         return true;
-    } else {
-        return false; // Neighbor is outside the grid
+    } catch (const exception&) {
+        return false;
     }
 }
 
+// Parses the options after `--serve <socket_path>` and runs the server
+static int serveMain(int argc, char* argv[], GlobalOptions global) {
+    ServerOptions options;
+    options.socketPath = argv[2];
+    for (int i = 3; i < argc; ++i) {
+        string opt = argv[i];
+        if (opt == "--pool-render") {
+            options.poolEnabled = true;
+            options.pool.render = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            cerr << "Error: missing value for server option '" << opt << "'." << endl;
+            printUsage(argv[0]);
+            return 1;
+        }
+        string value = argv[++i];
+        if (opt == "--cache-dir") {
+            options.cacheDir = value;
+            continue;
+        }
+        if (opt == "--pool") {
+            uint32_t rows, cols;
+            if (!parseSize(value, rows, cols)) {
+                cerr << "Error: invalid pool size '" << value << "' (expected ROWSxCOLS)." << endl;
+                return 1;
+            }
+            options.poolEnabled = true;
+            options.pool.warmSizes.push_back(make_pair(rows, cols));
+            continue;
+        }
 
-//-----------------------------------------------------------------------------
-// Maze Generation (Algorithm 1 from PDF)
-// Uses DSU and randomized wall removal.
-//-----------------------------------------------------------------------------
-void generateMaze(uint8_t maze[][MAX_COLS], uint32_t nR, uint32_t nC, mt19937& rng) {
-    // 1. Initialize maze with all walls present
-    for (uint32_t r = 0; r < nR; ++r) {
-        for (uint32_t c = 0; c < nC; ++c) {
-            maze[r][c] = ALL_WALLS; // Set all wall bits
+        long long n = 0;
+        try {
+            n = stoll(value);
+        } catch (const exception&) {
+            n = 0;
+        }
+        if (n <= 0) {
+            cerr << "Error: server option '" << opt << "' expects a positive number." << endl;
+            printUsage(argv[0]);
+            return 1;
+        }
+        if (opt == "--workers") {
+            global.threads = static_cast<unsigned>(n);
+        } else if (opt == "--queue") {
+            options.queueCapacity = static_cast<size_t>(n);
+        } else if (opt == "--cache-mem") {
+            options.cacheBytes = static_cast<size_t>(n);
+        } else if (opt == "--pool-capacity") {
+            options.poolEnabled = true;
+            options.pool.capacity = static_cast<size_t>(n);
+        } else if (opt == "--pool-low") {
+            options.poolEnabled = true;
+            options.pool.lowWatermark = static_cast<size_t>(n);
+        } else if (opt == "--pool-threads") {
+            options.poolEnabled = true;
+            options.pool.refillThreads = static_cast<unsigned>(n);
+        } else {
+            cerr << "Error: unknown server option '" << opt << "'." << endl;
+            printUsage(argv[0]);
+            return 1;
         }
     }
+    TaskScheduler scheduler(global.threads, global.pin);
+    return runServer(options, scheduler);
+}
 
-    // 2. Initialize Disjoint Set Union (DSU) structure
-    uint32_t totalCells = nR * nC;
-    DSU dsu(totalCells);
+//-----------------------------------------------------------------------------
+// Catalog Commands
+//-----------------------------------------------------------------------------
+static void printCatalogEntry(const CatalogEntry& e) {
+    cout << e.rows << "x" << e.cols << "  seed " << e.seed << "  length " << e.solutionLength
+         << "  dead-ends " << e.deadEnds << "  difficulty " << fixed << setprecision(3) << e.difficulty << endl;
+}
 
-    // 3. Create a list of all *internal* walls to consider removing
-    vector<Wall> internalWalls;
-    internalWalls.reserve(totalCells * 3); // Approximate reservation
+// One wave slot of catalogAdd: up to BATCH_MAX_MAZES mazes, generated,
+// solved together (see hexmaze_batch.h) and measured by one task
+struct CatalogBatch {
+    uint8_t mazes[BATCH_MAX_MAZES][MAX_ROWS][MAX_COLS];
+    vector<uint32_t> paths[BATCH_MAX_MAZES];
+    MazeMetrics metrics[BATCH_MAX_MAZES];
+    uint32_t solved; // Bit l set if maze l has a solution
+    GeneratorWorkspace generator;
+    BatchSolverWorkspace solver;
+};
 
-    for (uint32_t r = 0; r < nR; ++r) {
-        for (uint32_t c = 0; c < nC; ++c) {
-            uint32_t neighborR, neighborC;
+static void buildCatalogBatch(CatalogBatch& batch, uint32_t firstSeed, uint32_t n, uint32_t nR, uint32_t nC) {
+    MazeRows rows[BATCH_MAX_MAZES] = {};
+    for (uint32_t l = 0; l < n; ++l) {
+        TraceSpan span("generate");
+        mt19937 rng(firstSeed + l);
+        generateMaze(batch.mazes[l], nR, nC, rng, batch.generator);
+        rows[l] = batch.mazes[l];
+    }
+    TraceSpan span("solve");
+    batch.solved = solveMazeBatch(rows, n, nR, nC, batch.solver, batch.paths);
+    for (uint32_t l = 0; l < n; ++l)
+        if (batch.solved & (1u << l))
+            batch.metrics[l] = analyzeMaze(batch.mazes[l], nR, nC, batch.paths[l]);
+}
 
-            // Consider WALL_DOWN only if the cell below is valid
-            if (getNeighbor(r, c, WALL_DOWN, nR, nC, neighborR, neighborC)) {
-                 internalWalls.push_back({r, c, WALL_DOWN});
-            }
-            // Consider WALL_UP_RIGHT only if the neighbor is valid
-             if (getNeighbor(r, c, WALL_UP_RIGHT, nR, nC, neighborR, neighborC)) {
-                 internalWalls.push_back({r, c, WALL_UP_RIGHT});
+// Generates, solves and appends mazes first_seed .. first_seed + count - 1,
+// then rebuilds the index. A wave of batches is built in parallel, then
+// appended in seed order, so the file is the same for any thread count.
+// Building the batches counts as the generate phase (it includes the batch
+// solver, which has no counters), appending and indexing as the write phase.
+static int catalogAdd(const string& path, uint32_t nR, uint32_t nC, uint32_t firstSeed, uint32_t count,
+                      TaskScheduler& scheduler, StatsReport& stats) {
+    const uint64_t sizeBefore = fileSize(path);
+    CatalogWriter writer;
+    if (!writer.open(path)) {
+        cerr << "Error: cannot open catalog '" << path << "' for writing." << endl;
+        return 1;
+    }
+
+    const uint32_t waveBatches = 4 * (scheduler.threadCount() + 1);
+    vector<unique_ptr<CatalogBatch>> batches;
+    for (uint32_t done = 0; done < count;) {
+        PhaseTimer generating(stats, PHASE_GENERATE);
+        const uint64_t waveNs = tracingEnabled() ? traceClockNs() : 0;
+        uint32_t n = static_cast<uint32_t>(min<uint64_t>(count - done, uint64_t(waveBatches) * BATCH_MAX_MAZES));
+        uint32_t used = (n + BATCH_MAX_MAZES - 1) / BATCH_MAX_MAZES;
+        while (batches.size() < used)
+            batches.emplace_back(new CatalogBatch);
+        parallelFor(scheduler, 0, used, 1, [&](size_t lo, size_t hi) {
+            if (waveNs != 0)
+                recordTraceSpan("queue_wait", "task", waveNs, traceClockNs());
+            for (size_t b = lo; b < hi; ++b) {
+                uint32_t first = static_cast<uint32_t>(b) * BATCH_MAX_MAZES;
+                buildCatalogBatch(*batches[b], firstSeed + done + first, min(n - first, BATCH_MAX_MAZES), nR, nC);
             }
-             // Consider WALL_DOWN_RIGHT only if the neighbor is valid
-             if (getNeighbor(r, c, WALL_DOWN_RIGHT, nR, nC, neighborR, neighborC)) {
-                 internalWalls.push_back({r, c, WALL_DOWN_RIGHT});
+        });
+        generating.stop();
+
+        PhaseTimer writing(stats, PHASE_WRITE);
+        for (uint32_t i = 0; i < n; ++i) {
+            CatalogBatch& batch = *batches[i / BATCH_MAX_MAZES];
+            uint32_t l = i % BATCH_MAX_MAZES;
+            uint32_t seed = firstSeed + done + i;
+            if (!(batch.solved & (1u << l)) || !writer.append(batch.mazes[l], nR, nC, seed, batch.metrics[l])) {
+                cerr << "Error: failed to add seed " << seed << " to the catalog." << endl;
+                return 1;
             }
-            // Note: We only need to add walls in 3 directions from each cell
-            // to cover all internal walls exactly once. Adding WALL_UP, WALL_UP_LEFT,
-            // and WALL_DOWN_LEFT would be redundant.
         }
+        done += n;
+    }
+    PhaseTimer writing(stats, PHASE_WRITE);
+    if (!writer.close()) {
+        cerr << "Error: failed to flush catalog '" << path << "'." << endl;
+        return 1;
     }
 
-    // 4. Shuffle the list of internal walls randomly
-    shuffle(internalWalls.begin(), internalWalls.end(), rng);
+    int64_t indexed = buildCatalogIndex(path);
+    if (indexed < 0) {
+        cerr << "Error: failed to index catalog '" << path << "'." << endl;
+        return 1;
+    }
+    writing.stop();
+    stats.outputBytes = fileSize(path) - sizeBefore;
+    cout << "Added " << count << " mazes; catalog holds " << indexed << "." << endl;
+    return 0;
+}
 
-    // 5. Remove walls until nR * nC - 1 walls have been removed (or all cells are connected)
-    uint32_t wallsRemoved = 0;
-    uint32_t targetWallsToRemove = totalCells - 1;
+// Parses a catalog command's numeric argument
+static bool parseNumber(const char* text, uint32_t& value) {
+    try {
+        size_t used = 0;
+        unsigned long n = stoul(text, &used);
+        if (text[used] != '\0' || n > 0xFFFFFFFFul)
+            return false;
+        value = static_cast<uint32_t>(n);
+        return true;
+    } catch (const exception&) {
+        return false;
+    }
+}
 
-    for (const auto& wall : internalWalls) {
-        if (wallsRemoved >= targetWallsToRemove) {
-            break; // Stop once the maze is a spanning tree
+// Prints mazes whose metric lies in [lo, hi]; difficulty bounds are decimals
+static int catalogQuery(const MazeCatalog& catalog, uint32_t nR, uint32_t nC, const string& metric,
+                        const char* lo, const char* hi, size_t limit) {
+    CatalogKey by;
+    uint32_t loKey, hiKey;
+    try {
+        if (metric == "difficulty") {
+            by = CATALOG_BY_DIFFICULTY;
+            loKey = difficultyKey(stof(lo));
+            hiKey = difficultyKey(stof(hi));
+        } else {
+            by = metric == "length" ? CATALOG_BY_SOLUTION_LENGTH : CATALOG_BY_DEAD_ENDS;
+            if ((metric != "length" && metric != "dead-ends") || !parseNumber(lo, loKey) || !parseNumber(hi, hiKey))
+                throw invalid_argument(metric);
         }
+    } catch (const exception&) {
+        cerr << "Error: invalid query '" << metric << " " << lo << " " << hi << "'." << endl;
+        return 1;
+    }
 
-        uint32_t r1 = wall.r;
-        uint32_t c1 = wall.c;
-        uint8_t direction = wall.direction;
-        uint32_t r2, c2;
-
-        // Get the neighbor cell on the other side of the wall
-        if (getNeighbor(r1, c1, direction, nR, nC, r2, c2)) {
-            // Convert cell coordinates to DSU indices
-            uint32_t cell1_idx = r1 * nC + c1;
-            uint32_t cell2_idx = r2 * nC + c2;
+    vector<CatalogEntry> entries;
+    catalog.range(nR, nC, by, loKey, hiKey, entries, limit);
+    for (const CatalogEntry& e : entries)
+        printCatalogEntry(e);
+    cout << entries.size() << " matching mazes." << endl;
+    return 0;
+}
 
-            // Check if the cells are already connected using DSU
-            if (dsu.find(cell1_idx) != dsu.find(cell2_idx)) {
-                // If not connected, remove the wall and unite the sets
-                uint8_t oppositeWall = getOppositeWall(direction);
+// Checks every indexed maze is perfect; lists the ones that are not
+static int catalogValidate(const MazeCatalog& catalog, TaskScheduler& scheduler) {
+    vector<CatalogEntry> entries;
+    catalog.all(entries);
+    vector<MazeValidation> results(entries.size());
+    vector<char> loaded(entries.size());
+    parallelFor(scheduler, 0, entries.size(), 0, [&](size_t lo, size_t hi) {
+        uint8_t maze[MAX_ROWS][MAX_COLS];
+        for (size_t i = lo; i < hi; ++i) {
+            loaded[i] = catalog.load(entries[i], maze);
+            if (loaded[i])
+                results[i] = validateMaze(maze, entries[i].rows, entries[i].cols);
+        }
+    });
+
+    size_t failed = 0;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        if (loaded[i] && results[i].perfect())
+            continue;
+        ++failed;
+        printCatalogEntry(entries[i]);
+        if (!loaded[i])
+            cout << "Record unreadable" << endl;
+        else
+            writeValidation(cout, results[i]);
+    }
+    cout << "Validated " << entries.size() << " mazes: " << failed << " not perfect." << endl;
+    return failed == 0 ? 0 : 1;
+}
 
-                maze[r1][c1] &= ~direction;    // Remove wall from cell 1
-                maze[r2][c2] &= ~oppositeWall; // Remove corresponding wall from cell 2
+// Parses the arguments after `--catalog <file>` and runs one command
+static int catalogMain(int argc, char* argv[], const GlobalOptions& global) {
+    const string path = argv[2];
+    const string command = argv[3];
 
-                dsu.unite(cell1_idx, cell2_idx); // Unite the sets in DSU
-                wallsRemoved++;
-            }
+    if (command == "index" && argc == 4) {
+        int64_t indexed = buildCatalogIndex(path);
+        if (indexed < 0) {
+            cerr << "Error: failed to index catalog '" << path << "'." << endl;
+            return 1;
         }
+        cout << "Indexed " << indexed << " mazes." << endl;
+        return 0;
+    }
+    if (command == "validate" && argc == 4) {
+        MazeCatalog catalog;
+        if (!catalog.open(path)) {
+            cerr << "Error: cannot open catalog '" << path << "' (missing or not indexed)." << endl;
+            return 1;
+        }
+        if (!catalog.indexCurrent())
+            cerr << "Warning: index is stale; mazes added since the last 'index' are not validated." << endl;
+        TaskScheduler scheduler(global.threads, global.pin);
+        return catalogValidate(catalog, scheduler);
+    }
+
+    // Every other command starts with <rows> <cols>
+    uint32_t nR = 0, nC = 0, a = 0, b = 0, limit = 0;
+    bool sized = argc >= 6 && parseNumber(argv[4], nR) && parseNumber(argv[5], nC) &&
+                 nR >= 1 && nR <= MAX_ROWS && nC >= 1 && nC <= MAX_COLS;
+    bool isAdd = command == "add" && argc == 8 && parseNumber(argv[6], a) && parseNumber(argv[7], b);
+    bool isFind = command == "find" && argc == 7 && parseNumber(argv[6], a);
+    bool isQuery = command == "query" && (argc == 9 || (argc == 10 && parseNumber(argv[9], limit)));
+    if (!sized || !(isAdd || isFind || isQuery)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    if (isAdd) {
+        TaskScheduler scheduler(global.threads, global.pin);
+        StatsReport stats;
+        int status = catalogAdd(path, nR, nC, a, b, scheduler, stats);
+        reportStats(global, stats);
+        return status;
+    }
+
+    MazeCatalog catalog;
+    if (!catalog.open(path)) {
+        cerr << "Error: cannot open catalog '" << path << "' (missing or not indexed)." << endl;
+        return 1;
     }
+    if (!catalog.indexCurrent())
+        cerr << "Warning: index is stale; mazes added since the last 'index' are not visible." << endl;
+
+    if (isQuery)
+        return catalogQuery(catalog, nR, nC, argv[6], argv[7], argv[8], argc == 10 ? limit : SIZE_MAX);
 
-     if (wallsRemoved < targetWallsToRemove) {
-        cerr << "Warning: Could not remove the target number of walls. Maze might not be fully connected." << endl;
+    CatalogEntry entry;
+    if (!catalog.find(nR, nC, a, entry)) {
+        cout << "Not found." << endl;
+        return 1;
     }
-    // Optional: Implement Algorithm 2 here to remove additional walls if desired
+    printCatalogEntry(entry);
+    return 0;
 }
 
+static double mebibytes(uint64_t bytes) {
+    return static_cast<double>(bytes) / (1 << 20);
+}
 
-//-----------------------------------------------------------------------------
-// Maze Solving (Algorithm 3 from PDF)
-// Uses Breadth-First Search (BFS) to find the shortest path.
-//-----------------------------------------------------------------------------
-void solveMazeBFS(uint8_t maze[][MAX_COLS], uint32_t nR, uint32_t nC) {
-    // 1. Initialize count array and queue for BFS
-    int count[MAX_ROWS][MAX_COLS]; // Stores distance from end cell
-    queue<uint32_t> q;             // Stores cell indices (r * nC + c)
-
-    for (uint32_t r = 0; r < nR; ++r) {
-        for (uint32_t c = 0; c < nC; ++c) {
-            count[r][c] = -1; // Initialize all counts to -1 (unvisited)
-             maze[r][c] &= ~VISITED; // Clear any previous VISITED flags
-        }
+// Mazes beyond the C API's fixed-size array: generated, solved and drawn
+// straight from a MazeGrid, numbering cells with CellIndex. Mazes above
+// BAND_GENERATION_CELLS are generated in bands (see hexmaze_parallel.h),
+// whatever the thread count.
+// A maze predicted not to fit the memory budget is built in streaming mode
+// (see hexmaze_footprint.h) or refused.
+static int largeMazeMain(uint32_t nR, uint32_t nC, const GlobalOptions& global, StatsReport& stats) {
+    if (!fitsCellIndex<CellIndex>(nR, nC)) {
+        cerr << "Error: a " << nR << "x" << nC << " maze has more cells than a "
+             << 8 * sizeof(CellIndex) << "-bit build can index; rebuild with `make INDEX64=1`." << endl;
+        return 1;
     }
 
-    // 2. Start BFS from the end cell (bottom-right)
-    uint32_t startR = 0;
-    uint32_t startC = 0;
-    uint32_t endR = nR - 1;
-    uint32_t endC = nC - 1;
-
-    if (endR >= nR || endC >= nC) {
-         cerr << "Error: End cell coordinates are invalid." << endl;
-         return;
-    }
-
-
-    uint32_t endCellIdx = endR * nC + endC;
-    count[endR][endC] = 0; // Distance from end cell to itself is 0
-    q.push(endCellIdx);
-
-    // 3. Perform BFS
-    while (!q.empty()) {
-        uint32_t currentIdx = q.front();
-        q.pop();
-
-        uint32_t r = currentIdx / nC;
-        uint32_t c = currentIdx % nC;
-
-        // Explore neighbors
-        uint8_t directions[] = {WALL_UP, WALL_DOWN, WALL_UP_LEFT, WALL_UP_RIGHT, WALL_DOWN_LEFT, WALL_DOWN_RIGHT};
-        for (uint8_t dir : directions) {
-            // Check if there is *no* wall in this direction
-            if ((maze[r][c] & dir) == 0) {
-                uint32_t neighborR, neighborC;
-                // Get the valid neighbor coordinates
-                if (getNeighbor(r, c, dir, nR, nC, neighborR, neighborC)) {
-                    // Check if the neighbor hasn't been visited yet (count == -1)
-                    if (count[neighborR][neighborC] == -1) {
-                        count[neighborR][neighborC] = count[r][c] + 1; // Set distance
-                        q.push(neighborR * nC + neighborC);           // Add neighbor to queue
-                    }
-                }
-            }
+    try {
+        TaskScheduler scheduler(global.threads, global.pin);
+        MazePlan plan = {nR, nC, generatorFor(nR, nC), SOLVE_BFS, RENDER_STREAMED, scheduler.threadCount(),
+                         sizeof(CellIndex), global.validate};
+        uint64_t budget = global.memBudget != 0 ? global.memBudget : availableMemory();
+        MemoryFootprint predicted;
+        Admission admission = budget == 0 ? ADMIT : admitMaze(plan, budget, global.allowStreaming, plan, predicted);
+        if (budget == 0)
+            predicted = predictFootprint(plan);
+        stats.predictedPeakBytes = predicted.peak;
+        cout << fixed << setprecision(1);
+        cerr << fixed << setprecision(1);
+        if (admission == REFUSE) {
+            cerr << "Error: a " << nR << "x" << nC << " maze is predicted to need " << mebibytes(predicted.peak)
+                 << " MiB" << (global.allowStreaming ? " even in streaming mode" : "") << ", over the budget of "
+                 << mebibytes(budget) << " MiB." << endl;
+            return 1;
+        }
+        if (admission == ADMIT_STREAMING)
+            cout << "Predicted memory exceeds the budget of " << mebibytes(budget)
+                 << " MiB; streaming (band generation, dead-end filling) in "
+                 << mebibytes(predicted.peak) << " MiB." << endl;
+
+        MazeGrid grid(nR, nC);
+        BasicSolverWorkspace<CellIndex> solver;
+        uint32_t seed = static_cast<uint32_t>(time(0));
+
+        cout << "Generating " << nR << "x" << nC << " maze..." << endl;
+        PhaseTimer generating(stats, PHASE_GENERATE);
+        bool generated;
+        if (plan.generator == GENERATE_BANDS) {
+            generated = generateMazeBands(grid, seed, scheduler);
+        } else {
+            BasicGeneratorWorkspace<CellIndex> generator;
+            mt19937 rng(seed);
+            generated = generateMaze(grid, rng, generator);
+        }
+        if (!generated) {
+            cerr << "Error: generation failed." << endl;
+            return 1;
+        }
+        generating.stop();
+        cout << "Maze generation complete." << endl;
+
+        if (global.validate) {
+            MazeValidation validation = validateMaze(grid, scheduler);
+            writeValidation(validation.perfect() ? cout : cerr, validation);
+            if (!validation.perfect())
+                return 1;
         }
-    }
 
-    // 4. Trace the path back from the start cell (top-left) if reachable
-    if (count[startR][startC] == -1) {
-        cout << "No solution path found from start to end." << endl;
-        return; // Start cell was not reached by BFS
-    }
-
-    uint32_t currentR = startR;
-    uint32_t currentC = startC;
-    maze[currentR][currentC] |= VISITED; // Mark start cell as visited
-
-    while (count[currentR][currentC] != 0) { // While not back at the end cell
-        bool foundNext = false;
-        uint8_t directions[] = {WALL_UP, WALL_DOWN, WALL_UP_LEFT, WALL_UP_RIGHT, WALL_DOWN_LEFT, WALL_DOWN_RIGHT};
-        for (uint8_t dir : directions) {
-             // Check if there is *no* wall in this direction
-             if ((maze[currentR][currentC] & dir) == 0) {
-                uint32_t neighborR, neighborC;
-                if (getNeighbor(currentR, currentC, dir, nR, nC, neighborR, neighborC)) {
-                    // Check if this neighbor is the next step towards the end (count is one less)
-                    if (count[neighborR][neighborC] == count[currentR][currentC] - 1) {
-                        currentR = neighborR;
-                        currentC = neighborC;
-                        maze[currentR][currentC] |= VISITED; // Mark this cell as part of the path
-                        foundNext = true;
-                        break; // Move to the next step
-                    }
-                }
-            }
+        PhaseTimer solving(stats, PHASE_SOLVE);
+        bool solved;
+        if (plan.solver == SOLVE_DEAD_ENDS) {
+            cout << "Solving maze by dead-end filling..." << endl;
+            solved = solveMazeDeadEnds(grid);
+        } else {
+            cout << "Solving maze using BFS..." << endl;
+            solved = solveMazeParallel(grid, solver, scheduler);
+            // The render only needs the VISITED marks
+            vector<CellIndex>().swap(solver.count);
+            vector<CellIndex>().swap(solver.queue);
         }
-         if (!foundNext) {
-             cerr << "Error: Could not trace path back from (" << currentR << "," << currentC << ") with count " << count[currentR][currentC] << endl;
-             // This should not happen if BFS completed correctly and start was reachable
-             return;
-         }
+        solving.stop();
+        if (!solved) {
+            cerr << "No solution path found from start to end." << endl;
+            return 1;
+        }
+        cout << "Maze solving complete." << endl;
+
+        cout << "Printing maze to maze.ps..." << endl;
+        // Rendering streams into the file; write is the final flush
+        PhaseTimer rendering(stats, PHASE_RENDER);
+        ofstream outFile("maze.ps", ios::binary);
+        if (!outFile) {
+            cerr << "Error: cannot open maze.ps for writing." << endl;
+            return 1;
+        }
+        renderMazeParallel(outFile, grid, scheduler);
+        rendering.stop();
+        PhaseTimer writing(stats, PHASE_WRITE);
+        if (!outFile.flush()) {
+            cerr << "Error: failed writing maze.ps." << endl;
+            return 1;
+        }
+        writing.stop();
+        stats.outputBytes = static_cast<uint64_t>(outFile.tellp());
+        cout << "Maze written to maze.ps" << endl;
+        return 0;
+    } catch (const bad_alloc&) {
+        cerr << "Error: could not allocate a " << nR << "x" << nC << " maze." << endl;
+        return 1;
     }
 }
 
-
-//-----------------------------------------------------------------------------
-// Main Function
-//-----------------------------------------------------------------------------
 int main(int argc, char* argv[]) {
     // 1. Check and parse command-line arguments
+    GlobalOptions global;
+    if (!takeGlobalOptions(argc, argv, global)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    TraceFile trace(global.tracePath);
+    if (argc >= 3 && string(argv[1]) == "--serve") {
+        return serveMain(argc, argv, global);
+    }
+    if (argc >= 4 && string(argv[1]) == "--catalog") {
+        return catalogMain(argc, argv, global);
+    }
     if (argc != 3) {
-        cerr << "Usage: " << argv[0] << " <num_rows> <num_cols>" << endl;
+        printUsage(argv[0]);
         return 1; // Indicate error
     }
 
     uint32_t nR, nC;
     try {
-        int rows = stoi(argv[1]);
-        int cols = stoi(argv[2]);
+        long long rows = stoll(argv[1]);
+        long long cols = stoll(argv[2]);
 
-        if (rows <= 0 || rows > MAX_ROWS || cols <= 0 || cols > MAX_COLS) {
+        if (rows <= 0 || rows > UINT32_MAX || cols <= 0 || cols > UINT32_MAX) {
             throw out_of_range("Dimensions out of range.");
         }
         nR = static_cast<uint32_t>(rows);
@@ -318,32 +627,92 @@ int main(int argc, char* argv[]) {
         cerr << "Error: Invalid number format for rows or columns." << endl;
         return 1;
     } catch (const out_of_range& e) {
-        cerr << "Error: Rows must be between 1 and " << MAX_ROWS
-             << ", Columns must be between 1 and " << MAX_COLS << "." << endl;
+        cerr << "Error: Rows and columns must be between 1 and " << UINT32_MAX << "." << endl;
         return 1;
     }
+    StatsReport stats;
+    if (nR > HEXMAZE_MAX_ROWS || nC > HEXMAZE_MAX_COLS) {
+        int status = largeMazeMain(nR, nC, global, stats);
+        reportStats(global, stats);
+        return status;
+    }
 
-    // 2. Seed the random number generator
-    mt19937 rng(time(0)); // Mersenne Twister engine seeded with time
-
-    // 3. Declare the maze array
-    // Using static allocation since MAX_ROWS/MAX_COLS are constants
-    // For very large mazes, dynamic allocation might be better.
-    static uint8_t maze[MAX_ROWS][MAX_COLS];
+    // 2. Create the maze (owns the cell grid and all scratch buffers)
+    hexmaze_t* maze = hexmaze_create(nR, nC);
+    if (!maze) {
+        cerr << "Error: could not allocate a " << nR << "x" << nC << " maze." << endl;
+        return 1;
+    }
 
-    // 4. Generate the maze
+    // 3. Generate the maze, seeded with the current time
     cout << "Generating " << nR << "x" << nC << " maze..." << endl;
-    generateMaze(maze, nR, nC, rng);
+    PhaseTimer generating(stats, PHASE_GENERATE);
+    int status = hexmaze_generate(maze, static_cast<uint32_t>(time(0)));
+    generating.stop();
+    if (status != HEXMAZE_OK) {
+        cerr << "Error: generation failed (status " << status << ")." << endl;
+        hexmaze_free(maze);
+        return 1;
+    }
     cout << "Maze generation complete." << endl;
 
-    // 5. Solve the maze using BFS
+    if (global.validate) {
+        uint8_t cells[MAX_ROWS][MAX_COLS];
+        for (uint32_t r = 0; r < nR; ++r)
+            for (uint32_t c = 0; c < nC; ++c)
+                cells[r][c] = hexmaze_cell(maze, r, c);
+        MazeValidation validation = validateMaze(cells, nR, nC);
+        writeValidation(validation.perfect() ? cout : cerr, validation);
+        if (!validation.perfect()) {
+            hexmaze_free(maze);
+            return 1;
+        }
+    }
+
+    // 4. Solve the maze using BFS
     cout << "Solving maze using BFS..." << endl;
-    solveMazeBFS(maze, nR, nC);
+    PhaseTimer solving(stats, PHASE_SOLVE);
+    status = hexmaze_solve(maze);
+    solving.stop();
+    if (status == HEXMAZE_ERR_NO_SOLUTION) {
+        cerr << "No solution path found from start to end." << endl;
+        hexmaze_free(maze);
+        return 1;
+    }
+    if (status != HEXMAZE_OK) {
+        cerr << "Error: solving failed (status " << status << ")." << endl;
+        hexmaze_free(maze);
+        return 1;
+    }
     cout << "Maze solving complete." << endl;
 
-    // 6. Print the maze (generates maze.ps)
+    // 5. Render the maze and write it to maze.ps
     cout << "Printing maze to maze.ps..." << endl;
-    printMaze(maze, nR, nC);
+    const char* ps = nullptr;
+    size_t psSize = 0;
+    PhaseTimer rendering(stats, PHASE_RENDER);
+    status = hexmaze_render(maze, &ps, &psSize);
+    rendering.stop();
+    if (status != HEXMAZE_OK) {
+        cerr << "Error: rendering failed (status " << status << ")." << endl;
+        hexmaze_free(maze);
+        return 1;
+    }
 
+    PhaseTimer writing(stats, PHASE_WRITE);
+    ofstream outFile("maze.ps", ios::binary);
+    if (!outFile) {
+        cerr << "Error: cannot open maze.ps for writing." << endl;
+        hexmaze_free(maze);
+        return 1;
+    }
+    outFile.write(ps, static_cast<streamsize>(psSize));
+    outFile.close();
+    writing.stop();
+    stats.outputBytes = psSize;
+    cout << "Maze written to maze.ps" << endl;
+
+    hexmaze_free(maze);
+    reportStats(global, stats);
     return 0; // Indicate success
 }